@@ -0,0 +1,239 @@
+/* analysis_engine.cpp
+ * Implements the registry of native analysis engines.
+ */
+
+#include "analysis_engine.h"
+#include "lte_csf_stats.h"
+#include "lte_mac_tput.h"
+#include "lte_pdcch_dci_stats.h"
+#include "lte_pdcp_timeline.h"
+#include "lte_pdsch_bler.h"
+#include "lte_pusch_tx_columns.h"
+#include "lte_rlc_tracker.h"
+#include "nr_beam_store.h"
+#include "nr_mac_tput.h"
+#include "nr_mac_ul_pcsr_columns.h"
+#include "utils.h"
+
+#include <cstring>
+
+static AnalysisEngine *Engines[] = {
+    &LteRlcTrackerEngine,
+    &LtePdcpTimelineEngine,
+    &LteMacTputEngine,
+    &LtePdschBlerEngine,
+    &LtePuschTxColumnsEngine,
+    &LtePdcchDciStatsEngine,
+    &LteCsfStatsEngine,
+    &NrMacTputEngine,
+    &NrBeamStoreEngine,
+    &NrMacUlPcsrColumnsEngine,
+};
+
+static unsigned long long g_packet_timestamp = 0;
+
+struct AnalysisEngine *
+find_analysis_engine (const char *name) {
+    for (size_t i = 0; i < ARRAY_SIZE(Engines, AnalysisEngine *); i++) {
+        if (strcmp(Engines[i]->name, name) == 0)
+            return Engines[i];
+    }
+    return NULL;
+}
+
+PyObject *
+get_analysis_engine_names () {
+    size_t n = ARRAY_SIZE(Engines, AnalysisEngine *);
+    PyObject *t = PyTuple_New(n);
+    for (size_t i = 0; i < n; i++) {
+        PyTuple_SetItem(t, i, Py_BuildValue("s", Engines[i]->name));
+    }
+    return t;
+}
+
+void
+analysis_set_packet_timestamp (unsigned long long qcdm_timestamp) {
+    g_packet_timestamp = qcdm_timestamp;
+}
+
+double
+analysis_packet_time () {
+    return qcdm_timestamp_to_unix_usecs(g_packet_timestamp) / 1000000.0;
+}
+
+int
+lte_sys_time (int sys_fn, int sub_fn) {
+    return (sys_fn * 10 + sub_fn) % LTE_SYS_TIME_MODULUS;
+}
+
+int
+lte_sys_time_diff (int later, int earlier) {
+    return (later - earlier + LTE_SYS_TIME_MODULUS) % LTE_SYS_TIME_MODULUS;
+}
+
+void
+lte_sys_clock_reset (struct LteSysClock *clock) {
+    clock->anchored = false;
+    clock->base = 0;
+}
+
+long long
+lte_sys_clock_to_unix_ms (struct LteSysClock *clock, int sys_time) {
+    long long now = (long long) (analysis_packet_time() * 1000);
+    if (clock->anchored) {
+        // Move base by whole SFN cycles towards the packet time
+        long long diff = now - (clock->base + sys_time);
+        long long cycles = (diff + (diff >= 0 ? 1 : -1) * LTE_SYS_TIME_MODULUS / 2)
+                           / LTE_SYS_TIME_MODULUS;
+        clock->base += cycles * LTE_SYS_TIME_MODULUS;
+        long long t = clock->base + sys_time;
+        if (t - now <= LTE_SYS_CLOCK_TOLERANCE && now - t <= LTE_SYS_CLOCK_TOLERANCE)
+            return t;
+    }
+    clock->anchored = true;
+    clock->base = now - sys_time;
+    return now;
+}
+
+// Return: a borrowed reference to the option, or NULL if missing
+static PyObject *
+get_option (PyObject *options, const char *key) {
+    if (options == NULL || options == Py_None)
+        return NULL;
+    return PyDict_GetItemString(options, key);
+}
+
+bool
+analysis_get_int_option (PyObject *options, const char *key, long long *value) {
+    PyObject *o = get_option(options, key);
+    if (o == NULL)
+        return true;
+    long long v = PyLong_AsLongLong(o);
+    if (v == -1 && PyErr_Occurred()) {
+        PyErr_Format(PyExc_ValueError, "option \"%s\" must be an int", key);
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+bool
+analysis_get_double_option (PyObject *options, const char *key, double *value) {
+    PyObject *o = get_option(options, key);
+    if (o == NULL)
+        return true;
+    double v = PyFloat_AsDouble(o);
+    if (v == -1.0 && PyErr_Occurred()) {
+        PyErr_Format(PyExc_ValueError, "option \"%s\" must be a number", key);
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+bool
+analysis_get_bool_option (PyObject *options, const char *key, bool *value) {
+    PyObject *o = get_option(options, key);
+    if (o == NULL)
+        return true;
+    int v = PyObject_IsTrue(o);
+    if (v < 0)
+        return false;
+    *value = (v != 0);
+    return true;
+}
+
+PyObject *
+analysis_make_column (const void *values, size_t n, size_t item_size, const char *fmt) {
+    PyObject *bytes = PyBytes_FromStringAndSize((const char *) values, n * item_size);
+    if (bytes == NULL)
+        return NULL;
+    PyObject *view = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (view == NULL)
+        return NULL;
+    PyObject *column = PyObject_CallMethod(view, "cast", "s", fmt);
+    Py_DECREF(view);
+    return column;
+}
+
+// Owner of the values of a column, which exports them by the buffer protocol
+struct AnalysisColumnObject {
+    PyObject_HEAD
+    AnalysisColumnData *data;
+    Py_ssize_t n;
+    Py_ssize_t item_size;
+    char fmt[8];
+};
+
+static void
+analysis_column_dealloc (PyObject *self) {
+    delete ((AnalysisColumnObject *) self)->data;
+    Py_TYPE(self)->tp_free(self);
+}
+
+static int
+analysis_column_getbuffer (PyObject *self, Py_buffer *view, int flags) {
+    static char empty = 0;
+    AnalysisColumnObject *c = (AnalysisColumnObject *) self;
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "analysis columns are read-only");
+        view->obj = NULL;
+        return -1;
+    }
+    const void *values = c->data->values();
+    view->obj = self;
+    Py_INCREF(self);
+    view->buf = values != NULL ? (void *) values : &empty;
+    view->len = c->n * c->item_size;
+    view->readonly = 1;
+    view->itemsize = c->item_size;
+    view->format = (flags & PyBUF_FORMAT) ? c->fmt : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &c->n : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &c->item_size : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs analysis_column_as_buffer = {
+    analysis_column_getbuffer,
+    NULL,
+};
+
+static PyTypeObject AnalysisColumnType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "dm_collector_c.AnalysisColumn",    // tp_name
+    sizeof(AnalysisColumnObject),       // tp_basicsize
+};
+
+PyObject *
+analysis_wrap_column (AnalysisColumnData *data, size_t n, size_t item_size,
+                      const char *fmt) {
+    static bool type_ready = false;
+    if (!type_ready) {
+        AnalysisColumnType.tp_dealloc = analysis_column_dealloc;
+        AnalysisColumnType.tp_as_buffer = &analysis_column_as_buffer;
+        AnalysisColumnType.tp_flags = Py_TPFLAGS_DEFAULT;
+        AnalysisColumnType.tp_doc = "Values of a column of a native analysis engine";
+        if (PyType_Ready(&AnalysisColumnType) < 0) {
+            delete data;
+            return NULL;
+        }
+        type_ready = true;
+    }
+    AnalysisColumnObject *c = PyObject_New(AnalysisColumnObject, &AnalysisColumnType);
+    if (c == NULL) {
+        delete data;
+        return NULL;
+    }
+    c->data = data;
+    c->n = (Py_ssize_t) n;
+    c->item_size = (Py_ssize_t) item_size;
+    strncpy(c->fmt, fmt, sizeof(c->fmt) - 1);
+    c->fmt[sizeof(c->fmt) - 1] = '\0';
+    PyObject *view = PyMemoryView_FromObject((PyObject *) c);
+    Py_DECREF(c);
+    return view;
+}
@@ -0,0 +1,125 @@
+/* analysis_engine.h
+ * Native analysis engines, which compute statistics from log packets while
+ * they are decoded, instead of in Python from the decoded lists.
+ *
+ * Decoders feed an engine through its own functions (e.g. lte_rlc_tracker.h),
+ * with values already in C variables. Engines are disabled by default, and
+ * their feed functions then return right away. Python enables, configures and
+ * reads engines by name, see dm_collector_c.enable_engine().
+ */
+
+#ifndef __DM_COLLECTOR_C_ANALYSIS_ENGINE_H__
+#define __DM_COLLECTOR_C_ANALYSIS_ENGINE_H__
+
+#include <Python.h>
+
+#include <string>
+#include <vector>
+
+struct AnalysisEngine {
+    const char *name;
+    bool enabled;
+    // Clear all state, then apply options, a dict or NULL for the defaults.
+    // Return: successful or not. If not, a Python exception is set
+    bool (*configure) (PyObject *options);
+    // Return: a new reference to the results accumulated since the last call,
+    // which are then cleared
+    PyObject *(*collect) ();
+    // Answer a query by name, with params a dict or NULL. NULL for engines
+    // without queries.
+    // Return: a new reference to the answer, or NULL with a Python exception set
+    PyObject *(*query) (const char *query, PyObject *params);
+};
+
+// Return: the engine of this name, or NULL
+struct AnalysisEngine *find_analysis_engine (const char *name);
+
+// Return: a new tuple of the names of all engines
+PyObject *get_analysis_engine_names ();
+
+// Record the QCDM timestamp of the log packet about to be decoded.
+void analysis_set_packet_timestamp (unsigned long long qcdm_timestamp);
+
+// Return: the time of the log packet being decoded, in seconds since the Unix
+// epoch
+double analysis_packet_time ();
+
+// LTE system time from the system and subframe numbers, in ms. It wraps
+// every LTE_SYS_TIME_MODULUS ms
+#define LTE_SYS_TIME_MODULUS 10240
+int lte_sys_time (int sys_fn, int sub_fn);
+
+// Return: ms from earlier to later, both from lte_sys_time()
+int lte_sys_time_diff (int later, int earlier);
+
+// Maps LTE system times to Unix time. Log packets are timestamped when they
+// are logged, after the subframes they report; a system time is placed in the
+// SFN cycle nearest to the time of its log packet. The phase between both is
+// taken from the first log packet, and again whenever system times move by
+// more than LTE_SYS_CLOCK_TOLERANCE ms from it (e.g. a new cell).
+#define LTE_SYS_CLOCK_TOLERANCE 1000
+struct LteSysClock {
+    bool anchored;
+    long long base;     // Unix time in ms of system time 0 in some SFN cycle
+};
+
+void lte_sys_clock_reset (struct LteSysClock *clock);
+
+// Return: the Unix time in ms of a system time from lte_sys_time()
+long long lte_sys_clock_to_unix_ms (struct LteSysClock *clock, int sys_time);
+
+// Read an option of a dict given to configure(). Missing keys keep *value.
+// Return: successful or not. If not, a Python exception is set
+bool analysis_get_int_option (PyObject *options, const char *key, long long *value);
+bool analysis_get_double_option (PyObject *options, const char *key, double *value);
+bool analysis_get_bool_option (PyObject *options, const char *key, bool *value);
+
+// Return: a new memoryview of a copy of values, with the struct format fmt
+// (e.g. "d"). The copy is made here, once; numpy.asarray() then shares the
+// memory of the memoryview
+PyObject *analysis_make_column (const void *values, size_t n, size_t item_size,
+                                const char *fmt);
+
+template <typename T>
+PyObject *
+analysis_make_column (const std::vector<T> &values, const char *fmt) {
+    return analysis_make_column(values.empty() ? NULL : &values[0], values.size(),
+                                sizeof(T), fmt);
+}
+
+// Storage of the values of a column handed over to Python
+struct AnalysisColumnData {
+    virtual ~AnalysisColumnData () {}
+    // Return: the values, or NULL if there are none
+    virtual const void *values () const = 0;
+};
+
+template <typename T>
+struct AnalysisVectorData : AnalysisColumnData {
+    std::vector<T> v;
+
+    const void *values () const {
+        return v.empty() ? NULL : &v[0];
+    }
+};
+
+// Return: a new memoryview of n values of data, with the struct format fmt,
+// which owns data and deletes it with the last view. NULL with a Python
+// exception set on failure, after deleting data
+PyObject *analysis_wrap_column (AnalysisColumnData *data, size_t n, size_t item_size,
+                                const char *fmt);
+
+// Like analysis_make_column(), but without copying: the memoryview takes the
+// storage of values, which is left empty. item_size is that of fmt, for
+// vectors of raw bytes
+template <typename T>
+PyObject *
+analysis_take_column (std::vector<T> &values, const char *fmt,
+                      size_t item_size = sizeof(T)) {
+    AnalysisVectorData<T> *data = new AnalysisVectorData<T>();
+    data->v.swap(values);
+    return analysis_wrap_column(data, data->v.size() * sizeof(T) / item_size,
+                                item_size, fmt);
+}
+
+#endif // __DM_COLLECTOR_C_ANALYSIS_ENGINE_H__
@@ -0,0 +1,314 @@
+/* block_log.cpp
+ * Implements the .mi2blk container, see block_log.h for the layout.
+ */
+
+#include "block_log.h"
+#include "consts.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const int ESCAPE_XOR = 0x20;
+
+static void
+put_u16 (std::string &out, unsigned int v) {
+    out.append(1, char(v & 0xFF));
+    out.append(1, char((v >> 8) & 0xFF));
+}
+
+static void
+put_u32 (std::string &out, unsigned int v) {
+    for (int i = 0; i < 4; i++)
+        out.append(1, char((v >> (8 * i)) & 0xFF));
+}
+
+static void
+put_u64 (std::string &out, unsigned long long v) {
+    for (int i = 0; i < 8; i++)
+        out.append(1, char((v >> (8 * i)) & 0xFF));
+}
+
+static unsigned long long
+get_uint (const char *p, int len) {
+    unsigned long long v = 0;
+    for (int i = len - 1; i >= 0; i--)
+        v = (v << 8) | (unsigned char) p[i];
+    return v;
+}
+
+static void
+reset_entry (BlockLogIndexEntry *entry) {
+    entry->offset = 0;
+    entry->compressed_size = 0;
+    entry->raw_size = 0;
+    entry->frame_count = 0;
+    entry->flags = 0;
+    entry->min_timestamp = 0;
+    entry->max_timestamp = 0;
+    entry->type_ids.clear();
+}
+
+// Unescape at most n bytes from the beginning of an HDLC-encoded frame.
+// Return: number of bytes written to out
+static size_t
+unescape_prefix (const char *raw, size_t length, char *out, size_t n) {
+    size_t j = 0;
+    bool esc = false;
+    for (size_t i = 0; i < length && j < n; i++) {
+        if (raw[i] == '\x7e')
+            break;
+        if (esc) {
+            out[j++] = char(raw[i] ^ ESCAPE_XOR);
+            esc = false;
+        } else if (raw[i] == '\x7d') {
+            esc = true;
+        } else {
+            out[j++] = raw[i];
+        }
+    }
+    return j;
+}
+
+// Record the type ID and timestamp of a frame in the current block.
+static void
+add_frame_metadata (struct BlockLogEncoder *enc, const char *raw, size_t length) {
+    BlockLogIndexEntry &entry = enc->current;
+    char buf[32];
+    size_t n = unescape_prefix(raw, length, buf, sizeof(buf));
+    const char *b = buf;
+    // Same wrapper as removed by check_frame_format()
+    if (n >= 8 && memcmp(b, "\x98\x01\x00\x00\x01\x00\x00\x00", 8) == 0) {
+        b += 8;
+        n -= 8;
+    }
+
+    entry.frame_count++;
+    int type_id = -1;
+    if (n >= 16 && b[0] == '\x10') {
+        // 2 (0x1000) + 2 (len1) + 2 (log_msg_len) + 2 (type_id) + 8 (timestamp)
+        type_id = (int) get_uint(b + 6, 2);
+        unsigned long long ts = get_uint(b + 8, 8);
+        if (entry.min_timestamp == 0 || ts < entry.min_timestamp)
+            entry.min_timestamp = ts;
+        if (ts > entry.max_timestamp)
+            entry.max_timestamp = ts;
+    } else if (n >= 2 && (b[0] == '\x79' || b[0] == '\x92')) {
+        type_id = Modem_debug_message;
+    } else {
+        entry.flags |= BLOCK_LOG_FLAG_UNTYPED;
+    }
+
+    if (type_id >= 0) {
+        std::vector<unsigned short> &ids = entry.type_ids;
+        if (std::find(ids.begin(), ids.end(), (unsigned short) type_id) == ids.end())
+            ids.push_back((unsigned short) type_id);
+    }
+}
+
+void
+block_log_init (struct BlockLogEncoder *enc, int level, std::string &out) {
+    enc->level = level;
+    enc->block.clear();
+    enc->block.reserve(BLOCK_LOG_BLOCK_SIZE);
+    enc->index.clear();
+    reset_entry(&enc->current);
+
+    out.append(BLOCK_LOG_MAGIC, 8);
+    put_u32(out, BLOCK_LOG_VERSION);
+    put_u32(out, 0);
+    enc->offset = BLOCK_LOG_HEADER_SIZE;
+}
+
+void
+block_log_flush_block (struct BlockLogEncoder *enc, std::string &out) {
+    if (enc->block.empty())
+        return;
+
+    uLongf compressed_size = compressBound(enc->block.size());
+    size_t start = out.size();
+    out.resize(start + BLOCK_LOG_BLOCK_HEADER_SIZE + compressed_size);
+    int ret = compress2((Bytef *) &out[start + BLOCK_LOG_BLOCK_HEADER_SIZE], &compressed_size,
+                        (const Bytef *) enc->block.data(), enc->block.size(), enc->level);
+    if (ret != Z_OK) {
+        // Should not happen since the output buffer is large enough
+        out.resize(start);
+        enc->block.clear();
+        reset_entry(&enc->current);
+        return;
+    }
+    out.resize(start + BLOCK_LOG_BLOCK_HEADER_SIZE + compressed_size);
+    std::string header(BLOCK_LOG_BLOCK_MAGIC, 4);
+    put_u32(header, (unsigned int) compressed_size);
+    put_u32(header, (unsigned int) enc->block.size());
+    out.replace(start, BLOCK_LOG_BLOCK_HEADER_SIZE, header);
+
+    BlockLogIndexEntry &entry = enc->current;
+    entry.offset = enc->offset;
+    entry.compressed_size = (unsigned int) compressed_size;
+    entry.raw_size = (unsigned int) enc->block.size();
+    std::sort(entry.type_ids.begin(), entry.type_ids.end());
+    enc->index.push_back(entry);
+    enc->offset += BLOCK_LOG_BLOCK_HEADER_SIZE + compressed_size;
+
+    enc->block.clear();
+    reset_entry(&enc->current);
+}
+
+void
+block_log_add_frames (struct BlockLogEncoder *enc, const char *raw, size_t length,
+                        std::string &out) {
+    const char *end = raw + length;
+    while (raw < end) {
+        const char *delim = (const char *) memchr(raw, '\x7e', end - raw);
+        size_t n = (delim == NULL ? end : delim + 1) - raw;
+        if (n > 1)  // skip empty frames
+            add_frame_metadata(enc, raw, n);
+        enc->block.append(raw, n);
+        raw += n;
+        if (enc->block.size() >= BLOCK_LOG_BLOCK_SIZE)
+            block_log_flush_block(enc, out);
+    }
+}
+
+void
+block_log_finish (struct BlockLogEncoder *enc, std::string &out) {
+    block_log_flush_block(enc, out);
+
+    size_t start = out.size();
+    for (size_t i = 0; i < enc->index.size(); i++) {
+        const BlockLogIndexEntry &entry = enc->index[i];
+        put_u64(out, entry.offset);
+        put_u32(out, entry.compressed_size);
+        put_u32(out, entry.raw_size);
+        put_u32(out, entry.frame_count);
+        put_u32(out, entry.flags);
+        put_u64(out, entry.min_timestamp);
+        put_u64(out, entry.max_timestamp);
+        put_u16(out, (unsigned int) entry.type_ids.size());
+        for (size_t j = 0; j < entry.type_ids.size(); j++)
+            put_u16(out, entry.type_ids[j]);
+    }
+    put_u64(out, enc->offset);
+    put_u32(out, (unsigned int) (out.size() - start));
+    put_u32(out, (unsigned int) enc->index.size());
+    out.append(BLOCK_LOG_INDEX_MAGIC, 8);
+    enc->offset += out.size() - start;
+    enc->index.clear();
+}
+
+// Return: successful or not
+static bool
+write_out (FILE *fp, std::string &out) {
+    size_t cnt = fwrite(out.data(), sizeof(char), out.size(), fp);
+    bool success = (cnt == out.size());
+    out.clear();
+    return success;
+}
+
+bool
+block_log_from_mi2log (const char *src_path, const char *dst_path, int level) {
+    FILE *src = fopen(src_path, "rb");
+    if (src == NULL)
+        return false;
+    FILE *dst = fopen(dst_path, "wb");
+    if (dst == NULL) {
+        fclose(src);
+        return false;
+    }
+
+    BlockLogEncoder enc;
+    std::string out;
+    std::string pending;    // Bytes of an incomplete frame
+    std::vector<char> buf(BLOCK_LOG_BLOCK_SIZE);
+    bool success = true;
+    block_log_init(&enc, level, out);
+    while (success) {
+        size_t n = fread(buf.data(), sizeof(char), buf.size(), src);
+        if (n == 0)
+            break;
+        pending.append(buf.data(), n);
+        size_t last = pending.find_last_of('\x7e');
+        if (last == std::string::npos)
+            continue;
+        block_log_add_frames(&enc, pending.data(), last + 1, out);
+        pending.erase(0, last + 1);
+        success = write_out(dst, out);
+    }
+    // A trailing incomplete frame is kept, as it would be in a .mi2log
+    if (!pending.empty())
+        block_log_add_frames(&enc, pending.data(), pending.size(), out);
+    block_log_finish(&enc, out);
+    success = write_out(dst, out) && success && !ferror(src);
+
+    fclose(src);
+    if (fclose(dst) != 0)
+        success = false;
+    return success;
+}
+
+bool
+block_log_to_mi2log (const char *src_path, const char *dst_path) {
+    FILE *src = fopen(src_path, "rb");
+    if (src == NULL)
+        return false;
+
+    char header[BLOCK_LOG_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), src) != sizeof(header)
+            || memcmp(header, BLOCK_LOG_MAGIC, 8) != 0) {
+        fclose(src);
+        return false;
+    }
+
+    // Blocks end where the index starts. Without a trailer, read until EOF.
+    unsigned long long blocks_end = (unsigned long long) -1;
+    char trailer[BLOCK_LOG_TRAILER_SIZE];
+    if (fseek(src, -BLOCK_LOG_TRAILER_SIZE, SEEK_END) == 0
+            && fread(trailer, 1, sizeof(trailer), src) == sizeof(trailer)
+            && memcmp(trailer + 16, BLOCK_LOG_INDEX_MAGIC, 8) == 0) {
+        blocks_end = get_uint(trailer, 8);
+    }
+    fseek(src, BLOCK_LOG_HEADER_SIZE, SEEK_SET);
+
+    FILE *dst = fopen(dst_path, "wb");
+    if (dst == NULL) {
+        fclose(src);
+        return false;
+    }
+
+    bool success = true;
+    unsigned long long offset = BLOCK_LOG_HEADER_SIZE;
+    std::vector<char> compressed, raw;
+    while (offset < blocks_end) {
+        char block_header[BLOCK_LOG_BLOCK_HEADER_SIZE];
+        if (fread(block_header, 1, sizeof(block_header), src) != sizeof(block_header)
+                || memcmp(block_header, BLOCK_LOG_BLOCK_MAGIC, 4) != 0)
+            break;
+        unsigned int compressed_size = (unsigned int) get_uint(block_header + 4, 4);
+        unsigned int raw_size = (unsigned int) get_uint(block_header + 8, 4);
+        compressed.resize(compressed_size);
+        raw.resize(raw_size);
+        if (fread(compressed.data(), 1, compressed_size, src) != compressed_size) {
+            success = false;
+            break;
+        }
+        uLongf n = raw_size;
+        if (uncompress((Bytef *) raw.data(), &n, (const Bytef *) compressed.data(),
+                       compressed_size) != Z_OK || n != raw_size) {
+            success = false;
+            break;
+        }
+        if (fwrite(raw.data(), 1, raw_size, dst) != raw_size) {
+            success = false;
+            break;
+        }
+        offset += BLOCK_LOG_BLOCK_HEADER_SIZE + compressed_size;
+    }
+
+    fclose(src);
+    if (fclose(dst) != 0)
+        success = false;
+    return success;
+}
@@ -0,0 +1,82 @@
+/* block_log.h
+ * Defines a seekable container for raw logs (.mi2blk).
+ *
+ * The file holds the same HDLC frames as a .mi2log, grouped into blocks that
+ * are deflated independently, so that blocks can be decompressed in parallel
+ * and skipped by time or log type. All integers are little endian.
+ *
+ *   header:  "MI2BLK01", u32 version, u32 reserved
+ *   block:   "MIBK", u32 compressed_size, u32 raw_size, zlib stream
+ *   ...
+ *   index:   one entry per block, see BlockLogIndexEntry
+ *   trailer: u64 index_offset, u32 index_size, u32 block_count, "MI2BIDX1"
+ *
+ * An index entry is u64 offset (of the block header), u32 compressed_size,
+ * u32 raw_size, u32 frame_count, u32 flags, u64 min_timestamp,
+ * u64 max_timestamp, u16 n_type_ids, followed by n_type_ids sorted u16 type
+ * IDs. Timestamps are raw QCDM timestamps (1/52428800 s since 1980-01-06).
+ *
+ * If the trailer is missing (e.g. the writer was killed), blocks can still
+ * be read one after another from the header.
+ */
+
+#ifndef __DM_COLLECTOR_C_BLOCK_LOG_H__
+#define __DM_COLLECTOR_C_BLOCK_LOG_H__
+
+#include <string>
+#include <vector>
+
+#define BLOCK_LOG_MAGIC "MI2BLK01"
+#define BLOCK_LOG_BLOCK_MAGIC "MIBK"
+#define BLOCK_LOG_INDEX_MAGIC "MI2BIDX1"
+#define BLOCK_LOG_VERSION 1
+#define BLOCK_LOG_HEADER_SIZE 16
+#define BLOCK_LOG_BLOCK_HEADER_SIZE 12
+#define BLOCK_LOG_TRAILER_SIZE 24
+
+// Raw bytes of frames collected before a block is compressed.
+#define BLOCK_LOG_BLOCK_SIZE (1024 * 1024)
+
+// The block holds frames that are not log packets (e.g. custom packets), so
+// it should not be skipped by type.
+#define BLOCK_LOG_FLAG_UNTYPED 0x1
+
+struct BlockLogIndexEntry {
+    unsigned long long offset;
+    unsigned int compressed_size;
+    unsigned int raw_size;
+    unsigned int frame_count;
+    unsigned int flags;
+    unsigned long long min_timestamp;   // 0 if no frame has a timestamp
+    unsigned long long max_timestamp;
+    std::vector<unsigned short> type_ids;
+};
+
+struct BlockLogEncoder {
+    int level;              // zlib compression level
+    unsigned long long offset;  // Bytes produced so far
+    std::string block;      // Frames of the current block
+    BlockLogIndexEntry current;
+    std::vector<BlockLogIndexEntry> index;
+};
+
+// Must be called before usage. Bytes to be written to the file are always
+// appended to out.
+void block_log_init (struct BlockLogEncoder *enc, int level, std::string &out);
+
+// Add HDLC-encoded frames. raw must hold whole frames, each ending with 0x7e.
+void block_log_add_frames (struct BlockLogEncoder *enc, const char *raw, size_t length,
+                            std::string &out);
+
+// Compress the current block, even if it is not full.
+void block_log_flush_block (struct BlockLogEncoder *enc, std::string &out);
+
+// Compress the last block, then write the index and the trailer.
+void block_log_finish (struct BlockLogEncoder *enc, std::string &out);
+
+// Converters between .mi2log and .mi2blk files.
+// Return: successful or not
+bool block_log_from_mi2log (const char *src_path, const char *dst_path, int level);
+bool block_log_to_mi2log (const char *src_path, const char *dst_path);
+
+#endif // __DM_COLLECTOR_C_BLOCK_LOG_H__
@@ -12,6 +12,10 @@
 #include "log_config.h"
 #include "log_packet.h"
 #include "export_manager.h"
+#include "pcap_export.h"
+#include "analysis_engine.h"
+#include "block_log.h"
+#include "msg_classifier.h"
 
 #include <string>
 #include <vector>
@@ -31,10 +35,12 @@
 #endif
 
 // NOTE: the following number should be updated every time.
-#define DM_COLLECTOR_C_VERSION "1.0.12"
+#define DM_COLLECTOR_C_VERSION "1.0.13"
 
 // Global variable to control exportation of raw log
 static ExportManagerState g_emanager;
+// Global variable to control exportation of raw signaling messages to pcapng
+static PcapExportState g_pcap_export;
 
 static PyObject *dm_collector_c_disable_logs(PyObject *self, PyObject *args);
 
@@ -44,6 +50,26 @@ static PyObject *dm_collector_c_set_filtered_export(PyObject *self, PyObject *ar
 
 static PyObject *dm_collector_c_set_filtered(PyObject *self, PyObject *args);
 
+static PyObject *dm_collector_c_get_export_stats(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_set_pcap_export(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_get_pcap_export_stats(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_enable_engine(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_disable_engine(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_collect_engine(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_query_engine(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_get_type_ids(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_convert_to_block_log(PyObject *self, PyObject *args);
+
+static PyObject *dm_collector_c_convert_from_block_log(PyObject *self, PyObject *args);
+
 static PyObject *dm_collector_c_generate_diag_cfg(PyObject *self, PyObject *args);
 
 static PyObject *dm_collector_c_feed_binary(PyObject *self, PyObject *args);
@@ -54,6 +80,8 @@ static PyObject *dm_collector_c_receive_log_packet(PyObject *self, PyObject *arg
 
 static PyObject *dm_collector_c_set_sampling_rate(PyObject *self, PyObject *args);
 
+static PyObject *dm_collector_c_set_msg_types(PyObject *self, PyObject *args);
+
 static PyMethodDef DmCollectorCMethods[] = {
         {"disable_logs",        dm_collector_c_disable_logs,        METH_VARARGS,
                                                                        "Disable logs for a serial port.\n"
@@ -92,8 +120,26 @@ static PyMethodDef DmCollectorCMethods[] = {
         {"set_filtered_export", dm_collector_c_set_filtered_export, METH_VARARGS,
                                                                        "Configure this moduel to output a filtered log file.\n"
                                                                        "\n"
+                                                                       "The file is written by a background thread. If it cannot\n"
+                                                                       "keep up, frames are dropped (see get_export_stats()).\n"
+                                                                       "\n"
                                                                        "Args:\n"
+                                                                       "    path: the file to be written.\n"
                                                                        "    type_names: a sequence of type names.\n"
+                                                                       "    sync_interval: seconds between fdatasync() calls on the\n"
+                                                                       "        file. Default to 0 (never).\n"
+                                                                       "    max_segment_bytes: start a new file after this many bytes of\n"
+                                                                       "        log. Default to 0 (no limit).\n"
+                                                                       "    max_segment_seconds: start a new file after this many seconds.\n"
+                                                                       "        Default to 0 (no limit).\n"
+                                                                       "    compression: None, \"gzip\" or \"block\" (indexed .mi2blk file,\n"
+                                                                       "        see convert_to_block_log()). Default to None.\n"
+                                                                       "\n"
+                                                                       "    When files are rotated, path is a naming pattern. \"{seq}\" is\n"
+                                                                       "    replaced by the file number and strftime() conversions by\n"
+                                                                       "    the current time. \"_{seq}\" is inserted before the extension\n"
+                                                                       "    if path has no \"{seq}\". Gzip files end with \".gz\", and block\n"
+                                                                       "    files with \".mi2blk\".\n"
                                                                        "\n"
                                                                        "Returns:\n"
                                                                        "    Successful or not.\n"
@@ -113,6 +159,153 @@ static PyMethodDef DmCollectorCMethods[] = {
                                                                        "Raises\n"
                                                                        "    ValueError: when an unrecognized type name is passed in.\n"
         },
+        {"get_export_stats",    dm_collector_c_get_export_stats,    METH_VARARGS,
+                                                                       "Get statistics of the filtered log export.\n"
+                                                                       "\n"
+                                                                       "Counters accumulate over all exported files.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    A dict with queue_depth, queue_capacity, frames_queued,\n"
+                                                                       "    bytes_queued, frames_dropped, bytes_dropped, bytes_written,\n"
+                                                                       "    segments, syncs and write_errors.\n"
+        },
+        {"set_pcap_export",     dm_collector_c_set_pcap_export,     METH_VARARGS,
+                                                                       "Export the raw signaling messages of received log packets\n"
+                                                                       "to a pcapng file, for bulk dissection with tshark.\n"
+                                                                       "\n"
+                                                                       "Each message is an AWW frame, as sent to ws_dissector, of link\n"
+                                                                       "type USER1 (DLT 148), timestamped with the time of its log\n"
+                                                                       "packet. Only logs selected by set_filtered() are exported. The\n"
+                                                                       "file is written by a background thread, like with\n"
+                                                                       "set_filtered_export().\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    path: the file to be written, or None to stop exporting.\n"
+                                                                       "    max_segment_bytes: start a new file after this many bytes of\n"
+                                                                       "        packets. Default to 0 (no limit).\n"
+                                                                       "    max_segment_seconds: start a new file after this many seconds.\n"
+                                                                       "        Default to 0 (no limit).\n"
+                                                                       "    compression: None or \"gzip\". Default to None.\n"
+                                                                       "\n"
+                                                                       "    Rotated files are named as with set_filtered_export(). Each\n"
+                                                                       "    one is a complete pcapng file.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    Successful or not.\n"
+                                                                       "\n"
+                                                                       "Raises\n"
+                                                                       "    ValueError: when an unsupported compression is passed in.\n"
+        },
+        {"get_pcap_export_stats", dm_collector_c_get_pcap_export_stats, METH_VARARGS,
+                                                                       "Get statistics of the pcapng export.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    A dict with the same counters as get_export_stats(), where\n"
+                                                                       "    frames are packets, and unknown_msgs, the number of raw\n"
+                                                                       "    messages of a type that ws_dissector does not support.\n"
+        },
+        {"enable_engine",       dm_collector_c_enable_engine,       METH_VARARGS,
+                                                                       "Enable a native analysis engine, which computes results from log\n"
+                                                                       "packets while they are decoded. Its state is cleared first, so this\n"
+                                                                       "also restarts an enabled engine with new options.\n"
+                                                                       "\n"
+                                                                       "Engines only see log packets that are decoded, i.e. not skipped\n"
+                                                                       "by receive_log_packet(), of the types they document.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    name: one of analysis_engines.\n"
+                                                                       "    options: a dict of options of the engine, or None for the\n"
+                                                                       "        defaults. Default to None.\n"
+                                                                       "\n"
+                                                                       "Raises\n"
+                                                                       "    ValueError: when an unknown engine or a bad option is passed in.\n"
+        },
+        {"disable_engine",      dm_collector_c_disable_engine,      METH_VARARGS,
+                                                                       "Stop feeding an analysis engine. Its results are kept until\n"
+                                                                       "collected.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    name: one of analysis_engines.\n"
+                                                                       "\n"
+                                                                       "Raises\n"
+                                                                       "    ValueError: when an unknown engine is passed in.\n"
+        },
+        {"collect_engine",      dm_collector_c_collect_engine,      METH_VARARGS,
+                                                                       "Get the results of an analysis engine since the last call.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    name: one of analysis_engines.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    The results, whose format is documented by each engine.\n"
+                                                                       "\n"
+                                                                       "Raises\n"
+                                                                       "    ValueError: when an unknown engine is passed in.\n"
+        },
+        {"query_engine",        dm_collector_c_query_engine,        METH_VARARGS,
+                                                                       "Ask an analysis engine about the state it keeps, e.g. the best\n"
+                                                                       "beam of a cell. Only some engines have queries.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    name: one of analysis_engines.\n"
+                                                                       "    query: one of the queries documented by the engine.\n"
+                                                                       "    params: a dict of parameters of the query, or None for the\n"
+                                                                       "        defaults. Default to None.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    The answer, whose format is documented by the engine.\n"
+                                                                       "\n"
+                                                                       "Raises\n"
+                                                                       "    ValueError: when an unknown engine or query, or a bad parameter\n"
+                                                                       "        is passed in.\n"
+        },
+        {"set_msg_types",       dm_collector_c_set_msg_types,       METH_VARARGS,
+                                                                       "Add a \"Msg Type\" field before every raw signaling message of\n"
+                                                                       "the decoded log packets, with the type of the message (e.g.\n"
+                                                                       "\"rrcConnectionReconfiguration\" or \"Attach accept\") as told by its\n"
+                                                                       "first bits, without dissecting it. Off by default.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    enabled: add the fields or not.\n"
+        },
+        {"get_type_ids",        dm_collector_c_get_type_ids,        METH_VARARGS,
+                                                                       "Map type names to the IDs found in raw logs.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    type_names: a sequence of type names.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    A sorted tuple of type IDs.\n"
+                                                                       "\n"
+                                                                       "Raises\n"
+                                                                       "    ValueError: when an unrecognized type name is passed in.\n"
+        },
+        {"convert_to_block_log", dm_collector_c_convert_to_block_log, METH_VARARGS,
+                                                                       "Convert a .mi2log file into an indexed .mi2blk file.\n"
+                                                                       "\n"
+                                                                       "A .mi2blk file holds the same frames, grouped into blocks that\n"
+                                                                       "are compressed independently. An index at the end of the file\n"
+                                                                       "records the time range and type IDs of each block, so that a\n"
+                                                                       "reader can skip blocks.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    src: the .mi2log file.\n"
+                                                                       "    dst: the .mi2blk file to be written.\n"
+                                                                       "    level: zlib compression level (1-9). Default to 6.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    Successful or not.\n"
+        },
+        {"convert_from_block_log", dm_collector_c_convert_from_block_log, METH_VARARGS,
+                                                                       "Convert a .mi2blk file back into a .mi2log file.\n"
+                                                                       "\n"
+                                                                       "Args:\n"
+                                                                       "    src: the .mi2blk file.\n"
+                                                                       "    dst: the .mi2log file to be written.\n"
+                                                                       "\n"
+                                                                       "Returns:\n"
+                                                                       "    Successful or not.\n"
+        },
         {"feed_binary",         dm_collector_c_feed_binary,         METH_VARARGS,
                                                                        "Feed raw packets."},
         {"reset",               dm_collector_c_reset,               METH_VARARGS,
@@ -442,6 +635,15 @@ dm_collector_c_set_sampling_rate(PyObject *self, PyObject *args) {
 
 }
 
+static PyObject *
+dm_collector_c_set_msg_types(PyObject *self, PyObject *args) {
+    (void) self;
+    int enabled;
+    if (!PyArg_ParseTuple(args, "p", &enabled))
+        return NULL;
+    set_msg_types_enabled(enabled != 0);
+    Py_RETURN_NONE;
+}
 
 // Return: successful or not
 static PyObject *
@@ -487,10 +689,15 @@ dm_collector_c_set_filtered_export(PyObject *self, PyObject *args) {
     (void) self;
     const char *path;
     PyObject *sequence = NULL;
+    const char *compression = NULL;
+    LogWriterOptions options;
     IdVector type_ids;
     bool success = false;
 
-    if (!PyArg_ParseTuple(args, "sO", &path, &sequence)) {
+    writer_init_options(&options);
+    if (!PyArg_ParseTuple(args, "sO|dKdz", &path, &sequence, &options.sync_interval,
+                          &options.max_segment_bytes, &options.max_segment_seconds,
+                          &compression)) {
         return NULL;
     }
     Py_INCREF(sequence);
@@ -500,6 +707,16 @@ dm_collector_c_set_filtered_export(PyObject *self, PyObject *args) {
         PyErr_SetString(PyExc_TypeError, "\'type_names\' is not a sequence.");
         goto raise_exception;
     }
+    if (compression == NULL || strcmp(compression, "") == 0) {
+        options.compression = WRITER_COMPRESSION_NONE;
+    } else if (strcmp(compression, "gzip") == 0 || strcmp(compression, "zlib") == 0) {
+        options.compression = WRITER_COMPRESSION_GZIP;
+    } else if (strcmp(compression, "block") == 0) {
+        options.compression = WRITER_COMPRESSION_BLOCK;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "Unsupported compression.");
+        goto raise_exception;
+    }
 
     success = map_typenames_to_ids(sequence, type_ids);
     if (!success) {
@@ -508,7 +725,7 @@ dm_collector_c_set_filtered_export(PyObject *self, PyObject *args) {
     }
     Py_DECREF(sequence);
 
-    manager_change_config(&g_emanager, path, type_ids);
+    manager_change_config(&g_emanager, path, type_ids, &options);
     Py_RETURN_TRUE;
 
     raise_exception:
@@ -550,6 +767,228 @@ dm_collector_c_set_filtered(PyObject *self, PyObject *args) {
     return NULL;
 }
 
+static PyObject *
+build_export_stats(const LogWriterStats &stats) {
+    return Py_BuildValue("{s:n,s:n,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+                         "queue_depth", (Py_ssize_t) stats.queue_depth,
+                         "queue_capacity", (Py_ssize_t) stats.queue_capacity,
+                         "frames_queued", stats.frames_queued,
+                         "bytes_queued", stats.bytes_queued,
+                         "frames_dropped", stats.frames_dropped,
+                         "bytes_dropped", stats.bytes_dropped,
+                         "bytes_written", stats.bytes_written,
+                         "segments", stats.segments,
+                         "syncs", stats.syncs,
+                         "write_errors", stats.write_errors);
+}
+
+// Return: a dict of export statistics
+static PyObject *
+dm_collector_c_get_export_stats(PyObject *self, PyObject *args) {
+    (void) self;
+    (void) args;
+    LogWriterStats stats;
+    manager_get_stats(&g_emanager, &stats);
+    return build_export_stats(stats);
+}
+
+// Return: successful or not
+static PyObject *
+dm_collector_c_set_pcap_export(PyObject *self, PyObject *args) {
+    (void) self;
+    const char *path;
+    const char *compression = NULL;
+    LogWriterOptions options;
+    bool success = false;
+
+    writer_init_options(&options);
+    if (!PyArg_ParseTuple(args, "z|Kdz", &path, &options.max_segment_bytes,
+                          &options.max_segment_seconds, &compression)) {
+        return NULL;
+    }
+    if (compression == NULL || strcmp(compression, "") == 0) {
+        options.compression = WRITER_COMPRESSION_NONE;
+    } else if (strcmp(compression, "gzip") == 0) {
+        options.compression = WRITER_COMPRESSION_GZIP;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "Unsupported compression.");
+        return NULL;
+    }
+
+    if (path == NULL) {
+        pcap_export_close(&g_pcap_export);
+        Py_RETURN_TRUE;
+    }
+    success = pcap_export_open(&g_pcap_export, path, &options);
+    if (success)
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+// Return: a dict of pcapng export statistics
+static PyObject *
+dm_collector_c_get_pcap_export_stats(PyObject *self, PyObject *args) {
+    (void) self;
+    (void) args;
+    LogWriterStats stats;
+    pcap_export_get_stats(&g_pcap_export, &stats);
+    PyObject *ret = build_export_stats(stats);
+    PyObject *unknown = PyLong_FromUnsignedLongLong(g_pcap_export.unknown_msgs);
+    PyDict_SetItemString(ret, "unknown_msgs", unknown);
+    Py_DECREF(unknown);
+    return ret;
+}
+
+// Return: the engine named by the first argument, or NULL with an exception set
+static AnalysisEngine *
+parse_engine_name(PyObject *args, PyObject **options) {
+    const char *name;
+    if (!PyArg_ParseTuple(args, options ? "s|O" : "s", &name, options))
+        return NULL;
+    AnalysisEngine *engine = find_analysis_engine(name);
+    if (engine == NULL)
+        PyErr_Format(PyExc_ValueError, "Unknown analysis engine: %s", name);
+    return engine;
+}
+
+static PyObject *
+dm_collector_c_enable_engine(PyObject *self, PyObject *args) {
+    (void) self;
+    PyObject *options = NULL;
+    AnalysisEngine *engine = parse_engine_name(args, &options);
+    if (engine == NULL)
+        return NULL;
+    if (options == Py_None)
+        options = NULL;
+    if (options != NULL && !PyDict_Check(options)) {
+        PyErr_SetString(PyExc_TypeError, "options must be a dict or None");
+        return NULL;
+    }
+    engine->enabled = false;
+    if (!engine->configure(options))
+        return NULL;
+    engine->enabled = true;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+dm_collector_c_disable_engine(PyObject *self, PyObject *args) {
+    (void) self;
+    AnalysisEngine *engine = parse_engine_name(args, NULL);
+    if (engine == NULL)
+        return NULL;
+    engine->enabled = false;
+    Py_RETURN_NONE;
+}
+
+// Return: the results of an engine since the last call
+static PyObject *
+dm_collector_c_collect_engine(PyObject *self, PyObject *args) {
+    (void) self;
+    AnalysisEngine *engine = parse_engine_name(args, NULL);
+    if (engine == NULL)
+        return NULL;
+    return engine->collect();
+}
+
+// Return: the answer of an engine to a query
+static PyObject *
+dm_collector_c_query_engine(PyObject *self, PyObject *args) {
+    (void) self;
+    const char *name;
+    const char *query;
+    PyObject *params = NULL;
+    if (!PyArg_ParseTuple(args, "ss|O", &name, &query, &params))
+        return NULL;
+    AnalysisEngine *engine = find_analysis_engine(name);
+    if (engine == NULL) {
+        PyErr_Format(PyExc_ValueError, "Unknown analysis engine: %s", name);
+        return NULL;
+    }
+    if (params == Py_None)
+        params = NULL;
+    if (params != NULL && !PyDict_Check(params)) {
+        PyErr_SetString(PyExc_TypeError, "params must be a dict or None");
+        return NULL;
+    }
+    if (engine->query == NULL) {
+        PyErr_Format(PyExc_ValueError, "Analysis engine %s has no queries", name);
+        return NULL;
+    }
+    return engine->query(query, params);
+}
+
+// Return: a tuple of type IDs
+static PyObject *
+dm_collector_c_get_type_ids(PyObject *self, PyObject *args) {
+    (void) self;
+    PyObject *sequence = NULL;
+    IdVector type_ids;
+
+    if (!PyArg_ParseTuple(args, "O", &sequence)) {
+        return NULL;
+    }
+    if (!PySequence_Check(sequence)) {
+        PyErr_SetString(PyExc_TypeError, "\'type_names\' is not a sequence.");
+        return NULL;
+    }
+    if (!map_typenames_to_ids(sequence, type_ids)) {
+        PyErr_SetString(PyExc_ValueError, "Wrong type name.");
+        return NULL;
+    }
+
+    sort(type_ids.begin(), type_ids.end());
+    type_ids.erase(std::unique(type_ids.begin(), type_ids.end()), type_ids.end());
+    PyObject *ret = PyTuple_New(type_ids.size());
+    for (size_t i = 0; i < type_ids.size(); i++) {
+        // PyTuple_SetItem steals the reference
+        PyTuple_SetItem(ret, i, PyLong_FromLong(type_ids[i]));
+    }
+    return ret;
+}
+
+// Return: successful or not
+static PyObject *
+dm_collector_c_convert_to_block_log(PyObject *self, PyObject *args) {
+    (void) self;
+    const char *src;
+    const char *dst;
+    int level = 6;
+    bool success = false;
+
+    if (!PyArg_ParseTuple(args, "ss|i", &src, &dst, &level)) {
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    success = block_log_from_mi2log(src, dst, level);
+    Py_END_ALLOW_THREADS
+    if (success)
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+// Return: successful or not
+static PyObject *
+dm_collector_c_convert_from_block_log(PyObject *self, PyObject *args) {
+    (void) self;
+    const char *src;
+    const char *dst;
+    bool success = false;
+
+    if (!PyArg_ParseTuple(args, "ss", &src, &dst)) {
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    success = block_log_to_mi2log(src, dst);
+    Py_END_ALLOW_THREADS
+    if (success)
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
 // Return: successful or not
 static PyObject *
 dm_collector_c_generate_diag_cfg(PyObject *self, PyObject *args) {
@@ -641,6 +1080,8 @@ dm_collector_c_reset(PyObject *self, PyObject *args) {
     (void) self;
     (void) args;
     reset_binary();
+    manager_flush(&g_emanager);
+    pcap_export_flush(&g_pcap_export);
     Py_RETURN_NONE;
 }
 
@@ -651,7 +1092,7 @@ dm_collector_c_receive_log_packet(PyObject *self, PyObject *args) {
 
     // (void)self;
 
-    std::string frame;
+    std::string frame, raw_frame;
     bool crc_correct = false;
     bool skip_decoding = false, include_timestamp = false;  // default values
     double posix_timestamp = (include_timestamp ? get_posix_timestamp() : -1.0);
@@ -677,14 +1118,17 @@ dm_collector_c_receive_log_packet(PyObject *self, PyObject *args) {
     while (success) {
         // Keep reading the buffer in case there are any frames remained.
 
-        success = get_next_frame(frame, crc_correct);
+        success = get_next_frame(frame, raw_frame, crc_correct);
         // printf("success=%d crc_correct=%d is_log_packet=%d\n", success, crc_correct, is_log_packet(frame.c_str(), frame.size()));
         // if (success && crc_correct && is_log_packet(frame.c_str(), frame.size())) {
         //
 
         if (success && crc_correct) {
 
-            check_frame_format(frame);
+            // The CRC of the raw frame covers the wrapper, so such frames are
+            // encoded again to be exported without it.
+            if (check_frame_format(frame))
+                raw_frame = encode_hdlc_frame(frame.c_str(), frame.size());
 
             // Check if it is custom packet
             if(is_custom_packet(frame.c_str(), frame.size())) {
@@ -703,13 +1147,20 @@ dm_collector_c_receive_log_packet(PyObject *self, PyObject *args) {
                 }
             }
 
-            if (!manager_export_binary(&g_emanager, frame.c_str(), frame.size()))
+            if (!manager_export_binary(&g_emanager, frame.c_str(), frame.size(),
+                                       raw_frame.c_str(), raw_frame.size()))
                 continue;
             if (is_log_packet(frame.c_str(), frame.size())) {
                 const char *s = frame.c_str();
                 PyObject *decoded = decode_log_packet(s + 2,  // skip first two bytes
                                                       frame.size() - 2,
                                                       skip_decoding);
+                if (g_pcap_export.writer.opened && frame.size() >= 16) {
+                    // 8 = 2 (0x1000) + 2 (len1) + 2 (log_msg_len) + 2 (type_id)
+                    unsigned long long qcdm_timestamp;
+                    memcpy(&qcdm_timestamp, s + 8, sizeof(qcdm_timestamp));
+                    pcap_export_packet(&g_pcap_export, decoded, qcdm_timestamp);
+                }
 		if (include_timestamp) {
                     PyObject *ret = Py_BuildValue("(Od)", decoded, posix_timestamp);
 
@@ -777,6 +1228,14 @@ dm_collector_c_receive_log_packet(PyObject *self, PyObject *args) {
     Py_RETURN_NONE;
 }
 
+// Write out frames still staged by the export manager and the pcapng export
+// when Python exits, and stop their writer threads.
+static void
+dm_collector_c_atexit(void) {
+    manager_close(&g_emanager);
+    pcap_export_close(&g_pcap_export);
+}
+
 // Init the module
 PyMODINIT_FUNC
 PyInit_dm_collector_c(void) {
@@ -835,11 +1294,18 @@ PyInit_dm_collector_c(void) {
     PyObject_SetAttrString(dm_collector_c, "log_packet_types", log_packet_types);
     Py_DECREF(log_packet_types);
 
+    // dm_collector_c.analysis_engines: names of the native analysis engines
+    PyObject *analysis_engines = get_analysis_engine_names();
+    PyObject_SetAttrString(dm_collector_c, "analysis_engines", analysis_engines);
+    Py_DECREF(analysis_engines);
+
     // dm_ccllector_c.version: stores the value of DM_COLLECTOR_C_VERSION
     PyObject *pystr = PyUnicode_FromString(DM_COLLECTOR_C_VERSION);
     PyObject_SetAttrString(dm_collector_c, "version", pystr);
     Py_DECREF(pystr);
 
     manager_init_state(&g_emanager);
+    pcap_export_init_state(&g_pcap_export);
+    Py_AtExit(dm_collector_c_atexit);
     return dm_collector_c;
 }
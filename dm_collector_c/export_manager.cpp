@@ -9,10 +9,11 @@
 
 #include "consts.h"
 #include "export_manager.h"
-#include "hdlc.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
 
+#include <thread>
+
 // A simple but dirty function to retrieve type ID.
 // Return -1 if the packet is not recognized
 static int
@@ -28,25 +29,48 @@ get_log_type(const char *b, size_t length) {
     return type_id;
 }
 
+static bool
+bitmap_test (const TypeIdBitmap *bitmap, int type_id) {
+    if (type_id < 0 || type_id > 0xFFFF)
+        return false;
+    return (bitmap->bits[type_id >> 6] >> (type_id & 63)) & 1;
+}
+
+// Publish a new whitelist, and free the old one after all readers are done.
+static void
+publish_whitelist (struct ExportManagerState *pstate, const TypeIdBitmap *bitmap) {
+    const TypeIdBitmap *old = pstate->whitelist.exchange(bitmap);
+    // Readers that started after the exchange see the new bitmap.
+    while (pstate->whitelist_readers.load() != 0)
+        std::this_thread::yield();
+    delete old;
+}
+
 void
 manager_init_state (struct ExportManagerState *pstate) {
-    pstate->log_fp = NULL;
-    pstate->filename = "";
-    pstate->whitelist.clear();
+    writer_init_state(&pstate->writer);
+    pstate->whitelist_readers = 0;
+    pstate->whitelist = new TypeIdBitmap();
     return;
 }
 
+void
+manager_flush (struct ExportManagerState *pstate) {
+    writer_flush(&pstate->writer);
+}
+
 bool
-manager_export_binary (struct ExportManagerState *pstate, const char *b, size_t length) {
+manager_export_binary (struct ExportManagerState *pstate, const char *b, size_t length,
+                        const char *raw, size_t raw_length) {
 
     int type_id = get_log_type(b, length);
-    if (pstate->whitelist.count(type_id) > 0) { // filter
+    pstate->whitelist_readers++;
+    bool selected = bitmap_test(pstate->whitelist.load(), type_id);
+    pstate->whitelist_readers--;
+    if (selected) { // filter
 
-        if (pstate->log_fp != NULL) {
-            std::string frame = encode_hdlc_frame(b, (int) length);
-            size_t cnt = fwrite(frame.c_str(), sizeof(char), frame.size(), pstate->log_fp);
-            (void)cnt;
-        }
+        // The raw frame is still HDLC-encoded, so no need to re-encode it.
+        writer_append(&pstate->writer, raw, raw_length);
         return true;
     }
     else
@@ -55,16 +79,32 @@ manager_export_binary (struct ExportManagerState *pstate, const char *b, size_t
 
 void
 manager_change_config (struct ExportManagerState *pstate,
-                        const char *new_path, const IdVector &whitelist) {
-    if (pstate->log_fp != NULL && new_path != NULL && pstate->filename != new_path) {   // close old file
-        fclose(pstate->log_fp);
-        pstate->log_fp = NULL;
-        pstate->filename = "";
+                        const char *new_path, const IdVector &whitelist,
+                        const struct LogWriterOptions *options) {
+    if (pstate->writer.opened && new_path != NULL && pstate->writer.filename != new_path) {   // close old file
+        writer_close(&pstate->writer);
+    }
+    if (!pstate->writer.opened && new_path != NULL) {   // open new file if necessary
+        LogWriterOptions default_options;
+        writer_init_options(&default_options);
+        if (!writer_open(&pstate->writer, new_path,
+                         options != NULL ? options : &default_options))
+            printf("dm_collector_c: cannot open %s\n", new_path);
     }
-    if (pstate->log_fp == NULL && new_path != NULL) {   // open new file if necessary
-        pstate->log_fp = fopen(new_path, "wb");
-        pstate->filename = new_path;
+    TypeIdBitmap *bitmap = new TypeIdBitmap();
+    for (IdVector::const_iterator it = whitelist.begin(); it != whitelist.end(); it++) {
+        if (*it >= 0 && *it <= 0xFFFF)
+            bitmap->bits[*it >> 6] |= 1ULL << (*it & 63);
     }
-    pstate->whitelist.clear();
-    pstate->whitelist.insert(whitelist.begin(), whitelist.end());
+    publish_whitelist(pstate, bitmap);
+}
+
+void
+manager_close (struct ExportManagerState *pstate) {
+    writer_close(&pstate->writer);
+}
+
+void
+manager_get_stats (struct ExportManagerState *pstate, struct LogWriterStats *stats) {
+    writer_get_stats(&pstate->writer, stats);
 }
@@ -2,24 +2,46 @@
 #define __DM_COLLECTOR_C_EXPORT_MANAGER_H__
 
 #include "utils.h"
+#include "log_writer.h"
 
-#include <set>
+#include <atomic>
 #include <string>
 #include <cstdio>
 
+// A set of log type IDs, one bit per ID.
+struct TypeIdBitmap {
+    unsigned long long bits[65536 / 64];
+};
+
 // Manage the output of logs.
 struct ExportManagerState {
-    FILE *log_fp;   // Point to the current log.
-    std::string filename;
-    std::set<int> whitelist;
+    LogWriterState writer;  // Writes the current log in the background.
+    // The whitelist is never modified in place. A new bitmap is published by
+    // swapping the pointer, and the old one is freed once no reader holds it,
+    // so the decoding loop never takes a lock.
+    std::atomic<const TypeIdBitmap *> whitelist;
+    std::atomic<int> whitelist_readers;
 };
 
 // Must be called before usage
 void manager_init_state (struct ExportManagerState *pstate);
+// options: how the log is written, or NULL for a single uncompressed file.
 void manager_change_config (struct ExportManagerState *pstate,
-                            const char *new_path, const IdVector &whitelist);
+                            const char *new_path, const IdVector &whitelist,
+                            const struct LogWriterOptions *options = NULL);
+
+// Export raw msgs that are in the whitelist.
+// b is the decoded frame (used for filtering); raw is the original HDLC-encoded
+// frame, which is copied to the log as is.
+bool manager_export_binary (struct ExportManagerState *pstate, const char *b, size_t length,
+                            const char *raw, size_t raw_length);
+
+// Write all staged frames to the current log, and wait until they are written.
+void manager_flush (struct ExportManagerState *pstate);
+
+// Write all staged frames, then stop the writer and close the current log.
+void manager_close (struct ExportManagerState *pstate);
 
-// Export raw msgs that are in the whitelist
-bool manager_export_binary (struct ExportManagerState *pstate, const char *b, size_t length);
+void manager_get_stats (struct ExportManagerState *pstate, struct LogWriterStats *stats);
 
 #endif // __DM_COLLECTOR_C_EXPORT_MANAGER_H__
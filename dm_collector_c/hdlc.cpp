@@ -117,11 +117,14 @@ unescape (std::string& frame) {
 }
 
 // Return: if there is new frame or not
+// raw_frame keeps the original (escaped) bytes of the frame as they were fed,
+// including the trailing 0x7e, so that it can be exported without re-encoding.
 bool
-get_next_frame (std::string& output_frame, bool& crc_correct) {
+get_next_frame (std::string& output_frame, std::string& raw_frame, bool& crc_correct) {
     size_t delim = buffer.find('\x7e');
     if (delim == std::string::npos)
         return false;
+    raw_frame.assign(buffer, 0, delim + 1);
     output_frame = buffer.substr(0, delim);
     buffer.erase(0, delim + 1);
 
@@ -142,10 +145,14 @@ get_next_frame (std::string& output_frame, bool& crc_correct) {
     return true;
 }
 
-void
+// Remove the wrapper some modems put before each frame.
+// Return: if the wrapper was removed or not
+bool
 check_frame_format (std::string& output_frame) {
     size_t delim = output_frame.find("\x98\x01\x00\x00\x01\00\x00\x00");
     if (delim == 0) {
         output_frame.erase(0, 8);
+        return true;
     }
+    return false;
 }
@@ -6,7 +6,7 @@
 std::string encode_hdlc_frame (const char *payld, int length);
 void feed_binary (const char *b, int length);
 void reset_binary ();
-bool get_next_frame (std::string& output_frame, bool& crc_correct);
-void check_frame_format (std::string& output_frame);
+bool get_next_frame (std::string& output_frame, std::string& raw_frame, bool& crc_correct);
+bool check_frame_format (std::string& output_frame);
 
 #endif  // __DM_COLLECTOR_C_HDLC_H__
@@ -31,6 +31,10 @@
 #include "gsm_dsds_rr_signaling_message.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "msg_classifier.h"
+#include "analysis_engine.h"
+#include "lte_mac_tput.h"
+#include "lte_rlc_tracker.h"
 #include "lte_pdcp_dl_cipher_data_pdu.h"
 #include "lte_pdcp_ul_cipher_data_pdu.h"
 #include "lte_pdsch_stat_indication.h"
@@ -4185,6 +4189,14 @@ _decode_lte_mac_ul_transportblock_subpkt(const char *b, int offset, size_t lengt
                                         result_subpkt_sample,
                                         "SFN", iSFN);
                                 Py_DECREF(old_object);
+
+                                mac_tput_on_tb(MAC_TPUT_UL,
+                                               0,
+                                               iRNTIType,
+                                               _search_result_int(result_subpkt_sample, "HARQ ID"),
+                                               _search_result_int(result_subpkt_sample, "Grant (bytes)"),
+                                               _search_result_int(result_subpkt_sample, "Padding (bytes)"),
+                                               iSFN, iSubFN);
                                 
 
                                 //xyf
@@ -4518,6 +4530,14 @@ _decode_lte_mac_ul_transportblock_subpkt(const char *b, int offset, size_t lengt
                                         "SFN", iSFN);
                                 Py_DECREF(old_object);
 
+                                mac_tput_on_tb(MAC_TPUT_UL,
+                                               _search_result_int(result_subpkt_sample, "Cell Id"),
+                                               iRNTIType,
+                                               _search_result_int(result_subpkt_sample, "HARQ ID"),
+                                               _search_result_int(result_subpkt_sample, "Grant (bytes)"),
+                                               _search_result_int(result_subpkt_sample, "Padding (bytes)"),
+                                               iSFN, iSubFN);
+
 
 
 
@@ -4910,6 +4930,14 @@ _decode_lte_mac_dl_transportblock_subpkt(const char *b, int offset, size_t lengt
                                         "SFN", iSFN);
                                 Py_DECREF(old_object);
 
+                                mac_tput_on_tb(MAC_TPUT_DL,
+                                               0,
+                                               iRNTIType,
+                                               _search_result_int(result_subpkt_sample, "HARQ ID"),
+                                               _search_result_int(result_subpkt_sample, "DL TBS (bytes)"),
+                                               _search_result_int(result_subpkt_sample, "Padding (bytes)"),
+                                               iSFN, iSubFN);
+
                                 //xyf
                                 if (iRNTIType != 0)
                                     offset += _search_result_int(result_subpkt_sample, "HDR LEN");
@@ -5115,6 +5143,14 @@ _decode_lte_mac_dl_transportblock_subpkt(const char *b, int offset, size_t lengt
                                         result_subpkt_sample,
                                         "SFN", iSFN);
                                 Py_DECREF(old_object);
+
+                                mac_tput_on_tb(MAC_TPUT_DL,
+                                               _search_result_int(result_subpkt_sample, "Cell Id"),
+                                               iRNTIType,
+                                               _search_result_int(result_subpkt_sample, "HARQ ID"),
+                                               _search_result_int(result_subpkt_sample, "DL TBS (bytes)"),
+                                               _search_result_int(result_subpkt_sample, "Padding (bytes)"),
+                                               iSFN, iSubFN);
                                 
 
                                 //xyf
@@ -6306,6 +6342,10 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
 
                     int n_pdu = _search_result_int(result_subpkt,
                                                    "Number of PDUs");
+                    rlc_tracker_on_window(RLC_TRACKER_UL, rb_cfg_idx,
+                                          _search_result_int(result_subpkt, "VT(A)"),
+                                          _search_result_int(result_subpkt, "VT(S)"),
+                                          n_pdu);
                     PyObject *result_pdu = PyList_New(0);
                     for (int j = 0; j < n_pdu; j++) {
                         PyObject *result_pdu_item = PyList_New(0);
@@ -6323,6 +6363,8 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                                               "sys_fn");
                         int iLoggedBytes = _search_result_int(result_pdu_item,
                                                               "logged_bytes");
+                        int iPduBytes = _search_result_int(result_pdu_item,
+                                                           "pdu_bytes");
                         // D/C LookAhead and SN (or Ack_SN) has already been parsed.
                         iLoggedBytes -= 2;
 
@@ -6372,6 +6414,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                             Py_DECREF(old_object);
                             Py_DECREF(pystr);
 
+                            std::vector<int> nack_sns;
                             if (iLoggedBytes > 0) {
                                 // Decode NACK
                                 int numNack = iLoggedBytes / 1.5;
@@ -6397,6 +6440,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                         int iPart1 = (iNonDecodeNACK - iPart3 * 4096 - iPart4 * 256) / 16;
                                         int iPart2 = iNonDecodeNACK - iPart3 * 4096 - iPart4 * 256 - iPart1 * 16;
                                         int iNack = iPart1 * 32 + iPart2 * 2 + iPart3 / 8 + iHeadFromPadding;
+                                        nack_sns.push_back(iNack);
                                         iHeadFromAllign = iPart4 + (iPart3 & 1) * 16;
                                         int iE2 = iPart3 & 2;
                                         if (iE2 == 2) {
@@ -6417,6 +6461,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                         int iNonDecodeNACK = _search_result_int(
                                                 result_pdu_nack_item, "NACK_SN");
                                         int iNack = iHeadFromAllign * 32 + iNonDecodeNACK / 8;
+                                        nack_sns.push_back(iNack);
                                         int iE2 = iNonDecodeNACK & 2;
                                         if (iE2 == 2) {
                                             indexNack = numNack - 1;
@@ -6438,6 +6483,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                 Py_DECREF(t2);
                                 Py_DECREF(result_pdu_nack);
                             }
+                            rlc_tracker_on_status(RLC_TRACKER_UL, rb_cfg_idx, nack_sns, sys_fn, sub_fn);
                         } else {
                             // Type = DATA
                             pystr = Py_BuildValue("s", "RLCUL DATA");
@@ -6511,6 +6557,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                             Py_DECREF(old_object);
                             Py_DECREF(pystr);
 
+                            bool bLSF = true;
                             if (strRF == "1") {
                                 // decode LSF and SO
                                 iLoggedBytes -= 2;
@@ -6524,6 +6571,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                 int temp = _search_result_int(result_pdu_item,
                                                               "LSF");
                                 int iLSF = temp >> 7;
+                                bLSF = (iLSF != 0);
                                 int iSO = _search_result_int(result_pdu_item,
                                                              "SO");
                                 iSO += (temp & 127) * 256;
@@ -6535,6 +6583,9 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                 Py_DECREF(old_object);
                             }
 
+                            rlc_tracker_on_data(RLC_TRACKER_UL, rb_cfg_idx, iNonDecodeSN,
+                                                strRF == "1", bLSF, iPduBytes, sys_fn, sub_fn);
+
                             if (strE == "1") {
                                 // Decode LI
                                 int numLI = iLoggedBytes / 1.5;
@@ -6652,6 +6703,10 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
 
                     int n_pdu = _search_result_int(result_subpkt,
                                                    "Number of PDUs");
+                    rlc_tracker_on_window(RLC_TRACKER_UL, rb_cfg_idx,
+                                          _search_result_int(result_subpkt, "VT(A)"),
+                                          _search_result_int(result_subpkt, "VT(S)"),
+                                          n_pdu);
                     PyObject *result_pdu = PyList_New(0);
                     for (int j = 0; j < n_pdu; j++) {
                         PyObject *result_pdu_item = PyList_New(0);
@@ -6669,6 +6724,8 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                                               "sys_fn");
                         int iLoggedBytes = _search_result_int(result_pdu_item,
                                                               "logged_bytes");
+                        int iPduBytes = _search_result_int(result_pdu_item,
+                                                           "pdu_bytes");
                         // D/C LookAhead and SN (or Ack_SN) has already been parsed.
                         iLoggedBytes -= 2;
 
@@ -6723,6 +6780,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                             Py_DECREF(old_object);
                             Py_DECREF(pystr);
 
+                            std::vector<int> nack_sns;
                             if (iLoggedBytes > 0) {
                                 // Decode NACK
                                 int numNack = iLoggedBytes / 1.5;
@@ -6748,6 +6806,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                         int iPart1 = (iNonDecodeNACK - iPart3 * 4096 - iPart4 * 256) / 16;
                                         int iPart2 = iNonDecodeNACK - iPart3 * 4096 - iPart4 * 256 - iPart1 * 16;
                                         int iNack = iPart1 * 32 + iPart2 * 2 + iPart3 / 8 + iHeadFromPadding;
+                                        nack_sns.push_back(iNack);
                                         iHeadFromAllign = iPart4 + (iPart3 & 1) * 16;
                                         int iE2 = iPart3 & 2;
                                         if (iE2 == 2) {
@@ -6768,6 +6827,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                         int iNonDecodeNACK = _search_result_int(
                                                 result_pdu_nack_item, "NACK_SN");
                                         int iNack = iHeadFromAllign * 32 + iNonDecodeNACK / 8;
+                                        nack_sns.push_back(iNack);
                                         int iE2 = iNonDecodeNACK & 2;
                                         if (iE2 == 2) {
                                             indexNack = numNack - 1;
@@ -6789,6 +6849,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                 Py_DECREF(t2);
                                 Py_DECREF(result_pdu_nack);
                             }
+                            rlc_tracker_on_status(RLC_TRACKER_UL, rb_cfg_idx, nack_sns, sys_fn, sub_fn);
                         } else {
                             // Type = DATA
                             pystr = Py_BuildValue("s", "RLCUL DATA");
@@ -6862,6 +6923,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                             Py_DECREF(old_object);
                             Py_DECREF(pystr);
 
+                            bool bLSF = true;
                             if (strRF == "1") {
                                 // decode LSF and SO
                                 iLoggedBytes -= 2;
@@ -6875,6 +6937,7 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                 int temp = _search_result_int(result_pdu_item,
                                                               "LSF");
                                 int iLSF = temp >> 7;
+                                bLSF = (iLSF != 0);
                                 int iSO = _search_result_int(result_pdu_item,
                                                              "SO");
                                 iSO += (temp & 127) * 256;
@@ -6886,6 +6949,9 @@ static int _decode_lte_rlc_ul_am_all_pdu_subpkt(const char *b, int offset,
                                 Py_DECREF(old_object);
                             }
 
+                            rlc_tracker_on_data(RLC_TRACKER_UL, rb_cfg_idx, iNonDecodeSN,
+                                                strRF == "1", bLSF, iPduBytes, sys_fn, sub_fn);
+
                             if (strE == "1") {
                                 // Decode LI
                                 int numLI = iLoggedBytes / 1.5;
@@ -7049,6 +7115,10 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
 
                     int n_pdu = _search_result_int(result_subpkt,
                                                    "Number of PDUs");
+                    rlc_tracker_on_window(RLC_TRACKER_DL, rb_cfg_idx,
+                                          _search_result_int(result_subpkt, "VR(R)"),
+                                          _search_result_int(result_subpkt, "VR(H)"),
+                                          n_pdu);
                     PyObject *result_pdu = PyList_New(0);
                     for (int j = 0; j < n_pdu; j++) {
                         PyObject *result_pdu_item = PyList_New(0);
@@ -7066,6 +7136,8 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                                                               "sys_fn");
                         int iLoggedBytes = _search_result_int(result_pdu_item,
                                                               "logged_bytes");
+                        int iPduBytes = _search_result_int(result_pdu_item,
+                                                           "pdu_bytes");
                         // D/C LookAhead and SN (or Ack_SN) has already been parsed.
                         iLoggedBytes -= 2;
 
@@ -7120,6 +7192,7 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                             Py_DECREF(old_object);
                             Py_DECREF(pystr);
 
+                            std::vector<int> nack_sns;
                             if (iLoggedBytes > 0) {
                                 // Decode NACK
                                 int numNack = iLoggedBytes / 1.5;
@@ -7145,6 +7218,7 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                                         int iPart1 = (iNonDecodeNACK - iPart3 * 4096 - iPart4 * 256) / 16;
                                         int iPart2 = iNonDecodeNACK - iPart3 * 4096 - iPart4 * 256 - iPart1 * 16;
                                         int iNack = iPart1 * 32 + iPart2 * 2 + iPart3 / 8 + iHeadFromPadding;
+                                        nack_sns.push_back(iNack);
                                         iHeadFromAllign = iPart4 + (iPart3 & 1) * 16;
                                         int iE2 = iPart3 & 2;
                                         if (iE2 == 2) {
@@ -7165,6 +7239,7 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                                         int iNonDecodeNACK = _search_result_int(
                                                 result_pdu_nack_item, "NACK_SN");
                                         int iNack = iHeadFromAllign * 32 + iNonDecodeNACK / 8;
+                                        nack_sns.push_back(iNack);
                                         int iE2 = iNonDecodeNACK & 2;
                                         if (iE2 == 2) {
                                             indexNack = numNack - 1;
@@ -7186,6 +7261,7 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                                 Py_DECREF(t2);
                                 Py_DECREF(result_pdu_nack);
                             }
+                            rlc_tracker_on_status(RLC_TRACKER_DL, rb_cfg_idx, nack_sns, sys_fn, sub_fn);
                         } else {
                             // Type = DATA
                             pystr = Py_BuildValue("s", "RLCDL DATA");
@@ -7263,6 +7339,7 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                             Py_DECREF(old_object);
                             Py_DECREF(pystr);
 
+                            bool bLSF = true;
                             if (strRF == "1") {
                                 // decode LSF and SO
                                 iLoggedBytes -= 2;
@@ -7276,6 +7353,7 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                                 int temp = _search_result_int(result_pdu_item,
                                                               "LSF");
                                 int iLSF = temp >> 7;
+                                bLSF = (iLSF != 0);
                                 int iSO = _search_result_int(result_pdu_item,
                                                              "SO");
                                 iSO += (temp & 127) * 256;
@@ -7287,6 +7365,9 @@ static int _decode_lte_rlc_dl_am_all_pdu_subpkt(const char *b, int offset,
                                 Py_DECREF(old_object);
                             }
 
+                            rlc_tracker_on_data(RLC_TRACKER_DL, rb_cfg_idx, iNonDecodeSN,
+                                                strRF == "1", bLSF, iPduBytes, sys_fn, sub_fn);
+
                             if (strE == "1") {
                                 // Decode LI
                                 int numLI = iLoggedBytes / 1.5;
@@ -12357,7 +12438,15 @@ decode_log_packet(const char *b, size_t length, bool skip_decoding) {
     }
     */
 
+    // Analysis engines fed by the decoders timestamp their results with it
+    if (length >= 14) {
+        unsigned long long ts = 0;
+        memcpy(&ts, b + 6, sizeof(ts));
+        analysis_set_packet_timestamp(ts);
+    }
     on_demand_decode(b + offset, length - offset, type_id, result);
+    if (msg_types_enabled())
+        add_msg_types(result);
 
     return result;
 }
@@ -558,6 +558,43 @@ _decode_by_fmt(const Fmt fmt[], int n_fmt,
     return n_consumed;
 }
 
+// Number of bytes _decode_by_fmt() consumes for fmt[], or with a target, for
+// the fields before it.
+// Return: bytes, or -1 if target is not found
+static int _fmt_offset(
+        const Fmt fmt[],
+        int n_fmt,
+        const char *target)
+__attribute__ ((unused));
+
+static int
+_fmt_offset(const Fmt fmt[], int n_fmt, const char *target) {
+    int n = 0;
+    for (int i = 0; i < n_fmt; i++) {
+        if (target != NULL && fmt[i].field_name != NULL
+                && strcmp(fmt[i].field_name, target) == 0)
+            return n;
+        if (fmt[i].type != PLACEHOLDER)
+            n += fmt[i].len;
+    }
+    return (target == NULL) ? n : -1;
+}
+
+// Read a little endian integer of 1, 2, 4 or 8 bytes, as a UINT field,
+// without creating a Python object.
+static unsigned long long _read_uint_le(
+        const char *p,
+        int len)
+__attribute__ ((unused));
+
+static unsigned long long
+_read_uint_le(const char *p, int len) {
+    unsigned long long ii = 0;
+    for (int i = len - 1; i >= 0; i--)
+        ii = (ii << 8) | (unsigned char) p[i];
+    return ii;
+}
+
 //printf PyObject
 static void reprint(PyObject *obj) {
     PyObject* repr = PyObject_Repr(obj);
@@ -570,10 +607,21 @@ static void reprint(PyObject *obj) {
     Py_XDECREF(str);
 }
 
+// NR RSRP or RSRQ of a raw field, as converted by _convert_nr_rsrp() and
+// _convert_nr_rsrq()
+static float _nr_rsrp_rsrq_value(
+        unsigned int raw)
+__attribute__ ((unused));
+
+static float
+_nr_rsrp_rsrq_value(unsigned int raw) {
+    int utemp = raw;
+    return utemp * 0.0078 - 0.0003;           // TODO: Based on polyfit. To be more accurate
+}
+
 static void
 _convert_nr_rsrp(PyObject *obj, const char *rsrp_field){
-    int utemp = _search_result_uint(obj, rsrp_field);
-    float rsrp = utemp * 0.0078 - 0.0003;           // TODO: Based on polyfit. To be more accurate
+    float rsrp = _nr_rsrp_rsrq_value(_search_result_uint(obj, rsrp_field));
     PyObject *pyfloat = Py_BuildValue("f", rsrp);
     PyObject *old_object = _replace_result(obj, rsrp_field, pyfloat);
     Py_DECREF(old_object);
@@ -582,8 +630,7 @@ _convert_nr_rsrp(PyObject *obj, const char *rsrp_field){
 
 static void
 _convert_nr_rsrq(PyObject *obj, const char *rsrq_field){
-    int utemp = _search_result_uint(obj, rsrq_field);
-    float rsrq = utemp * 0.0078 - 0.0003;           // TODO: Based on polyfit. To be more accurate
+    float rsrq = _nr_rsrp_rsrq_value(_search_result_uint(obj, rsrq_field));
     PyObject *pyfloat = Py_BuildValue("f", rsrq);
     PyObject *old_object = _replace_result(obj, rsrq_field, pyfloat);
     Py_DECREF(old_object);
@@ -0,0 +1,667 @@
+/* log_writer.cpp
+ * Implements the background writer of exported logs.
+ */
+
+#include "log_writer.h"
+#include "utils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#define printf(fmt,args...) __android_log_print(ANDROID_LOG_INFO, "python [dm_collector_c]", fmt, ##args);
+#endif
+
+static void
+reset_counters (struct LogWriterState *pstate) {
+    pstate->frames_queued = 0;
+    pstate->bytes_queued = 0;
+    pstate->frames_dropped = 0;
+    pstate->bytes_dropped = 0;
+    pstate->bytes_written = 0;
+    pstate->segments = 0;
+    pstate->syncs = 0;
+    pstate->write_errors = 0;
+}
+
+void
+writer_init_options (struct LogWriterOptions *options) {
+    options->sync_interval = 0;
+    options->max_segment_bytes = 0;
+    options->max_segment_seconds = 0;
+    options->compression = WRITER_COMPRESSION_NONE;
+    options->compression_level = -1;
+    options->segment_header.clear();
+}
+
+#ifdef _WIN32
+
+// No writer thread on Windows: batches are written synchronously.
+
+void
+writer_init_state (struct LogWriterState *pstate) {
+    pstate->opened = false;
+    pstate->filename = "";
+    writer_init_options(&pstate->options);
+    pstate->fp = NULL;
+    reset_counters(pstate);
+}
+
+bool
+writer_open (struct LogWriterState *pstate, const char *path,
+                const struct LogWriterOptions *options) {
+    pstate->fp = fopen(path, "wb");
+    if (pstate->fp == NULL)
+        return false;
+    pstate->opened = true;
+    pstate->filename = path;
+    pstate->options = *options;
+    pstate->segments++;
+    const std::string &header = options->segment_header;
+    size_t cnt = fwrite(header.data(), sizeof(char), header.size(), pstate->fp);
+    if (cnt != header.size())
+        pstate->write_errors++;
+    pstate->bytes_written += cnt;
+    return true;
+}
+
+void
+writer_append (struct LogWriterState *pstate, const char *b, size_t length) {
+    if (!pstate->opened)
+        return;
+    size_t cnt = fwrite(b, sizeof(char), length, pstate->fp);
+    if (cnt != length)
+        pstate->write_errors++;
+    pstate->frames_queued++;
+    pstate->bytes_queued += length;
+    pstate->bytes_written += cnt;
+}
+
+void
+writer_flush (struct LogWriterState *pstate) {
+    if (pstate->opened)
+        fflush(pstate->fp);
+}
+
+void
+writer_close (struct LogWriterState *pstate) {
+    if (!pstate->opened)
+        return;
+    fclose(pstate->fp);
+    pstate->fp = NULL;
+    pstate->opened = false;
+    pstate->filename = "";
+}
+
+void
+writer_get_stats (struct LogWriterState *pstate, struct LogWriterStats *stats) {
+    stats->queue_depth = 0;
+    stats->queue_capacity = 0;
+    stats->frames_queued = pstate->frames_queued;
+    stats->bytes_queued = pstate->bytes_queued;
+    stats->frames_dropped = pstate->frames_dropped;
+    stats->bytes_dropped = pstate->bytes_dropped;
+    stats->bytes_written = pstate->bytes_written;
+    stats->segments = pstate->segments;
+    stats->syncs = pstate->syncs;
+    stats->write_errors = pstate->write_errors;
+}
+
+#else
+
+static bool
+rotation_enabled (const struct LogWriterOptions *options) {
+    return options->max_segment_bytes > 0 || options->max_segment_seconds > 0;
+}
+
+static bool
+ends_with (const std::string &s, const char *suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Expand the naming pattern into the path of a segment.
+static std::string
+get_segment_path (const std::string &pattern, const struct LogWriterOptions *options,
+                    unsigned int index) {
+    std::string path = pattern;
+    if (rotation_enabled(options) && path.find("{seq}") == std::string::npos) {
+        size_t slash = path.find_last_of("/\\");
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            dot = path.size();
+        path.insert(dot, "_{seq}");
+    }
+
+    char seq[16];
+    snprintf(seq, sizeof(seq), "%04u", index);
+    size_t pos;
+    while ((pos = path.find("{seq}")) != std::string::npos)
+        path.replace(pos, 5, seq);
+
+    if (path.find('%') != std::string::npos) {
+        time_t now = time(NULL);
+        struct tm tm_now;
+        localtime_r(&now, &tm_now);
+        char buf[4096];
+        size_t n = strftime(buf, sizeof(buf), path.c_str(), &tm_now);
+        if (n > 0)
+            path.assign(buf, n);
+    }
+
+    if (options->compression == WRITER_COMPRESSION_GZIP && !ends_with(path, ".gz"))
+        path += ".gz";
+    if (options->compression == WRITER_COMPRESSION_BLOCK && !ends_with(path, ".mi2blk")) {
+        if (ends_with(path, ".mi2log"))
+            path.erase(path.size() - 7);
+        path += ".mi2blk";
+    }
+    return path;
+}
+
+static void
+sync_file (struct LogWriterState *pstate) {
+#ifdef __APPLE__
+    int ret = fsync(pstate->fd);
+#else
+    int ret = fdatasync(pstate->fd);
+#endif
+    if (ret == 0)
+        pstate->syncs++;
+    pstate->last_sync = get_monotonic_time();
+}
+
+// Write the first len bytes of the staging buffer at its file offset.
+static void
+write_chunk (struct LogWriterState *pstate, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pwrite(pstate->fd, pstate->chunk + done, len - done,
+                           (off_t) (pstate->file_offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            pstate->write_errors++;
+            printf("dm_collector_c: failed to write %s (errno %d)\n",
+                    pstate->segment_path.c_str(), errno);
+            break;
+        }
+        done += n;
+    }
+}
+
+// Write out the staging buffer once it is full. Chunks always start at a
+// block-aligned file offset.
+static void
+write_full_chunk (struct LogWriterState *pstate) {
+    if (pstate->chunk_len < WRITER_CHUNK_SIZE)
+        return;
+    write_chunk(pstate, WRITER_CHUNK_SIZE);
+    pstate->file_offset += WRITER_CHUNK_SIZE;
+    pstate->chunk_len = 0;
+    pstate->bytes_written = pstate->closed_bytes + pstate->file_offset;
+}
+
+// Copy data into the staging buffer.
+static void
+append_data (struct LogWriterState *pstate, const char *b, size_t length) {
+    while (length > 0) {
+        size_t n = WRITER_CHUNK_SIZE - pstate->chunk_len;
+        if (n > length)
+            n = length;
+        memcpy(pstate->chunk + pstate->chunk_len, b, n);
+        pstate->chunk_len += n;
+        b += n;
+        length -= n;
+        write_full_chunk(pstate);
+    }
+}
+
+// Compress data straight into the staging buffer.
+// flush is Z_NO_FLUSH, Z_SYNC_FLUSH or Z_FINISH.
+static void
+compress_data (struct LogWriterState *pstate, const char *b, size_t length, int flush) {
+    z_stream *zs = &pstate->zs;
+    zs->next_in = (Bytef *) b;
+    zs->avail_in = (uInt) length;
+    while (true) {
+        zs->next_out = (Bytef *) (pstate->chunk + pstate->chunk_len);
+        zs->avail_out = (uInt) (WRITER_CHUNK_SIZE - pstate->chunk_len);
+        int ret = deflate(zs, flush);
+        bool out_full = (zs->avail_out == 0);
+        pstate->chunk_len = WRITER_CHUNK_SIZE - zs->avail_out;
+        write_full_chunk(pstate);
+        if (ret == Z_STREAM_END)
+            break;
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            pstate->write_errors++;
+            printf("dm_collector_c: failed to compress %s (zlib error %d)\n",
+                    pstate->segment_path.c_str(), ret);
+            break;
+        }
+        if (!out_full && zs->avail_in == 0 && flush != Z_FINISH)
+            break;
+    }
+}
+
+// Stage the bytes produced by the block encoder.
+static void
+append_blocks (struct LogWriterState *pstate) {
+    append_data(pstate, pstate->blk_out.data(), pstate->blk_out.size());
+    pstate->blk_out.clear();
+}
+
+static void
+write_data (struct LogWriterState *pstate, const char *b, size_t length) {
+    if (pstate->options.compression == WRITER_COMPRESSION_GZIP) {
+        compress_data(pstate, b, length, Z_NO_FLUSH);
+    } else if (pstate->options.compression == WRITER_COMPRESSION_BLOCK) {
+        block_log_add_frames(&pstate->blk, b, length, pstate->blk_out);
+        append_blocks(pstate);
+    } else {
+        append_data(pstate, b, length);
+    }
+    pstate->segment_raw_bytes += length;
+    pstate->unflushed = true;
+}
+
+// Write out the partial chunk. Its file offset is kept, so that it is written
+// again as a whole once it is filled up.
+static void
+write_tail (struct LogWriterState *pstate) {
+    if (pstate->chunk_len == 0)
+        return;
+    write_chunk(pstate, pstate->chunk_len);
+    pstate->bytes_written = pstate->closed_bytes + pstate->file_offset + pstate->chunk_len;
+    // Full blocks do not need to be written again.
+    size_t aligned = pstate->chunk_len - pstate->chunk_len % WRITER_BLOCK_SIZE;
+    if (aligned > 0) {
+        memmove(pstate->chunk, pstate->chunk + aligned, pstate->chunk_len - aligned);
+        pstate->file_offset += aligned;
+        pstate->chunk_len -= aligned;
+    }
+}
+
+// Make everything received so far readable from the current segment.
+// In block mode, this closes the current block early.
+static void
+flush_segment (struct LogWriterState *pstate) {
+    if (!pstate->segment_opened)
+        return;
+    if (pstate->options.compression == WRITER_COMPRESSION_GZIP) {
+        compress_data(pstate, NULL, 0, Z_SYNC_FLUSH);
+    } else if (pstate->options.compression == WRITER_COMPRESSION_BLOCK) {
+        block_log_flush_block(&pstate->blk, pstate->blk_out);
+        append_blocks(pstate);
+    }
+    write_tail(pstate);
+    pstate->last_flush = get_monotonic_time();
+    pstate->unflushed = false;
+}
+
+// Return: successful or not
+static bool
+open_segment (struct LogWriterState *pstate) {
+    std::string path = get_segment_path(pstate->filename, &pstate->options,
+                                        pstate->segment_index);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        pstate->write_errors++;
+        printf("dm_collector_c: cannot open %s (errno %d)\n", path.c_str(), errno);
+        return false;
+    }
+    if (pstate->options.compression == WRITER_COMPRESSION_GZIP) {
+        memset(&pstate->zs, 0, sizeof(pstate->zs));
+        // 15 + 16: largest window, gzip container
+        if (deflateInit2(&pstate->zs, pstate->options.compression_level, Z_DEFLATED,
+                         15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            pstate->write_errors++;
+            close(fd);
+            return false;
+        }
+    }
+    pstate->fd = fd;
+    pstate->segment_path = path;
+    pstate->segment_index++;
+    pstate->segment_start = get_monotonic_time();
+    pstate->segment_raw_bytes = 0;
+    pstate->chunk_len = 0;
+    pstate->file_offset = 0;
+    pstate->segment_opened = true;
+    pstate->last_flush = pstate->segment_start;
+    pstate->unflushed = false;
+    pstate->segments++;
+    if (pstate->options.compression == WRITER_COMPRESSION_BLOCK) {
+        int level = pstate->options.compression_level;
+        block_log_init(&pstate->blk, level < 0 ? Z_DEFAULT_COMPRESSION : level,
+                       pstate->blk_out);
+        append_blocks(pstate);
+    } else if (!pstate->options.segment_header.empty()) {
+        const std::string &header = pstate->options.segment_header;
+        write_data(pstate, header.data(), header.size());
+        pstate->segment_raw_bytes = 0;
+    }
+    return true;
+}
+
+static void
+close_segment (struct LogWriterState *pstate) {
+    if (!pstate->segment_opened)
+        return;
+    if (pstate->options.compression == WRITER_COMPRESSION_GZIP) {
+        compress_data(pstate, NULL, 0, Z_FINISH);
+        deflateEnd(&pstate->zs);
+    } else if (pstate->options.compression == WRITER_COMPRESSION_BLOCK) {
+        block_log_finish(&pstate->blk, pstate->blk_out);
+        append_blocks(pstate);
+    }
+    write_tail(pstate);
+    if (pstate->options.sync_interval > 0)
+        sync_file(pstate);
+    close(pstate->fd);
+    pstate->closed_bytes = pstate->bytes_written;
+    pstate->fd = -1;
+    pstate->chunk_len = 0;
+    pstate->file_offset = 0;
+    pstate->segment_opened = false;
+    pstate->unflushed = false;
+}
+
+static bool
+segment_expired (struct LogWriterState *pstate) {
+    const LogWriterOptions &options = pstate->options;
+    if (!pstate->segment_opened || pstate->segment_raw_bytes == 0)
+        return false;
+    if (options.max_segment_bytes > 0
+            && pstate->segment_raw_bytes >= options.max_segment_bytes)
+        return true;
+    if (options.max_segment_seconds > 0
+            && get_monotonic_time() - pstate->segment_start >= options.max_segment_seconds)
+        return true;
+    return false;
+}
+
+// Move all queued batches into the current segment, switching segments when
+// needed.
+// Return: whether any batch was consumed
+static bool
+drain_queue (struct LogWriterState *pstate) {
+    bool consumed = false;
+    size_t head = pstate->head.load(std::memory_order_relaxed);
+    while (head != pstate->tail.load(std::memory_order_acquire)) {
+        std::string &batch = pstate->slots[head];
+        if (segment_expired(pstate))
+            close_segment(pstate);
+        if (!pstate->segment_opened)
+            (void) open_segment(pstate);
+        if (pstate->segment_opened) {
+            write_data(pstate, batch.data(), batch.size());
+        } else {
+            pstate->frames_dropped += pstate->slot_frames[head];
+            pstate->bytes_dropped += batch.size();
+        }
+        batch.clear();
+        head = (head + 1) % WRITER_QUEUE_SLOTS;
+        pstate->head.store(head, std::memory_order_release);
+        consumed = true;
+    }
+    return consumed;
+}
+
+static bool
+queue_is_empty (struct LogWriterState *pstate) {
+    return pstate->head.load(std::memory_order_acquire)
+            == pstate->tail.load(std::memory_order_acquire);
+}
+
+// Hand over a batch of n_frames frames. The content of batch is taken over and
+// batch is left empty. If the queue is full, the batch is dropped, unless
+// wait_if_full is set, in which case the caller waits for a free slot.
+// The caller holds the staging mutex.
+// Return: queued or not
+static bool
+enqueue_batch (struct LogWriterState *pstate, std::string &batch, size_t n_frames,
+               bool wait_if_full) {
+    size_t tail = pstate->tail.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % WRITER_QUEUE_SLOTS;
+    if (next == pstate->head.load(std::memory_order_acquire)) {
+        if (!wait_if_full) {
+            pstate->frames_dropped += n_frames;
+            pstate->bytes_dropped += batch.size();
+            batch.clear();
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(pstate->mutex);
+        pstate->flushed.wait(lock, [pstate, next] {
+            return next != pstate->head.load(std::memory_order_acquire);
+        });
+    }
+
+    pstate->frames_queued += n_frames;
+    pstate->bytes_queued += batch.size();
+    pstate->slots[tail].swap(batch);
+    pstate->slot_frames[tail] = n_frames;
+    batch.clear();
+    pstate->tail.store(next, std::memory_order_release);
+    pstate->wakeup.notify_one();
+    return true;
+}
+
+// Hand over the staged frames. The caller holds the staging mutex.
+static void
+submit_staged (struct LogWriterState *pstate, bool wait_if_full) {
+    if (pstate->staged.empty())
+        return;
+    (void) enqueue_batch(pstate, pstate->staged, pstate->staged_frames, wait_if_full);
+    pstate->staged_frames = 0;
+}
+
+// Hand over the staged frames from the writer thread once they are old, so
+// that they are written even if no more frames arrive.
+static void
+submit_old_staged (struct LogWriterState *pstate) {
+    // The decoding thread may hold the lock while it waits for this thread to
+    // free a slot, so never wait for it.
+    std::unique_lock<std::mutex> lock(pstate->staging_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || pstate->staged.empty()
+            || get_monotonic_time() - pstate->staged_since < WRITER_BATCH_INTERVAL)
+        return;
+    size_t next = (pstate->tail.load(std::memory_order_relaxed) + 1) % WRITER_QUEUE_SLOTS;
+    if (next == pstate->head.load(std::memory_order_acquire))
+        return;     // Full: try again once the queue is drained
+    submit_staged(pstate, false);
+}
+
+static void
+writer_main (struct LogWriterState *pstate) {
+    while (true) {
+        submit_old_staged(pstate);
+        bool consumed = drain_queue(pstate);
+        if (consumed) {
+            // Let a producer waiting for a free slot proceed.
+            std::lock_guard<std::mutex> lock(pstate->mutex);
+            pstate->flushed.notify_all();
+        }
+
+        unsigned long long req = pstate->flush_requested.load();
+        bool stopping = pstate->stopping.load();
+        if (stopping) {
+            close_segment(pstate);
+        } else if (req != pstate->flush_done.load()) {
+            flush_segment(pstate);
+            if (pstate->options.sync_interval > 0 && pstate->segment_opened)
+                sync_file(pstate);
+        }
+        if (req != pstate->flush_done.load() || stopping) {
+            std::lock_guard<std::mutex> lock(pstate->mutex);
+            pstate->flush_done = req;
+            pstate->flushed.notify_all();
+            if (stopping && queue_is_empty(pstate))
+                break;
+        }
+
+        // Do not leave an idle segment open beyond its duration. The next one
+        // is opened when more data arrives.
+        if (segment_expired(pstate))
+            close_segment(pstate);
+
+        if (pstate->options.sync_interval > 0 && pstate->segment_opened
+                && get_monotonic_time() - pstate->last_sync >= pstate->options.sync_interval) {
+            flush_segment(pstate);
+            sync_file(pstate);
+        }
+
+        // Do not keep data in memory for long when no more arrives.
+        if (pstate->unflushed
+                && get_monotonic_time() - pstate->last_flush >= WRITER_BATCH_INTERVAL)
+            flush_segment(pstate);
+
+        std::unique_lock<std::mutex> lock(pstate->mutex);
+        // Producers do not take the lock when submitting, so a wake-up may be
+        // missed. The timeout bounds the delay in that case.
+        pstate->wakeup.wait_for(lock, std::chrono::milliseconds(50), [pstate] {
+            return !queue_is_empty(pstate)
+                    || pstate->flush_requested.load() != pstate->flush_done.load()
+                    || pstate->stopping.load();
+        });
+    }
+}
+
+void
+writer_init_state (struct LogWriterState *pstate) {
+    pstate->opened = false;
+    pstate->filename = "";
+    writer_init_options(&pstate->options);
+    pstate->segment_opened = false;
+    pstate->segment_path = "";
+    pstate->segment_index = 0;
+    pstate->segment_start = 0;
+    pstate->segment_raw_bytes = 0;
+    pstate->fd = -1;
+    pstate->staged.clear();
+    pstate->staged_frames = 0;
+    pstate->staged_since = 0;
+    pstate->chunk = NULL;
+    pstate->chunk_len = 0;
+    pstate->file_offset = 0;
+    pstate->closed_bytes = 0;
+    pstate->last_sync = 0;
+    pstate->last_flush = 0;
+    pstate->unflushed = false;
+    pstate->head = 0;
+    pstate->tail = 0;
+    pstate->flush_requested = 0;
+    pstate->flush_done = 0;
+    pstate->stopping = false;
+    reset_counters(pstate);
+}
+
+bool
+writer_open (struct LogWriterState *pstate, const char *path,
+                const struct LogWriterOptions *options) {
+    void *chunk = NULL;
+    if (posix_memalign(&chunk, WRITER_BLOCK_SIZE, WRITER_CHUNK_SIZE) != 0)
+        return false;
+
+    pstate->filename = path;
+    pstate->options = *options;
+    pstate->chunk = (char *) chunk;
+    pstate->segment_index = 0;
+    pstate->closed_bytes = pstate->bytes_written;
+    // Open the first segment here, so that a bad path is reported right away.
+    if (!open_segment(pstate)) {
+        free(pstate->chunk);
+        pstate->chunk = NULL;
+        pstate->filename = "";
+        return false;
+    }
+
+    pstate->last_sync = get_monotonic_time();
+    pstate->staged.clear();
+    pstate->staged.reserve(WRITER_BATCH_SIZE);
+    pstate->staged_frames = 0;
+    pstate->head = 0;
+    pstate->tail = 0;
+    pstate->flush_requested = 0;
+    pstate->flush_done = 0;
+    pstate->stopping = false;
+    pstate->worker = std::thread(writer_main, pstate);
+    pstate->opened = true;
+    return true;
+}
+
+void
+writer_append (struct LogWriterState *pstate, const char *b, size_t length) {
+    if (!pstate->opened)
+        return;
+    std::lock_guard<std::mutex> lock(pstate->staging_mutex);
+    if (pstate->staged.empty())
+        pstate->staged_since = get_monotonic_time();
+    pstate->staged.append(b, length);
+    pstate->staged_frames++;
+    if (pstate->staged.size() >= WRITER_BATCH_SIZE)
+        submit_staged(pstate, false);
+}
+
+void
+writer_flush (struct LogWriterState *pstate) {
+    if (!pstate->opened)
+        return;
+    {
+        std::lock_guard<std::mutex> staging_lock(pstate->staging_mutex);
+        submit_staged(pstate, true);
+    }
+    std::unique_lock<std::mutex> lock(pstate->mutex);
+    unsigned long long req = pstate->flush_requested.load() + 1;
+    pstate->flush_requested = req;
+    pstate->wakeup.notify_one();
+    pstate->flushed.wait(lock, [pstate, req] {
+        return pstate->flush_done.load() >= req;
+    });
+}
+
+void
+writer_close (struct LogWriterState *pstate) {
+    if (!pstate->opened)
+        return;
+    {
+        std::lock_guard<std::mutex> staging_lock(pstate->staging_mutex);
+        submit_staged(pstate, true);
+    }
+    {
+        std::lock_guard<std::mutex> lock(pstate->mutex);
+        pstate->stopping = true;
+        pstate->wakeup.notify_one();
+    }
+    pstate->worker.join();
+    free(pstate->chunk);
+    pstate->chunk = NULL;
+    pstate->opened = false;
+    pstate->filename = "";
+}
+
+void
+writer_get_stats (struct LogWriterState *pstate, struct LogWriterStats *stats) {
+    size_t head = pstate->head.load(std::memory_order_acquire);
+    size_t tail = pstate->tail.load(std::memory_order_acquire);
+    stats->queue_depth = (tail + WRITER_QUEUE_SLOTS - head) % WRITER_QUEUE_SLOTS;
+    stats->queue_capacity = WRITER_QUEUE_SLOTS - 1;
+    stats->frames_queued = pstate->frames_queued;
+    stats->bytes_queued = pstate->bytes_queued;
+    stats->frames_dropped = pstate->frames_dropped;
+    stats->bytes_dropped = pstate->bytes_dropped;
+    stats->bytes_written = pstate->bytes_written;
+    stats->segments = pstate->segments;
+    stats->syncs = pstate->syncs;
+    stats->write_errors = pstate->write_errors;
+}
+
+#endif
@@ -0,0 +1,158 @@
+/* log_writer.h
+ * Defines a background writer that moves exported logs to disk.
+ * The decoding thread stages raw frames into a batch, which is handed over
+ * through a bounded single-producer/single-consumer queue once it is full, or
+ * by the writer thread once it is WRITER_BATCH_INTERVAL old. The writer thread
+ * also flushes the current segment at that interval, so that frames reach the
+ * file even if no more arrive. A slow storage device never stalls
+ * decoding: batches that do not fit in the queue are dropped and counted.
+ * The writer can split the log into segments by size or duration, and
+ * compress each segment on the fly.
+ */
+
+#ifndef __DM_COLLECTOR_C_LOG_WRITER_H__
+#define __DM_COLLECTOR_C_LOG_WRITER_H__
+
+#ifndef _WIN32
+#include <zlib.h>
+#include "block_log.h"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Number of batches that can be pending in the queue.
+#define WRITER_QUEUE_SLOTS 64
+// Staged frames are handed over in batches of this size, or after this many
+// seconds. Written data is flushed to the file at the same interval.
+#define WRITER_BATCH_SIZE (256 * 1024)
+#define WRITER_BATCH_INTERVAL 1.0
+// Disk writes are issued in chunks of this size, at offsets aligned to
+// WRITER_BLOCK_SIZE.
+#define WRITER_BLOCK_SIZE 4096
+#define WRITER_CHUNK_SIZE (1024 * 1024)
+
+enum WriterCompression {
+    WRITER_COMPRESSION_NONE = 0,
+    WRITER_COMPRESSION_GZIP,    // Streaming deflate in a gzip container
+    WRITER_COMPRESSION_BLOCK,   // Indexed blocks, see block_log.h
+};
+
+struct LogWriterOptions {
+    double sync_interval;       // Seconds between fdatasync() calls, 0 to disable
+    // A new segment is started once the current one holds max_segment_bytes
+    // bytes of raw log, or is older than max_segment_seconds. 0 disables either
+    // limit. Segments are only switched between batches.
+    unsigned long long max_segment_bytes;
+    double max_segment_seconds;
+    WriterCompression compression;
+    int compression_level;      // 1-9, or -1 for the zlib default
+    // Written at the start of every segment, e.g. the header of a pcapng file.
+    // Not counted in max_segment_bytes. Not supported with block compression.
+    std::string segment_header;
+};
+
+struct LogWriterStats {
+    size_t queue_depth;         // Batches waiting in the queue
+    size_t queue_capacity;
+    unsigned long long frames_queued;
+    unsigned long long bytes_queued;
+    unsigned long long frames_dropped;  // Lost because the queue was full
+    unsigned long long bytes_dropped;
+    unsigned long long bytes_written;   // Bytes that reached the file(s), after compression
+    unsigned long long segments;        // Number of files opened
+    unsigned long long syncs;
+    unsigned long long write_errors;
+};
+
+struct LogWriterState {
+    bool opened;
+    std::string filename;   // Path or naming pattern given to writer_open()
+    LogWriterOptions options;
+
+#ifdef _WIN32
+    FILE *fp;
+#else
+    // Frames not yet handed over. The staging mutex also serializes the
+    // producers of the queue: the decoding thread, and the writer thread when
+    // it hands over an old batch.
+    std::string staged;
+    size_t staged_frames;
+    double staged_since;    // When the first staged frame arrived
+    std::mutex staging_mutex;
+
+    // Current segment. Only accessed by the writer thread once it is started.
+    bool segment_opened;
+    std::string segment_path;
+    unsigned int segment_index;
+    double segment_start;
+    unsigned long long segment_raw_bytes;
+    int fd;
+    z_stream zs;
+    BlockLogEncoder blk;
+    std::string blk_out;    // Encoded bytes not yet staged
+    char *chunk;            // Aligned staging buffer of WRITER_CHUNK_SIZE bytes
+    size_t chunk_len;
+    unsigned long long file_offset;  // File offset of chunk[0]
+    unsigned long long closed_bytes; // Bytes written to previous segments
+    double last_sync;
+    double last_flush;
+    bool unflushed;         // Data written since the last flush
+
+    // SPSC ring. Only the decoding thread advances tail, and only the writer
+    // thread advances head.
+    std::string slots[WRITER_QUEUE_SLOTS];
+    size_t slot_frames[WRITER_QUEUE_SLOTS];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+
+    std::thread worker;
+    std::mutex mutex;       // Only used to sleep/wake up, never held while copying
+    std::condition_variable wakeup;
+    std::condition_variable flushed;
+    std::atomic<unsigned long long> flush_requested;
+    std::atomic<unsigned long long> flush_done;
+    std::atomic<bool> stopping;
+#endif
+
+    std::atomic<unsigned long long> frames_queued;
+    std::atomic<unsigned long long> bytes_queued;
+    std::atomic<unsigned long long> frames_dropped;
+    std::atomic<unsigned long long> bytes_dropped;
+    std::atomic<unsigned long long> bytes_written;
+    std::atomic<unsigned long long> segments;
+    std::atomic<unsigned long long> syncs;
+    std::atomic<unsigned long long> write_errors;
+};
+
+// Must be called before usage
+void writer_init_state (struct LogWriterState *pstate);
+void writer_init_options (struct LogWriterOptions *options);
+
+// Open a log file and start the writer thread.
+// When segments are rotated, path is a naming pattern: "{seq}" is replaced by
+// the segment number, and strftime() conversions by the local time when the
+// segment is opened. If "{seq}" is missing, "_{seq}" is inserted before the
+// file extension. ".gz" is appended to gzip segments, and block segments get
+// the ".mi2blk" extension.
+// Rotation and compression are not available on Windows.
+// Return: successful or not
+bool writer_open (struct LogWriterState *pstate, const char *path,
+                  const struct LogWriterOptions *options);
+// Stage a frame of length bytes. Frames are handed over to the writer thread in
+// batches; a batch that does not fit in the queue is dropped.
+void writer_append (struct LogWriterState *pstate, const char *b, size_t length);
+
+// Block until everything staged so far is written to the file.
+void writer_flush (struct LogWriterState *pstate);
+
+// Flush, stop the writer thread and close the file.
+void writer_close (struct LogWriterState *pstate);
+
+void writer_get_stats (struct LogWriterState *pstate, struct LogWriterStats *stats);
+
+#endif // __DM_COLLECTOR_C_LOG_WRITER_H__
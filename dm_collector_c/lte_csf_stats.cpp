@@ -0,0 +1,179 @@
+/* lte_csf_stats.cpp
+ * Implements the "lte_csf_stats" analysis engine.
+ */
+
+#include "lte_csf_stats.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#define CSF_STATS_DEFAULT_GRANULARITY 1.0
+#define CSF_STATS_MIN_GRANULARITY 0.001
+
+static const char *CsfStatsChannelNames[] = {
+    "PUCCH",
+    "PUSCH",
+};
+
+struct CsfStatsKey {
+    int channel;
+    int carrier;
+
+    bool operator< (const CsfStatsKey &other) const {
+        if (channel != other.channel)
+            return channel < other.channel;
+        return carrier < other.carrier;
+    }
+};
+
+// Counts over one window
+struct CsfStatsWindow {
+    unsigned int reports;
+    unsigned int ri_hist[CSF_STATS_RI_BINS];
+    unsigned int cqi_cw0_hist[CSF_STATS_CQI_BINS];
+    unsigned int cqi_cw1_hist[CSF_STATS_CQI_BINS];
+    unsigned int pmi_hist[CSF_STATS_PMI_BINS];
+    unsigned int subband_cqi_hist[CSF_STATS_SUBBAND_BINS][CSF_STATS_CQI_BINS];
+};
+
+// Closed windows, as columns
+struct CsfStatsColumns {
+    std::vector<double> time;
+    std::vector<unsigned int> reports;
+    std::vector<unsigned int> ri_hist;
+    std::vector<unsigned int> cqi_cw0_hist;
+    std::vector<unsigned int> cqi_cw1_hist;
+    std::vector<unsigned int> pmi_hist;
+    std::vector<unsigned int> subband_cqi_hist;
+};
+
+struct CsfStatsSeries {
+    LteSysClock clock;
+    long long window;   // Index of the window in progress, or -1
+    CsfStatsWindow counts;
+    CsfStatsColumns columns;
+
+    CsfStatsSeries () : window(-1), counts() {
+        lte_sys_clock_reset(&clock);
+    }
+};
+
+typedef std::map<CsfStatsKey, CsfStatsSeries> CsfStatsSeriesMap;
+
+static CsfStatsSeriesMap g_series;
+static long long g_granularity_ms = 1000;
+
+template <size_t N>
+static void
+append_hist (std::vector<unsigned int> &column, const unsigned int (&hist)[N]) {
+    column.insert(column.end(), hist, hist + N);
+}
+
+template <size_t N>
+static void
+count_hist (unsigned int (&hist)[N], int value) {
+    if (value >= 0 && value < (int) N)
+        hist[value]++;
+}
+
+// Move the window in progress, if any, to the columns.
+static void
+close_window (CsfStatsSeries &s) {
+    if (s.window < 0)
+        return;
+    CsfStatsColumns &c = s.columns;
+    const CsfStatsWindow &w = s.counts;
+    c.time.push_back(s.window * g_granularity_ms / 1000.0);
+    c.reports.push_back(w.reports);
+    append_hist(c.ri_hist, w.ri_hist);
+    append_hist(c.cqi_cw0_hist, w.cqi_cw0_hist);
+    append_hist(c.cqi_cw1_hist, w.cqi_cw1_hist);
+    append_hist(c.pmi_hist, w.pmi_hist);
+    for (int i = 0; i < CSF_STATS_SUBBAND_BINS; i++)
+        append_hist(c.subband_cqi_hist, w.subband_cqi_hist[i]);
+    s.counts = CsfStatsWindow();
+    s.window = -1;
+}
+
+void
+csf_stats_on_report (int channel, int carrier, int rank_index,
+                     int cqi_cw0, int cqi_cw1, int wideband_pmi,
+                     int subband_label, int sys_fn, int sub_fn) {
+    if (!LteCsfStatsEngine.enabled)
+        return;
+    CsfStatsKey key = {channel, carrier};
+    CsfStatsSeries &s = g_series[key];
+    long long t = lte_sys_clock_to_unix_ms(&s.clock, lte_sys_time(sys_fn, sub_fn));
+    long long window = t / g_granularity_ms;
+    // A late report is added to the window in progress
+    if (window > s.window) {
+        close_window(s);
+        s.window = window;
+    }
+    CsfStatsWindow &w = s.counts;
+    w.reports++;
+    count_hist(w.ri_hist, rank_index);
+    if (subband_label >= 0) {
+        if (subband_label < CSF_STATS_SUBBAND_BINS)
+            count_hist(w.subband_cqi_hist[subband_label], cqi_cw0);
+        return;
+    }
+    count_hist(w.cqi_cw0_hist, cqi_cw0);
+    if (rank_index > 0)
+        count_hist(w.cqi_cw1_hist, cqi_cw1);
+    count_hist(w.pmi_hist, wideband_pmi);
+}
+
+static bool
+lte_csf_stats_configure (PyObject *options) {
+    double granularity = CSF_STATS_DEFAULT_GRANULARITY;
+    if (!analysis_get_double_option(options, "granularity", &granularity))
+        return false;
+    if (!(granularity >= CSF_STATS_MIN_GRANULARITY)) {
+        PyErr_SetString(PyExc_ValueError, "granularity must be at least 0.001");
+        return false;
+    }
+    g_series.clear();
+    g_granularity_ms = (long long) llround(granularity * 1000);
+    return true;
+}
+
+static PyObject *
+build_columns (const CsfStatsColumns &c) {
+    return Py_BuildValue("{s:N,s:N,s:N,s:N,s:N,s:N,s:N}",
+                         "time", analysis_make_column(c.time, "d"),
+                         "reports", analysis_make_column(c.reports, "I"),
+                         "ri_hist", analysis_make_column(c.ri_hist, "I"),
+                         "cqi_cw0_hist", analysis_make_column(c.cqi_cw0_hist, "I"),
+                         "cqi_cw1_hist", analysis_make_column(c.cqi_cw1_hist, "I"),
+                         "pmi_hist", analysis_make_column(c.pmi_hist, "I"),
+                         "subband_cqi_hist", analysis_make_column(c.subband_cqi_hist, "I"));
+}
+
+static PyObject *
+lte_csf_stats_collect () {
+    PyObject *series = PyDict_New();
+    for (CsfStatsSeriesMap::iterator it = g_series.begin(); it != g_series.end(); ++it) {
+        close_window(it->second);
+        if (it->second.columns.time.empty())
+            continue;
+        PyObject *key = Py_BuildValue("(si)", CsfStatsChannelNames[it->first.channel],
+                                      it->first.carrier);
+        PyObject *columns = build_columns(it->second.columns);
+        PyDict_SetItem(series, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        it->second.columns = CsfStatsColumns();
+    }
+    return Py_BuildValue("{s:d,s:N}",
+                         "granularity", g_granularity_ms / 1000.0,
+                         "series", series);
+}
+
+AnalysisEngine LteCsfStatsEngine = {
+    "lte_csf_stats",
+    false,
+    lte_csf_stats_configure,
+    lte_csf_stats_collect,
+};
@@ -0,0 +1,59 @@
+/* lte_csf_stats.h
+ * Analysis engine "lte_csf_stats": builds histograms of the channel state
+ * feedback of LTE_PHY_PUCCH_CSF and LTE_PHY_PUSCH_CSF over fixed time windows.
+ *
+ * Reports are timed by their Start System Frame Number and Sub-frame Number,
+ * placed on the Unix time with a LteSysClock. Series are keyed by
+ *     (channel, carrier)
+ * where channel is "PUCCH" or "PUSCH" and carrier the logged Carrier Index
+ * (0 PCC, 1 SCC, ...). Every series has the columns (memoryviews of copies
+ * of the series, which numpy.asarray() takes without copying again)
+ *     time (d): start of the window, in seconds since the Unix epoch
+ *     reports (I): CSF reports
+ *     ri_hist (I): CSF_STATS_RI_BINS counts per row, of the Rank Index
+ *                  (0 Rank 1, ..., 3 Rank 4) of every report
+ *     cqi_cw0_hist (I): CSF_STATS_CQI_BINS counts per row, of the wideband
+ *                       CQI of codeword 0
+ *     cqi_cw1_hist (I): CSF_STATS_CQI_BINS counts per row, of the wideband
+ *                       CQI of codeword 1, for reports of rank 2 or more
+ *     pmi_hist (I): CSF_STATS_PMI_BINS counts per row, of the wideband PMI
+ *     subband_cqi_hist (I): CSF_STATS_SUBBAND_BINS x CSF_STATS_CQI_BINS counts
+ *                           per row, of the CQI of every subband label;
+ *                           numpy.asarray(c).reshape(-1, 4, 16)
+ * with a row per window that has reports. PUCCH reports of Type 3 (RI
+ * feedback) only count in ri_hist, and only the PUCCH subband CQI reports
+ * (Type 1) count in subband_cqi_hist. The subband CQIs of PUSCH reports are
+ * not decoded. The window in progress is closed by collect_engine().
+ *
+ * Options:
+ *     granularity: seconds per window, at least 0.001. Default 1.0
+ *
+ * collect_engine() returns
+ *     {"granularity": seconds, "series": {key: {column: memoryview}}}
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_CSF_STATS_H__
+#define __DM_COLLECTOR_C_LTE_CSF_STATS_H__
+
+#include "analysis_engine.h"
+
+#define CSF_STATS_RI_BINS 4
+#define CSF_STATS_CQI_BINS 16
+#define CSF_STATS_PMI_BINS 16
+#define CSF_STATS_SUBBAND_BINS 4
+
+enum CsfStatsChannel {
+    CSF_STATS_PUCCH = 0,
+    CSF_STATS_PUSCH = 1,
+};
+
+extern AnalysisEngine LteCsfStatsEngine;
+
+// A CSF report. Fields that the report does not carry are -1: cqi_cw0,
+// cqi_cw1 and wideband_pmi for RI reports, subband_label but for subband CQI
+// reports, where cqi_cw0 is the CQI of that subband.
+void csf_stats_on_report (int channel, int carrier, int rank_index,
+                          int cqi_cw0, int cqi_cw1, int wideband_pmi,
+                          int subband_label, int sys_fn, int sub_fn);
+
+#endif // __DM_COLLECTOR_C_LTE_CSF_STATS_H__
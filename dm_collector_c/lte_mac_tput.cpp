@@ -0,0 +1,151 @@
+/* lte_mac_tput.cpp
+ * Implements the "lte_mac_tput" analysis engine.
+ */
+
+#include "lte_mac_tput.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#define MAC_TPUT_DEFAULT_GRANULARITY 1.0
+#define MAC_TPUT_MIN_GRANULARITY 0.001
+
+static const char *MacTputDirectionNames[] = {
+    "UL",
+    "DL",
+};
+
+struct MacTputKey {
+    int direction;
+    int carrier;
+    int rnti_type;
+    int harq_id;    // -1 unless by_harq
+
+    bool operator< (const MacTputKey &other) const {
+        if (direction != other.direction)
+            return direction < other.direction;
+        if (carrier != other.carrier)
+            return carrier < other.carrier;
+        if (rnti_type != other.rnti_type)
+            return rnti_type < other.rnti_type;
+        return harq_id < other.harq_id;
+    }
+};
+
+struct MacTputSeries {
+    long long window;   // Index of the window in progress, or -1
+    unsigned long long bytes;
+    unsigned long long padding_bytes;
+    unsigned int tbs;
+    // Closed windows
+    std::vector<double> time_col;
+    std::vector<unsigned long long> bytes_col;
+    std::vector<unsigned long long> padding_bytes_col;
+    std::vector<unsigned int> tbs_col;
+
+    MacTputSeries () : window(-1), bytes(0), padding_bytes(0), tbs(0) {}
+};
+
+typedef std::map<MacTputKey, MacTputSeries> MacTputSeriesMap;
+
+static MacTputSeriesMap g_series;
+static LteSysClock g_clocks[2];     // By direction
+static long long g_granularity_ms = 1000;
+static bool g_by_harq = false;
+
+static void
+close_window (MacTputSeries &s) {
+    if (s.window < 0)
+        return;
+    s.time_col.push_back(s.window * g_granularity_ms / 1000.0);
+    s.bytes_col.push_back(s.bytes);
+    s.padding_bytes_col.push_back(s.padding_bytes);
+    s.tbs_col.push_back(s.tbs);
+    s.window = -1;
+    s.bytes = 0;
+    s.padding_bytes = 0;
+    s.tbs = 0;
+}
+
+void
+mac_tput_on_tb (int direction, int carrier, int rnti_type, int harq_id,
+                int bytes, int padding_bytes, int sys_fn, int sub_fn) {
+    if (!LteMacTputEngine.enabled)
+        return;
+    MacTputKey key = {direction, carrier, rnti_type, g_by_harq ? harq_id : -1};
+    MacTputSeries &s = g_series[key];
+    long long t = lte_sys_clock_to_unix_ms(&g_clocks[direction],
+                                           lte_sys_time(sys_fn, sub_fn));
+    long long window = t / g_granularity_ms;
+    // A late transport block is added to the window in progress
+    if (window > s.window) {
+        close_window(s);
+        s.window = window;
+    }
+    s.bytes += bytes;
+    s.padding_bytes += padding_bytes;
+    s.tbs++;
+}
+
+static bool
+lte_mac_tput_configure (PyObject *options) {
+    double granularity = MAC_TPUT_DEFAULT_GRANULARITY;
+    bool by_harq = false;
+    if (!analysis_get_double_option(options, "granularity", &granularity)
+            || !analysis_get_bool_option(options, "by_harq", &by_harq))
+        return false;
+    if (!(granularity >= MAC_TPUT_MIN_GRANULARITY)) {
+        PyErr_SetString(PyExc_ValueError, "granularity must be at least 0.001");
+        return false;
+    }
+    g_series.clear();
+    lte_sys_clock_reset(&g_clocks[MAC_TPUT_UL]);
+    lte_sys_clock_reset(&g_clocks[MAC_TPUT_DL]);
+    g_granularity_ms = (long long) llround(granularity * 1000);
+    g_by_harq = by_harq;
+    return true;
+}
+
+static PyObject *
+build_key (const MacTputKey &key) {
+    if (key.harq_id < 0)
+        return Py_BuildValue("(sii)", MacTputDirectionNames[key.direction],
+                             key.carrier, key.rnti_type);
+    return Py_BuildValue("(siii)", MacTputDirectionNames[key.direction],
+                         key.carrier, key.rnti_type, key.harq_id);
+}
+
+static PyObject *
+lte_mac_tput_collect () {
+    PyObject *series = PyDict_New();
+    for (MacTputSeriesMap::iterator it = g_series.begin(); it != g_series.end(); ++it) {
+        MacTputSeries &s = it->second;
+        close_window(s);
+        if (s.time_col.empty())
+            continue;
+        PyObject *key = build_key(it->first);
+        PyObject *columns = Py_BuildValue("{s:N,s:N,s:N,s:N}",
+                "time", analysis_make_column(s.time_col, "d"),
+                "bytes", analysis_make_column(s.bytes_col, "Q"),
+                "padding_bytes", analysis_make_column(s.padding_bytes_col, "Q"),
+                "tbs", analysis_make_column(s.tbs_col, "I"));
+        PyDict_SetItem(series, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        s.time_col.clear();
+        s.bytes_col.clear();
+        s.padding_bytes_col.clear();
+        s.tbs_col.clear();
+    }
+    return Py_BuildValue("{s:d,s:N}",
+                         "granularity", g_granularity_ms / 1000.0,
+                         "series", series);
+}
+
+AnalysisEngine LteMacTputEngine = {
+    "lte_mac_tput",
+    false,
+    lte_mac_tput_configure,
+    lte_mac_tput_collect,
+};
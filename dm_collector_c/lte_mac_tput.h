@@ -0,0 +1,47 @@
+/* lte_mac_tput.h
+ * Analysis engine "lte_mac_tput": sums the transport blocks of
+ * LTE_MAC_DL_Transport_Block and LTE_MAC_UL_Transport_Block over fixed time
+ * windows, as throughput time series.
+ *
+ * Transport blocks are timed by their SFN and subframe, placed on the Unix
+ * time with a LteSysClock. Series are keyed by
+ *     (direction, carrier, rnti_type)
+ * or, with the "by_harq" option, (direction, carrier, rnti_type, harq_id),
+ * where direction is "UL" or "DL", carrier the logged Cell Id (0 for
+ * subpacket versions without it) and rnti_type the logged RNTI Type
+ * (0 C-RNTI, 1 SPS-RNTI, 2 P-RNTI, 3 RA-RNTI, ...). Every series has the
+ * columns (memoryviews of copies of the series, which numpy.asarray() takes
+ * without copying again)
+ *     time (d): start of the window, in seconds since the Unix epoch
+ *     bytes (Q): sum of the DL TBS or UL grant
+ *     padding_bytes (Q): sum of their padding
+ *     tbs (I): number of transport blocks
+ * with a row per window that has transport blocks. Throughput over a sliding
+ * window is a rolling sum of rows. The window in progress is closed by
+ * collect_engine().
+ *
+ * Options:
+ *     granularity: seconds per window, at least 0.001. Default 1.0
+ *     by_harq:     add the HARQ ID to the keys. Default False
+ *
+ * collect_engine() returns
+ *     {"granularity": seconds, "series": {key: {column: memoryview}}}
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_MAC_TPUT_H__
+#define __DM_COLLECTOR_C_LTE_MAC_TPUT_H__
+
+#include "analysis_engine.h"
+
+enum MacTputDirection {
+    MAC_TPUT_UL = 0,
+    MAC_TPUT_DL = 1,
+};
+
+extern AnalysisEngine LteMacTputEngine;
+
+// A transport block. bytes is the DL TBS or the UL grant.
+void mac_tput_on_tb (int direction, int carrier, int rnti_type, int harq_id,
+                     int bytes, int padding_bytes, int sys_fn, int sub_fn);
+
+#endif // __DM_COLLECTOR_C_LTE_MAC_TPUT_H__
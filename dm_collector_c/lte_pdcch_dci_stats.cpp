@@ -0,0 +1,183 @@
+/* lte_pdcch_dci_stats.cpp
+ * Implements the "lte_pdcch_dci_stats" analysis engine.
+ */
+
+#include "lte_pdcch_dci_stats.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#define PDCCH_DCI_STATS_DEFAULT_GRANULARITY 1.0
+#define PDCCH_DCI_STATS_MIN_GRANULARITY 0.001
+
+// Prune Status values of a found DCI (see ValueNamePruneStatus)
+static bool
+is_success_prune_status (int prune_status) {
+    switch (prune_status) {
+    case 1:     // SUCCESS_DCI0
+    case 3:     // SUCCESS_DCI1A
+    case 4:     // SUCCESS_DCI1C
+    case 6:     // SUCCESS_DCI2_2A_2B
+    case 200:   // PDCCH_DEBUG_SUCCESS_DCI60A
+    case 201:   // PDCCH_DEBUG_SUCCESS_DCI61A
+    case 202:   // PDCCH_DEBUG_SUCCESS_DCI62
+    case 216:   // PDCCH_DEBUG_SUCCESS_DCI62_EARLY_TERMINATION
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Counts over one window
+struct PdcchDciStatsWindow {
+    unsigned int hypotheses;
+    unsigned int dcis;
+    unsigned int dci_format_hist[PDCCH_DCI_STATS_FORMAT_BINS];
+    unsigned int agg_level_hist[PDCCH_DCI_STATS_AGG_LEVEL_BINS];
+    unsigned int rnti_type_hist[PDCCH_DCI_STATS_RNTI_TYPE_BINS];
+    unsigned int search_space_hist[PDCCH_DCI_STATS_SEARCH_SPACE_BINS];
+    unsigned int prune_status_hist[PDCCH_DCI_STATS_PRUNE_STATUS_BINS];
+};
+
+// Closed windows, as columns
+struct PdcchDciStatsColumns {
+    std::vector<double> time;
+    std::vector<unsigned int> hypotheses;
+    std::vector<unsigned int> dcis;
+    std::vector<unsigned int> dci_format_hist;
+    std::vector<unsigned int> agg_level_hist;
+    std::vector<unsigned int> rnti_type_hist;
+    std::vector<unsigned int> search_space_hist;
+    std::vector<unsigned int> prune_status_hist;
+};
+
+struct PdcchDciStatsCarrier {
+    LteSysClock clock;
+    long long window;   // Index of the window in progress, or -1
+    PdcchDciStatsWindow counts;
+    PdcchDciStatsColumns columns;
+
+    PdcchDciStatsCarrier () : window(-1), counts() {
+        lte_sys_clock_reset(&clock);
+    }
+};
+
+typedef std::map<int, PdcchDciStatsCarrier> PdcchDciStatsCarrierMap;
+
+static PdcchDciStatsCarrierMap g_carriers;
+static long long g_granularity_ms = 1000;
+
+template <size_t N>
+static void
+append_hist (std::vector<unsigned int> &column, const unsigned int (&hist)[N]) {
+    column.insert(column.end(), hist, hist + N);
+}
+
+template <size_t N>
+static void
+count_hist (unsigned int (&hist)[N], int value) {
+    if (value >= 0 && value < (int) N)
+        hist[value]++;
+}
+
+// Move the window in progress, if any, to the columns.
+static void
+close_window (PdcchDciStatsCarrier &s) {
+    if (s.window < 0)
+        return;
+    PdcchDciStatsColumns &c = s.columns;
+    const PdcchDciStatsWindow &w = s.counts;
+    c.time.push_back(s.window * g_granularity_ms / 1000.0);
+    c.hypotheses.push_back(w.hypotheses);
+    c.dcis.push_back(w.dcis);
+    append_hist(c.dci_format_hist, w.dci_format_hist);
+    append_hist(c.agg_level_hist, w.agg_level_hist);
+    append_hist(c.rnti_type_hist, w.rnti_type_hist);
+    append_hist(c.search_space_hist, w.search_space_hist);
+    append_hist(c.prune_status_hist, w.prune_status_hist);
+    s.counts = PdcchDciStatsWindow();
+    s.window = -1;
+}
+
+void
+pdcch_dci_stats_on_hypothesis (int carrier, int agg_level, int search_space,
+                               int dci_format, int decode_status, int prune_status,
+                               int sys_fn, int sub_fn) {
+    if (!LtePdcchDciStatsEngine.enabled)
+        return;
+    PdcchDciStatsCarrier &s = g_carriers[carrier];
+    long long t = lte_sys_clock_to_unix_ms(&s.clock, lte_sys_time(sys_fn, sub_fn));
+    long long window = t / g_granularity_ms;
+    // A late hypothesis is added to the window in progress
+    if (window > s.window) {
+        close_window(s);
+        s.window = window;
+    }
+    PdcchDciStatsWindow &w = s.counts;
+    w.hypotheses++;
+    if (prune_status >= PDCCH_DCI_STATS_PRUNE_STATUS_BINS)
+        prune_status = PDCCH_DCI_STATS_PRUNE_STATUS_BINS - 1;
+    count_hist(w.prune_status_hist, prune_status);
+    if (!is_success_prune_status(prune_status))
+        return;
+    w.dcis++;
+    count_hist(w.dci_format_hist, dci_format);
+    count_hist(w.agg_level_hist, agg_level);
+    count_hist(w.rnti_type_hist, decode_status);
+    count_hist(w.search_space_hist, search_space);
+}
+
+static bool
+lte_pdcch_dci_stats_configure (PyObject *options) {
+    double granularity = PDCCH_DCI_STATS_DEFAULT_GRANULARITY;
+    if (!analysis_get_double_option(options, "granularity", &granularity))
+        return false;
+    if (!(granularity >= PDCCH_DCI_STATS_MIN_GRANULARITY)) {
+        PyErr_SetString(PyExc_ValueError, "granularity must be at least 0.001");
+        return false;
+    }
+    g_carriers.clear();
+    g_granularity_ms = (long long) llround(granularity * 1000);
+    return true;
+}
+
+static PyObject *
+build_columns (const PdcchDciStatsColumns &c) {
+    return Py_BuildValue("{s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N}",
+                         "time", analysis_make_column(c.time, "d"),
+                         "hypotheses", analysis_make_column(c.hypotheses, "I"),
+                         "dcis", analysis_make_column(c.dcis, "I"),
+                         "dci_format_hist", analysis_make_column(c.dci_format_hist, "I"),
+                         "agg_level_hist", analysis_make_column(c.agg_level_hist, "I"),
+                         "rnti_type_hist", analysis_make_column(c.rnti_type_hist, "I"),
+                         "search_space_hist", analysis_make_column(c.search_space_hist, "I"),
+                         "prune_status_hist", analysis_make_column(c.prune_status_hist, "I"));
+}
+
+static PyObject *
+lte_pdcch_dci_stats_collect () {
+    PyObject *series = PyDict_New();
+    for (PdcchDciStatsCarrierMap::iterator it = g_carriers.begin();
+            it != g_carriers.end(); ++it) {
+        close_window(it->second);
+        if (it->second.columns.time.empty())
+            continue;
+        PyObject *key = PyLong_FromLong(it->first);
+        PyObject *columns = build_columns(it->second.columns);
+        PyDict_SetItem(series, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        it->second.columns = PdcchDciStatsColumns();
+    }
+    return Py_BuildValue("{s:d,s:N}",
+                         "granularity", g_granularity_ms / 1000.0,
+                         "series", series);
+}
+
+AnalysisEngine LtePdcchDciStatsEngine = {
+    "lte_pdcch_dci_stats",
+    false,
+    lte_pdcch_dci_stats_configure,
+    lte_pdcch_dci_stats_collect,
+};
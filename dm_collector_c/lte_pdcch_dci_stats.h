@@ -0,0 +1,59 @@
+/* lte_pdcch_dci_stats.h
+ * Analysis engine "lte_pdcch_dci_stats": counts the PDCCH blind decoding
+ * hypotheses of LTE_PHY_PDCCH_Decoding_Result, and the DCIs they found, over
+ * fixed time windows per carrier.
+ *
+ * A hypothesis is a found DCI when its Prune Status is one of the SUCCESS
+ * values of ValueNamePruneStatus. Hypotheses are timed by the SFN and
+ * subframe of their packet (or, for version 141, of the hypothesis), placed
+ * on the Unix time with a LteSysClock. Series are keyed by the logged Carrier
+ * Index (0 PCC, 1 SCC, ...), with the columns (memoryviews of copies of the
+ * series, which numpy.asarray() takes without copying again)
+ *     time (d): start of the window, in seconds since the Unix epoch
+ *     hypotheses (I): blind decoding hypotheses
+ *     dcis (I): found DCIs
+ *     dci_format_hist (I): PDCCH_DCI_STATS_FORMAT_BINS counts per row, of the
+ *                          DCI Format of the found DCIs (as in
+ *                          ValueNameDCIFormat)
+ *     agg_level_hist (I): PDCCH_DCI_STATS_AGG_LEVEL_BINS counts per row, of
+ *                         their Aggregation Level code (0 Agg1, 1 Agg2,
+ *                         2 Agg4, 3 Agg8, 6 Agg16, 7 Agg24)
+ *     rnti_type_hist (I): PDCCH_DCI_STATS_RNTI_TYPE_BINS counts per row, of
+ *                         their Decode Status, the RNTI Type they were
+ *                         scrambled with (as in ValueNameRNTIType)
+ *     search_space_hist (I): PDCCH_DCI_STATS_SEARCH_SPACE_BINS counts per
+ *                            row, of their Search Space Type (0 Common,
+ *                            1 UE-specific, ...)
+ *     prune_status_hist (I): PDCCH_DCI_STATS_PRUNE_STATUS_BINS counts per row,
+ *                            of the Prune Status of every hypothesis; values
+ *                            past the last bin count in it
+ * with a row per window that has hypotheses. A histogram is read with
+ * numpy.asarray(c).reshape(-1, bins). The window in progress is closed by
+ * collect_engine().
+ *
+ * Options:
+ *     granularity: seconds per window, at least 0.001. Default 1.0
+ *
+ * collect_engine() returns
+ *     {"granularity": seconds, "series": {carrier_index: {column: memoryview}}}
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_PDCCH_DCI_STATS_H__
+#define __DM_COLLECTOR_C_LTE_PDCCH_DCI_STATS_H__
+
+#include "analysis_engine.h"
+
+#define PDCCH_DCI_STATS_FORMAT_BINS 16
+#define PDCCH_DCI_STATS_AGG_LEVEL_BINS 8
+#define PDCCH_DCI_STATS_RNTI_TYPE_BINS 16
+#define PDCCH_DCI_STATS_SEARCH_SPACE_BINS 4
+#define PDCCH_DCI_STATS_PRUNE_STATUS_BINS 256
+
+extern AnalysisEngine LtePdcchDciStatsEngine;
+
+// A blind decoding hypothesis, with the raw logged codes of its fields
+void pdcch_dci_stats_on_hypothesis (int carrier, int agg_level, int search_space,
+                                    int dci_format, int decode_status, int prune_status,
+                                    int sys_fn, int sub_fn);
+
+#endif // __DM_COLLECTOR_C_LTE_PDCCH_DCI_STATS_H__
@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_pdcp_timeline.h"
 
 const Fmt LtePdcpDlCipherDataPdu_Fmt [] = {
     {UINT, "Version", 1},
@@ -212,6 +213,11 @@ static int _decode_lte_pdcp_dl_cipher_data_pdu_payload (const char *b,
                                 "SN", iSN);
                         Py_DECREF(old_object);
 
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_DL, iCfgIdx, iBearerId,
+                                iSNLength, iSN,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -310,6 +316,11 @@ static int _decode_lte_pdcp_dl_cipher_data_pdu_payload (const char *b,
                                 "SN", iSN);
                         Py_DECREF(old_object);
 
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_DL, iCfgIdx, iBearerId,
+                                iSNLength, iSN,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -409,6 +420,11 @@ static int _decode_lte_pdcp_dl_cipher_data_pdu_payload (const char *b,
                                 "SN", iSN);
                         Py_DECREF(old_object);
 
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_DL, iCfgIdx, iBearerId,
+                                iSNLength, iSN,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -507,6 +523,14 @@ static int _decode_lte_pdcp_dl_cipher_data_pdu_payload (const char *b,
                                 "Reserved FN", iReserveFN);
                         Py_DECREF(old_object);
 
+                        // The COUNT holds the SN in its low bits
+                        unsigned int iCount = _search_result_int(result_pdu_item,
+                                "count(hex)");
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_DL, iCfgIdx, iBearerId,
+                                iSNLength, iCount,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -0,0 +1,341 @@
+/* lte_pdcp_timeline.cpp
+ * Implements the "lte_pdcp_timeline" analysis engine.
+ */
+
+#include "lte_pdcp_timeline.h"
+
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#define PDCP_MAX_SN_MODULUS 4096    // SNs are logged with at most 12 bits
+
+// A PDU further behind the highest SN than a quarter of the SN space, or
+// back at SN 0 after this long, restarts the bearer
+#define PDCP_RESET_MIN_GAP_MS 50
+
+#define PDCP_TIMELINE_DEFAULT_INTERVAL 1.0
+#define PDCP_TIMELINE_DEFAULT_MAX_EVENTS 100000
+
+enum PdcpEventKind {
+    PDCP_EVENT_GAP,
+    PDCP_EVENT_REORDERED,
+    PDCP_EVENT_DUPLICATE,
+    PDCP_EVENT_LOST,
+    PDCP_EVENT_RESET,
+};
+
+static const char *PdcpEventKindNames[] = {
+    "gap",
+    "reordered",
+    "duplicate",
+    "lost",
+    "reset",
+};
+
+static const char *PdcpDirectionNames[] = {
+    "UL",
+    "DL",
+};
+
+struct PdcpEvent {
+    double time;
+    int kind;
+    int direction;
+    int cfg_idx;
+    int sn;
+    int value;
+    int delay_ms;
+};
+
+// Sums over one period
+struct PdcpPeriodStats {
+    unsigned long long pdus;
+    unsigned long long bytes;
+    unsigned long long missing;
+    unsigned long long reordered;
+    unsigned long long duplicates;
+    unsigned long long lost;
+    unsigned long long resets;
+    int max_reorder_depth;
+    unsigned long long inter_pdu_sum;
+    unsigned long long inter_pdu_count;
+    int max_inter_pdu;
+};
+
+// Closed periods, as columns
+struct PdcpStatsColumns {
+    std::vector<double> time;
+    std::vector<int> bearer_id;
+    std::vector<unsigned long long> pdus;
+    std::vector<unsigned long long> bytes;
+    std::vector<unsigned long long> missing;
+    std::vector<unsigned long long> reordered;
+    std::vector<unsigned long long> duplicates;
+    std::vector<unsigned long long> lost;
+    std::vector<unsigned long long> resets;
+    std::vector<int> max_reorder_depth;
+    std::vector<double> mean_inter_pdu_ms;
+    std::vector<int> max_inter_pdu_ms;
+};
+
+struct PdcpBearerState {
+    int sn_modulus;     // 0 before the first PDU
+    int highest_sn;
+    int last_time;      // System time of the last PDU in ms
+    int bearer_id;
+    // System times in ms when SNs were found missing, or -1
+    int missing_time[PDCP_MAX_SN_MODULUS];
+    long long period;   // Index of the period in progress, or -1
+    PdcpPeriodStats stats;
+    PdcpStatsColumns columns;
+
+    PdcpBearerState () : sn_modulus(0), highest_sn(0), last_time(0), bearer_id(0),
+                         period(-1), stats() {
+        for (int i = 0; i < PDCP_MAX_SN_MODULUS; i++)
+            missing_time[i] = -1;
+    }
+};
+
+// Keyed by (direction, cfg_idx)
+typedef std::map<std::pair<int, int>, PdcpBearerState> PdcpBearerMap;
+
+static PdcpBearerMap g_bearers;
+static std::vector<PdcpEvent> g_events;
+static unsigned long long g_dropped_events = 0;
+static size_t g_max_events = PDCP_TIMELINE_DEFAULT_MAX_EVENTS;
+static double g_interval = PDCP_TIMELINE_DEFAULT_INTERVAL;
+
+static void
+add_event (int kind, int direction, int cfg_idx, int sn, int value, int delay_ms) {
+    if (g_events.size() >= g_max_events) {
+        g_dropped_events++;
+        return;
+    }
+    PdcpEvent e = {analysis_packet_time(), kind, direction, cfg_idx, sn, value, delay_ms};
+    g_events.push_back(e);
+}
+
+// Move the period in progress, if any, to the columns.
+static void
+close_period (PdcpBearerState &s) {
+    if (s.period < 0)
+        return;
+    PdcpStatsColumns &c = s.columns;
+    const PdcpPeriodStats &p = s.stats;
+    c.time.push_back(s.period * g_interval);
+    c.bearer_id.push_back(s.bearer_id);
+    c.pdus.push_back(p.pdus);
+    c.bytes.push_back(p.bytes);
+    c.missing.push_back(p.missing);
+    c.reordered.push_back(p.reordered);
+    c.duplicates.push_back(p.duplicates);
+    c.lost.push_back(p.lost);
+    c.resets.push_back(p.resets);
+    c.max_reorder_depth.push_back(p.max_reorder_depth);
+    c.mean_inter_pdu_ms.push_back(
+            p.inter_pdu_count ? (double) p.inter_pdu_sum / p.inter_pdu_count : 0.0);
+    c.max_inter_pdu_ms.push_back(p.max_inter_pdu);
+    s.stats = PdcpPeriodStats();
+    s.period = -1;
+}
+
+// Return: the SN space of a logged "SN Length" code, or 0 for the codes of
+// longer SNs, which the 12 bit SN field cannot hold
+static int
+get_sn_modulus (int sn_length) {
+    switch (sn_length) {
+    case 0:
+        return 1 << 5;
+    case 1:
+        return 1 << 7;
+    case 2:
+        return 1 << 12;
+    default:
+        return 0;
+    }
+}
+
+// Follow the SNs of a bearer again from cur.
+static void
+restart_bearer (PdcpBearerState &s, int modulus, int cur, int t) {
+    s.sn_modulus = modulus;
+    s.highest_sn = cur;
+    s.last_time = t;
+    for (int i = 0; i < PDCP_MAX_SN_MODULUS; i++)
+        s.missing_time[i] = -1;
+}
+
+void
+pdcp_timeline_on_pdu (int direction, int cfg_idx, int bearer_id, int sn_length,
+                      unsigned int sn, int pdu_bytes, int sys_fn, int sub_fn) {
+    if (!LtePdcpTimelineEngine.enabled)
+        return;
+    PdcpBearerState &s = g_bearers[std::make_pair(direction, cfg_idx)];
+    int t = lte_sys_time(sys_fn, sub_fn);
+    long long period = (long long) floor(analysis_packet_time() / g_interval);
+    if (period != s.period) {
+        close_period(s);
+        s.period = period;
+    }
+    s.bearer_id = bearer_id;
+    s.stats.pdus++;
+    s.stats.bytes += pdu_bytes;
+
+    int modulus = get_sn_modulus(sn_length);
+    if (modulus == 0) {
+        // SNs of 15 or 18 bits are not followed
+        s.sn_modulus = 0;
+        return;
+    }
+    int cur = sn & (modulus - 1);
+    if (s.sn_modulus != modulus) {
+        // First PDU, or the bearer was reconfigured
+        restart_bearer(s, modulus, cur, t);
+        return;
+    }
+    int inter_pdu = lte_sys_time_diff(t, s.last_time);
+    s.last_time = t;
+    s.stats.inter_pdu_sum += inter_pdu;
+    s.stats.inter_pdu_count++;
+    if (inter_pdu > s.stats.max_inter_pdu)
+        s.stats.max_inter_pdu = inter_pdu;
+
+    int half = modulus / 2;
+    int ahead = (cur - s.highest_sn + modulus) % modulus;
+    if (ahead > 0 && ahead < half) {
+        // SNs in between are missing, and as many old SNs leave the window.
+        // Runs of lost SNs are reported as one event
+        int lost_start = 0, lost_count = 0, lost_delay = 0;
+        for (int i = 1; i <= ahead; i++) {
+            int next = (s.highest_sn + i) % modulus;
+            int old = (next + half) % modulus;
+            if (s.missing_time[old] >= 0) {
+                if (lost_count > 0 && old != (lost_start + lost_count) % modulus) {
+                    add_event(PDCP_EVENT_LOST, direction, cfg_idx, lost_start, lost_count,
+                              lost_delay);
+                    lost_count = 0;
+                }
+                if (lost_count == 0) {
+                    lost_start = old;
+                    lost_delay = lte_sys_time_diff(t, s.missing_time[old]);
+                }
+                lost_count++;
+                s.stats.lost++;
+                s.missing_time[old] = -1;
+            }
+            s.missing_time[next] = (i < ahead) ? t : -1;
+        }
+        if (lost_count > 0)
+            add_event(PDCP_EVENT_LOST, direction, cfg_idx, lost_start, lost_count, lost_delay);
+        if (ahead > 1) {
+            s.stats.missing += ahead - 1;
+            add_event(PDCP_EVENT_GAP, direction, cfg_idx, (s.highest_sn + 1) % modulus,
+                      ahead - 1, inter_pdu);
+        }
+        s.highest_sn = cur;
+        return;
+    }
+
+    int depth = (modulus - ahead) % modulus;
+    if (s.missing_time[cur] < 0
+            && (depth > modulus / 4 || (cur == 0 && inter_pdu >= PDCP_RESET_MIN_GAP_MS))) {
+        // The SNs restarted: a re-establishment, a handover or a new bearer
+        // on the same Cfg Idx. SNs still missing are dropped
+        s.stats.resets++;
+        add_event(PDCP_EVENT_RESET, direction, cfg_idx, cur, s.highest_sn, inter_pdu);
+        restart_bearer(s, modulus, cur, t);
+        return;
+    }
+    if (s.missing_time[cur] >= 0) {
+        s.stats.reordered++;
+        if (depth > s.stats.max_reorder_depth)
+            s.stats.max_reorder_depth = depth;
+        add_event(PDCP_EVENT_REORDERED, direction, cfg_idx, cur, depth,
+                  lte_sys_time_diff(t, s.missing_time[cur]));
+        s.missing_time[cur] = -1;
+    } else {
+        s.stats.duplicates++;
+        add_event(PDCP_EVENT_DUPLICATE, direction, cfg_idx, cur, depth, 0);
+    }
+}
+
+static bool
+lte_pdcp_timeline_configure (PyObject *options) {
+    double interval = PDCP_TIMELINE_DEFAULT_INTERVAL;
+    long long max_events = PDCP_TIMELINE_DEFAULT_MAX_EVENTS;
+    if (!analysis_get_double_option(options, "interval", &interval)
+            || !analysis_get_int_option(options, "max_events", &max_events))
+        return false;
+    if (!(interval > 0)) {
+        PyErr_SetString(PyExc_ValueError, "interval must be positive");
+        return false;
+    }
+    if (max_events < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_events must not be negative");
+        return false;
+    }
+    g_bearers.clear();
+    g_events.clear();
+    g_dropped_events = 0;
+    g_interval = interval;
+    g_max_events = (size_t) max_events;
+    return true;
+}
+
+static PyObject *
+build_columns (const PdcpStatsColumns &c) {
+    return Py_BuildValue("{s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N}",
+                         "time", analysis_make_column(c.time, "d"),
+                         "bearer_id", analysis_make_column(c.bearer_id, "i"),
+                         "pdus", analysis_make_column(c.pdus, "Q"),
+                         "bytes", analysis_make_column(c.bytes, "Q"),
+                         "missing", analysis_make_column(c.missing, "Q"),
+                         "reordered", analysis_make_column(c.reordered, "Q"),
+                         "duplicates", analysis_make_column(c.duplicates, "Q"),
+                         "lost", analysis_make_column(c.lost, "Q"),
+                         "resets", analysis_make_column(c.resets, "Q"),
+                         "max_reorder_depth", analysis_make_column(c.max_reorder_depth, "i"),
+                         "mean_inter_pdu_ms", analysis_make_column(c.mean_inter_pdu_ms, "d"),
+                         "max_inter_pdu_ms", analysis_make_column(c.max_inter_pdu_ms, "i"));
+}
+
+static PyObject *
+lte_pdcp_timeline_collect () {
+    PyObject *events = PyList_New(g_events.size());
+    for (size_t i = 0; i < g_events.size(); i++) {
+        const PdcpEvent &e = g_events[i];
+        PyList_SetItem(events, i, Py_BuildValue("(dssiiii)", e.time,
+                                                PdcpEventKindNames[e.kind],
+                                                PdcpDirectionNames[e.direction],
+                                                e.cfg_idx, e.sn, e.value, e.delay_ms));
+    }
+    PyObject *stats = PyDict_New();
+    for (PdcpBearerMap::iterator it = g_bearers.begin(); it != g_bearers.end(); ++it) {
+        close_period(it->second);
+        if (it->second.columns.time.empty())
+            continue;
+        PyObject *key = Py_BuildValue("(si)", PdcpDirectionNames[it->first.first],
+                                      it->first.second);
+        PyObject *columns = build_columns(it->second.columns);
+        PyDict_SetItem(stats, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        it->second.columns = PdcpStatsColumns();
+    }
+    PyObject *ret = Py_BuildValue("{s:N,s:K,s:N}",
+                                  "events", events,
+                                  "dropped_events", g_dropped_events,
+                                  "stats", stats);
+    g_events.clear();
+    g_dropped_events = 0;
+    return ret;
+}
+
+AnalysisEngine LtePdcpTimelineEngine = {
+    "lte_pdcp_timeline",
+    false,
+    lte_pdcp_timeline_configure,
+    lte_pdcp_timeline_collect,
+};
@@ -0,0 +1,69 @@
+/* lte_pdcp_timeline.h
+ * Analysis engine "lte_pdcp_timeline": follows the PDCP SNs of every bearer in
+ * LTE_PDCP_DL_Cipher_Data_PDU and LTE_PDCP_UL_Cipher_Data_PDU, and reports SN
+ * gaps, reordering and inter-PDU latency.
+ *
+ * Bearers are keyed by (direction, Cfg Idx). Each keeps the highest SN seen
+ * and, for half of the SN space behind it, the SNs still missing. A PDU that
+ * was not missing and is more than a quarter of the SN space behind, or that
+ * is back at SN 0 at least 50 ms after the previous PDU, restarts the bearer
+ * (re-establishment, handover, or a new bearer on the same Cfg Idx). Only
+ * 5, 7 and 12 bit SNs are followed; the PDUs of other SN Lengths are only
+ * counted in pdus and bytes. Events are tuples
+ *     (time, kind, direction, cfg_idx, sn, value, delay_ms)
+ * where time is the log packet time in seconds since the Unix epoch, delay_ms
+ * is measured on the system frame numbers, and kind is one of
+ *     "gap":       SNs were skipped. sn is the first missing SN, value the
+ *                  number of missing SNs, delay_ms since the previous PDU
+ *     "reordered": a missing SN arrived. value is how far it is behind the
+ *                  highest SN, delay_ms since it was found missing
+ *     "duplicate": an SN that was not missing arrived again. value is how far
+ *                  it is behind the highest SN
+ *     "lost":      missing SNs fell half the SN space behind the highest SN.
+ *                  sn is the first of them, value the number of consecutive
+ *                  SNs, delay_ms since the first was found missing
+ *     "reset":     the SNs restarted at sn. value is the highest SN before,
+ *                  delay_ms since the previous PDU. SNs still missing are
+ *                  dropped
+ *
+ * Per bearer statistics are summed over periods of the log packet time, as
+ * columns (memoryviews of copies of the statistics, which numpy.asarray()
+ * takes without copying again):
+ *     time (d): start of the period, in seconds since the Unix epoch
+ *     bearer_id (i): the last Bearer ID seen in the period
+ *     pdus (Q), bytes (Q): PDUs and their PDU Size
+ *     missing (Q), reordered (Q), duplicates (Q), lost (Q): SNs
+ *     resets (Q): "reset" events
+ *     max_reorder_depth (i): the largest value of "reordered" events
+ *     mean_inter_pdu_ms (d), max_inter_pdu_ms (i): time between PDUs
+ * Periods without PDUs are skipped. The period in progress is closed by
+ * collect_engine().
+ *
+ * Options:
+ *     interval:   seconds per period. Default 1.0
+ *     max_events: events kept between two collect_engine() calls; more are
+ *                 counted as "dropped_events". Default 100000
+ *
+ * collect_engine() returns
+ *     {"events": [...], "dropped_events": n,
+ *      "stats": {(direction, cfg_idx): {column: memoryview}}}
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_PDCP_TIMELINE_H__
+#define __DM_COLLECTOR_C_LTE_PDCP_TIMELINE_H__
+
+#include "analysis_engine.h"
+
+enum PdcpTimelineDirection {
+    PDCP_TIMELINE_UL = 0,
+    PDCP_TIMELINE_DL = 1,
+};
+
+extern AnalysisEngine LtePdcpTimelineEngine;
+
+// A PDCP PDU. sn_length is the logged "SN Length" code (see
+// ValueNamePdcpSNLength); sn may also be a COUNT, whose HFN is dropped.
+void pdcp_timeline_on_pdu (int direction, int cfg_idx, int bearer_id, int sn_length,
+                           unsigned int sn, int pdu_bytes, int sys_fn, int sub_fn);
+
+#endif // __DM_COLLECTOR_C_LTE_PDCP_TIMELINE_H__
@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_pdcp_timeline.h"
 
 const Fmt LtePdcpUlCipherDataPdu_Fmt [] = {
     {UINT, "Version", 1},
@@ -211,6 +212,11 @@ static int _decode_lte_pdcp_ul_cipher_data_pdu_payload (const char *b,
                                 "SN", iSN);
                         Py_DECREF(old_object);
 
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_UL, iCfgIdx, iBearerId,
+                                iSNLength, iSN,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -309,6 +315,11 @@ static int _decode_lte_pdcp_ul_cipher_data_pdu_payload (const char *b,
                                 "SN", iSN);
                         Py_DECREF(old_object);
 
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_UL, iCfgIdx, iBearerId,
+                                iSNLength, iSN,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -407,6 +418,11 @@ static int _decode_lte_pdcp_ul_cipher_data_pdu_payload (const char *b,
                                 "SN", iSN);
                         Py_DECREF(old_object);
 
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_UL, iCfgIdx, iBearerId,
+                                iSNLength, iSN,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -501,6 +517,14 @@ static int _decode_lte_pdcp_ul_cipher_data_pdu_payload (const char *b,
                                 "Sys FN", iSysFN);
                         Py_DECREF(old_object);
 
+                        // The COUNT holds the SN in its low bits
+                        unsigned int iCount = _search_result_int(result_pdu_item,
+                                "count (hex)");
+                        pdcp_timeline_on_pdu(PDCP_TIMELINE_UL, iCfgIdx, iBearerId,
+                                iSNLength, iCount,
+                                _search_result_int(result_pdu_item, "PDU Size"),
+                                iSysFN, iSubFN);
+
                         PyObject *t2 = Py_BuildValue("(sOs)", "Ignored",
                                 result_pdu_item, "dict");
                         PyList_Append(result_PDUs, t2);
@@ -0,0 +1,200 @@
+/* lte_pdsch_bler.cpp
+ * Implements the "lte_pdsch_bler" analysis engine.
+ */
+
+#include "lte_pdsch_bler.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#define PDSCH_BLER_DEFAULT_GRANULARITY 1.0
+#define PDSCH_BLER_MIN_GRANULARITY 0.001
+
+#define PDSCH_BLER_HARQ_IDS 16
+#define PDSCH_BLER_TB_IDXS 2
+
+// RNTI Types (see RNTIType) whose blocks use HARQ processes with NDIs
+static bool
+is_harq_rnti_type (int rnti_type) {
+    return rnti_type == 0 || rnti_type == 1 || rnti_type == 4;
+}
+
+struct PdschBlerHarq {
+    bool valid;     // A block was seen
+    int rnti_type;
+    int ndi;
+    bool failed;    // The block has not passed its CRC yet
+};
+
+// Sums over one window
+struct PdschBlerWindow {
+    unsigned int new_tbs;
+    unsigned int retx_tbs;
+    unsigned int first_tx_failures;
+    unsigned int crc_failures;
+    unsigned int residual_failures;
+    unsigned long long goodput_bytes;
+    unsigned int mcs_hist[PDSCH_BLER_MCS_BINS];
+};
+
+// Closed windows, as columns
+struct PdschBlerColumns {
+    std::vector<double> time;
+    std::vector<unsigned int> new_tbs;
+    std::vector<unsigned int> retx_tbs;
+    std::vector<unsigned int> first_tx_failures;
+    std::vector<unsigned int> crc_failures;
+    std::vector<unsigned int> residual_failures;
+    std::vector<double> bler;
+    std::vector<unsigned long long> goodput_bytes;
+    std::vector<unsigned int> mcs_hist;
+};
+
+struct PdschBlerCarrier {
+    LteSysClock clock;
+    PdschBlerHarq harq[PDSCH_BLER_HARQ_IDS][PDSCH_BLER_TB_IDXS];
+    long long window;   // Index of the window in progress, or -1
+    PdschBlerWindow sums;
+    PdschBlerColumns columns;
+
+    PdschBlerCarrier () : harq(), window(-1), sums() {
+        lte_sys_clock_reset(&clock);
+    }
+};
+
+typedef std::map<int, PdschBlerCarrier> PdschBlerCarrierMap;
+
+static PdschBlerCarrierMap g_carriers;
+static long long g_granularity_ms = 1000;
+static bool g_records = true;
+
+// Move the window in progress, if any, to the columns.
+static void
+close_window (PdschBlerCarrier &s) {
+    if (s.window < 0)
+        return;
+    PdschBlerColumns &c = s.columns;
+    const PdschBlerWindow &w = s.sums;
+    c.time.push_back(s.window * g_granularity_ms / 1000.0);
+    c.new_tbs.push_back(w.new_tbs);
+    c.retx_tbs.push_back(w.retx_tbs);
+    c.first_tx_failures.push_back(w.first_tx_failures);
+    c.crc_failures.push_back(w.crc_failures);
+    c.residual_failures.push_back(w.residual_failures);
+    c.bler.push_back(w.new_tbs ? (double) w.first_tx_failures / w.new_tbs : 0.0);
+    c.goodput_bytes.push_back(w.goodput_bytes);
+    c.mcs_hist.insert(c.mcs_hist.end(), w.mcs_hist, w.mcs_hist + PDSCH_BLER_MCS_BINS);
+    s.sums = PdschBlerWindow();
+    s.window = -1;
+}
+
+void
+pdsch_bler_on_tb (int carrier, int rnti_type, int harq_id, int tb_idx, int ndi,
+                  bool crc_pass, int tb_bytes, int mcs, int sys_fn, int sub_fn) {
+    if (!LtePdschBlerEngine.enabled)
+        return;
+    PdschBlerCarrier &s = g_carriers[carrier];
+    long long t = lte_sys_clock_to_unix_ms(&s.clock, lte_sys_time(sys_fn, sub_fn));
+    long long window = t / g_granularity_ms;
+    // A late transport block is added to the window in progress
+    if (window > s.window) {
+        close_window(s);
+        s.window = window;
+    }
+    PdschBlerWindow &w = s.sums;
+    if (mcs >= 0 && mcs < PDSCH_BLER_MCS_BINS)
+        w.mcs_hist[mcs]++;
+    if (!crc_pass)
+        w.crc_failures++;
+    if (!is_harq_rnti_type(rnti_type)) {
+        // Broadcast blocks share HARQ IDs, and each one is new
+        w.new_tbs++;
+        if (crc_pass)
+            w.goodput_bytes += tb_bytes;
+        else
+            w.first_tx_failures++;
+        return;
+    }
+    PdschBlerHarq &h = s.harq[harq_id % PDSCH_BLER_HARQ_IDS][tb_idx % PDSCH_BLER_TB_IDXS];
+    // A C-RNTI block after a Temporary C-RNTI one is new whatever its NDI
+    if (!h.valid || h.rnti_type != rnti_type || h.ndi != ndi) {
+        if (h.valid && h.failed)
+            w.residual_failures++;
+        w.new_tbs++;
+        if (!crc_pass)
+            w.first_tx_failures++;
+        h.valid = true;
+        h.rnti_type = rnti_type;
+        h.ndi = ndi;
+        h.failed = true;
+    } else {
+        w.retx_tbs++;
+    }
+    if (crc_pass && h.failed) {
+        w.goodput_bytes += tb_bytes;
+        h.failed = false;
+    }
+}
+
+bool
+pdsch_bler_skip_records () {
+    return LtePdschBlerEngine.enabled && !g_records;
+}
+
+static bool
+lte_pdsch_bler_configure (PyObject *options) {
+    double granularity = PDSCH_BLER_DEFAULT_GRANULARITY;
+    bool records = true;
+    if (!analysis_get_double_option(options, "granularity", &granularity)
+            || !analysis_get_bool_option(options, "records", &records))
+        return false;
+    if (!(granularity >= PDSCH_BLER_MIN_GRANULARITY)) {
+        PyErr_SetString(PyExc_ValueError, "granularity must be at least 0.001");
+        return false;
+    }
+    g_carriers.clear();
+    g_granularity_ms = (long long) llround(granularity * 1000);
+    g_records = records;
+    return true;
+}
+
+static PyObject *
+build_columns (const PdschBlerColumns &c) {
+    return Py_BuildValue("{s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N}",
+                         "time", analysis_make_column(c.time, "d"),
+                         "new_tbs", analysis_make_column(c.new_tbs, "I"),
+                         "retx_tbs", analysis_make_column(c.retx_tbs, "I"),
+                         "first_tx_failures", analysis_make_column(c.first_tx_failures, "I"),
+                         "crc_failures", analysis_make_column(c.crc_failures, "I"),
+                         "residual_failures", analysis_make_column(c.residual_failures, "I"),
+                         "bler", analysis_make_column(c.bler, "d"),
+                         "goodput_bytes", analysis_make_column(c.goodput_bytes, "Q"),
+                         "mcs_hist", analysis_make_column(c.mcs_hist, "I"));
+}
+
+static PyObject *
+lte_pdsch_bler_collect () {
+    PyObject *series = PyDict_New();
+    for (PdschBlerCarrierMap::iterator it = g_carriers.begin(); it != g_carriers.end(); ++it) {
+        close_window(it->second);
+        if (it->second.columns.time.empty())
+            continue;
+        PyObject *key = PyLong_FromLong(it->first);
+        PyObject *columns = build_columns(it->second.columns);
+        PyDict_SetItem(series, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        it->second.columns = PdschBlerColumns();
+    }
+    return Py_BuildValue("{s:d,s:N}",
+                         "granularity", g_granularity_ms / 1000.0,
+                         "series", series);
+}
+
+AnalysisEngine LtePdschBlerEngine = {
+    "lte_pdsch_bler",
+    false,
+    lte_pdsch_bler_configure,
+    lte_pdsch_bler_collect,
+};
@@ -0,0 +1,57 @@
+/* lte_pdsch_bler.h
+ * Analysis engine "lte_pdsch_bler": computes the BLER, MCS distribution and
+ * goodput of the PDSCH of every serving cell from
+ * LTE_PHY_PDSCH_Stat_Indication.
+ *
+ * Transport blocks of the C-RNTI, SPS C-RNTI and Temporary C-RNTI are followed
+ * per (Serving Cell Index, HARQ ID, TB Index). A block whose NDI toggled, or
+ * the first one of a HARQ process or of its RNTI Type, is a new transmission,
+ * and a block with the same NDI a retransmission. When a new transmission
+ * replaces a block that never passed its CRC, that block counts as a
+ * residual failure. Blocks of other RNTI Types (SI, P and RA-RNTI) are all
+ * new transmissions. Blocks are timed by their SFN and subframe, placed
+ * on the Unix time with a LteSysClock, and summed over fixed time windows.
+ * Series are keyed by the Serving Cell Index, with the columns (memoryviews
+ * of copies of the series, which numpy.asarray() takes without copying again)
+ *     time (d): start of the window, in seconds since the Unix epoch
+ *     new_tbs (I), retx_tbs (I): new transmissions and retransmissions
+ *     first_tx_failures (I): new transmissions that failed their CRC
+ *     crc_failures (I): transmissions that failed their CRC
+ *     residual_failures (I): blocks replaced before passing their CRC
+ *     bler (d): first_tx_failures / new_tbs, or 0 without new transmissions
+ *     goodput_bytes (Q): TB Size of the blocks that passed their CRC, once
+ *                        per block
+ *     mcs_hist (I): PDSCH_BLER_MCS_BINS counts per row, of the MCS of every
+ *                   transmission; numpy.asarray(c).reshape(-1, 32)
+ * with a row per window that has transport blocks. The window in progress is
+ * closed by collect_engine().
+ *
+ * Options:
+ *     granularity: seconds per window, at least 0.001. Default 1.0
+ *     records:     keep the "Records" of the decoded packets. With False,
+ *                  transport blocks are read without building their Python
+ *                  objects, and packets only have "Version" and
+ *                  "Num Records". Default True
+ *
+ * collect_engine() returns
+ *     {"granularity": seconds,
+ *      "series": {serving_cell_index: {column: memoryview}}}
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_PDSCH_BLER_H__
+#define __DM_COLLECTOR_C_LTE_PDSCH_BLER_H__
+
+#include "analysis_engine.h"
+
+#define PDSCH_BLER_MCS_BINS 32
+
+extern AnalysisEngine LtePdschBlerEngine;
+
+// A transport block of a PDSCH record. rnti_type as in RNTIType.
+void pdsch_bler_on_tb (int carrier, int rnti_type, int harq_id, int tb_idx, int ndi,
+                       bool crc_pass, int tb_bytes, int mcs, int sys_fn, int sub_fn);
+
+// Return: whether the decoder should leave out the records
+bool pdsch_bler_skip_records ();
+
+#endif // __DM_COLLECTOR_C_LTE_PDSCH_BLER_H__
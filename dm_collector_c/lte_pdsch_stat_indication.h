@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_pdsch_bler.h"
 
 const Fmt LtePdschStatIndication_Fmt [] = {
     {UINT, "Version", 1},
@@ -386,11 +387,125 @@ const Fmt LtePdschStatIndication_Record_v34_P2 [] = {
     {UINT, "Area ID", 1},
 }; 
 
+// Layout of a version, to read transport blocks without the result lists
+struct LtePdschStatIndicationLayout {
+    int version;
+    const Fmt *payload;
+    int n_payload;
+    const Fmt *record_p1;
+    int n_record_p1;
+    const Fmt *tb;
+    int n_tb;
+    int single_tb_skip; // Bytes after the transport block of a record with one
+    const Fmt *record_p2;
+    int n_record_p2;
+};
+
+#define LTE_PDSCH_STAT_INDICATION_LAYOUT(ver, skip) \
+    {ver, \
+     LtePdschStatIndication_Payload_v##ver, \
+     ARRAY_SIZE(LtePdschStatIndication_Payload_v##ver, Fmt), \
+     LtePdschStatIndication_Record_v##ver##_P1, \
+     ARRAY_SIZE(LtePdschStatIndication_Record_v##ver##_P1, Fmt), \
+     LtePdschStatIndication_Record_TB_v##ver, \
+     ARRAY_SIZE(LtePdschStatIndication_Record_TB_v##ver, Fmt), \
+     skip, \
+     LtePdschStatIndication_Record_v##ver##_P2, \
+     ARRAY_SIZE(LtePdschStatIndication_Record_v##ver##_P2, Fmt)}
+
+const LtePdschStatIndicationLayout LtePdschStatIndication_Layouts [] = {
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(36, 12),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(32, 8),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(24, 8),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(16, 6),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(5, 6),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(37, 12),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(40, 12),
+    LTE_PDSCH_STAT_INDICATION_LAYOUT(34, 8),
+};
+
+#undef LTE_PDSCH_STAT_INDICATION_LAYOUT
+
+// Feed the transport blocks of a payload to the "lte_pdsch_bler" engine. If
+// result is not NULL, the fields before the records are then decoded into it.
+// Return: bytes of the payload, or -1 for an unknown version or a short payload
+static int _feed_lte_pdsch_stat_indication_tbs (const char *b,
+        int offset, size_t length, int pkt_ver, PyObject *result) {
+    const LtePdschStatIndicationLayout *l = NULL;
+    for (size_t i = 0;
+            i < ARRAY_SIZE(LtePdschStatIndication_Layouts, LtePdschStatIndicationLayout);
+            i++) {
+        if (LtePdschStatIndication_Layouts[i].version == pkt_ver)
+            l = &LtePdschStatIndication_Layouts[i];
+    }
+    if (l == NULL)
+        return -1;
+    int start = offset;
+    int payload_size = _fmt_offset(l->payload, l->n_payload, NULL);
+    int p1_size = _fmt_offset(l->record_p1, l->n_record_p1, NULL);
+    int tb_size = _fmt_offset(l->tb, l->n_tb, NULL);
+    int p2_size = _fmt_offset(l->record_p2, l->n_record_p2, NULL);
+    int num_records_at = _fmt_offset(l->payload, l->n_payload, "Num Records");
+    int subframe_at = _fmt_offset(l->record_p1, l->n_record_p1, "Subframe Num");
+    int num_tb_at = _fmt_offset(l->record_p1, l->n_record_p1,
+            "Num Transport Blocks Present");
+    int cell_at = _fmt_offset(l->record_p1, l->n_record_p1, "Serving Cell Index");
+    int harq_at = _fmt_offset(l->tb, l->n_tb, "HARQ ID");
+    int rnti_at = _fmt_offset(l->tb, l->n_tb, "RNTI Type");
+    int tbs_at = _fmt_offset(l->tb, l->n_tb, "TB Size");
+    int mcs_at = _fmt_offset(l->tb, l->n_tb, "MCS");
+
+    if (offset + payload_size > (int) length)
+        return -1;
+    int num_record = _read_uint_le(b + offset + num_records_at, 1);
+    offset += payload_size;
+    for (int i = 0; i < num_record; i++) {
+        if (offset + p1_size > (int) length)
+            return -1;
+        int iNonDecodeP1_1 = _read_uint_le(b + offset + subframe_at, 2);
+        int iSubFN = iNonDecodeP1_1 & 15;
+        int iFN = (iNonDecodeP1_1 >> 4) & 4095;
+        int num_TB = _read_uint_le(b + offset + num_tb_at, 1);
+        int iServCellIdx = _read_uint_le(b + offset + cell_at, 1) & 7;
+        offset += p1_size;
+        for (int j = 0; j < num_TB; j++) {
+            if (offset + tb_size > (int) length)
+                return -1;
+            int iNonDecodeP2_1 = _read_uint_le(b + offset + harq_at, 1);
+            int iHarqId = iNonDecodeP2_1 & 15;
+            int iNDI = (iNonDecodeP2_1 >> 6) & 1;
+            int iCrcResult = (iNonDecodeP2_1 >> 7) & 1;
+            int iNonDecodeP2_2 = _read_uint_le(b + offset + rnti_at, 1);
+            int iRNTI = iNonDecodeP2_2 & 15;
+            int iTbIdx = (iNonDecodeP2_2 >> 4) & 1;
+            pdsch_bler_on_tb(iServCellIdx, iRNTI, iHarqId, iTbIdx, iNDI, iCrcResult == 1,
+                    _read_uint_le(b + offset + tbs_at, 2),
+                    _read_uint_le(b + offset + mcs_at, 1), iFN, iSubFN);
+            offset += tb_size;
+        }
+        if (num_TB == 1) {
+            offset += l->single_tb_skip;
+        }
+        offset += p2_size;
+    }
+    if (result != NULL)
+        _decode_by_fmt(l->payload, l->n_payload, b, start, length, result);
+    return offset - start;
+}
+
 static int _decode_lte_pdsch_stat_indication_payload (const char *b,
         int offset, size_t length, PyObject *result) {
     int start = offset;
     int pkt_ver = _search_result_int(result, "Version");
 
+    if (LtePdschBlerEngine.enabled) {
+        bool skip_records = pdsch_bler_skip_records();
+        int n = _feed_lte_pdsch_stat_indication_tbs(b, offset, length, pkt_ver,
+                skip_records ? result : NULL);
+        if (n >= 0 && skip_records)
+            return n;
+    }
+
     switch (pkt_ver) {
     case 36:
         {
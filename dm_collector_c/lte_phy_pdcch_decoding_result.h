@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_pdcch_dci_stats.h"
 
 const Fmt LtePhyPdcchDecodingResult_Fmt [] = {
     {UINT, "Version", 1},
@@ -347,6 +348,12 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                 int iStartCCE = (iNonDecodeP3 >> 14) & 127;    // 7 bits
                 int iPayloadSize = (iNonDecodeP3 >> 21) & 255; // 8 bits
                 int iTailMatch = (iNonDecodeP3 >> 29) & 1; // 1 bit
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus,
+                            _search_result_uint(result_record_item, "Prune Status"),
+                            iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
@@ -475,6 +482,12 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                 int iStartCCE = (iNonDecodeP3 >> 16) & 127;    // 7 bits
                 int iPayloadSize = (iNonDecodeP3 >> 23) & 255; // 8 bits
                 int iTailMatch = (iNonDecodeP3 >> 31) & 1; // 1 bit
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus,
+                            _search_result_uint(result_record_item, "Prune Status"),
+                            iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
@@ -703,6 +716,10 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                         "Prune Status");
                 int iPruneStatus = temp & 2047; // 11 bits
                 int iEnergyMetric = temp >> 11; // the rest 21 bits
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus, iPruneStatus, iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
@@ -914,6 +931,10 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                             "Prune Status");
                     int iPruneStatus = temp & 2047; // 11 bits
                     int iEnergyMetric = temp >> 11; // the rest 21 bits
+                    if (LtePdcchDciStatsEngine.enabled) {
+                        pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                                iDCIFormat, iDecodeStatus, iPruneStatus, iSysFN, iSubFN);
+                    }
 
                     old_object = _replace_result_int(result_record_hypothesis_item,
                             "Aggregation Level", iAggLv);
@@ -1141,6 +1162,10 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                         "Prune Status");
                 int iPruneStatus = temp & 2047; // 11 bits
                 int iEnergyMetric = temp >> 11; // the rest 21 bits
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus, iPruneStatus, iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
@@ -1362,6 +1387,10 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                         "Prune Status");
                 int iPruneStatus = temp & 2047; // 11 bits
                 int iEnergyMetric = temp >> 11; // the rest 21 bits
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus, iPruneStatus, iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
@@ -1586,6 +1615,10 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                         "Prune Status");
                 int iPruneStatus = temp & 2047; // 11 bits
                 int iEnergyMetric = temp >> 11; // the rest 21 bits
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus, iPruneStatus, iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
@@ -1808,6 +1841,10 @@ static int _decode_lte_phy_pdcch_decoding_result_payload (const char *b,
                         "Prune Status");
                 int iPruneStatus = temp & 0xff; // 8 bits
                 int iEnergyMetric = (temp >> 8) & 0x1fffff; // the rest 21 bits
+                if (LtePdcchDciStatsEngine.enabled) {
+                    pdcch_dci_stats_on_hypothesis(iCarrierIndex, iAggLv, iSearchSpaceType,
+                            iDCIFormat, iDecodeStatus, iPruneStatus, iSysFN, iSubFN);
+                }
 
                 old_object = _replace_result_int(result_record_item,
                         "Aggregation Level", iAggLv);
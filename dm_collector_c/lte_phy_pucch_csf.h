@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_csf_stats.h"
 
 const Fmt LtePhyPucchCsf_Fmt [] = {
     {UINT, "Version", 1},
@@ -232,6 +233,12 @@ static int _decode_lte_phy_pucch_csf_payload (const char *b,
                     ARRAY_SIZE(ValueNameCarrierIndex, ValueName),
                     "(MI)Unknown");
 
+            // Type 3 reports carry the RI alone
+            bool bCqiReport = (iPucchReportType != 2);
+            csf_stats_on_report(CSF_STATS_PUCCH, iCarrierIndex, iRankIndex,
+                    bCqiReport ? iCQI0 : -1, bCqiReport ? iCQI1 : -1,
+                    bCqiReport ? iWidebandPMI : -1, -1, iSysFN, iSubFN);
+
             return offset - start;
         }
     case 24:
@@ -341,6 +348,13 @@ static int _decode_lte_phy_pucch_csf_payload (const char *b,
                     iPti);
             Py_DECREF(old_object);
 
+            // Type 3 reports carry the RI alone, Type 1 the CQI of a subband
+            bool bCqiReport = (iPucchReportType != 3);
+            csf_stats_on_report(CSF_STATS_PUCCH, iCarrierIndex, iRankIndex,
+                    bCqiReport ? iCQI0 : -1, bCqiReport ? iCQI1 : -1,
+                    bCqiReport ? iWidebandPMI : -1,
+                    iPucchReportType == 1 ? iSubBandLabel : -1, iSysFN, iSubFN);
+
             return offset - start;
         }
     case 43:
@@ -417,6 +431,12 @@ static int _decode_lte_phy_pucch_csf_payload (const char *b,
                     ValueNameCarrierIndex,
                     ARRAY_SIZE(ValueNameCarrierIndex, ValueName),
                     "(MI)Unknown");
+            // Type 3 reports carry the RI alone
+            bool bCqiReport = (iPucchReportType != 3);
+            csf_stats_on_report(CSF_STATS_PUCCH, iCarrierIndex, iRankIndex,
+                    bCqiReport ? iCQI0 : -1, bCqiReport ? iCQI1 : -1,
+                    bCqiReport ? iWidebandPMI : -1, -1, iSysFN, iSubFN);
+
             return offset - start;
         }
     case 101:
@@ -512,6 +532,12 @@ static int _decode_lte_phy_pucch_csf_payload (const char *b,
                     ValueNameCarrierIndex,
                     ARRAY_SIZE(ValueNameCarrierIndex, ValueName),
                     "(MI)Unknown");
+            // Type 3 reports carry the RI alone
+            bool bCqiReport = (iPucchReportType != 3);
+            csf_stats_on_report(CSF_STATS_PUCCH, iCarrierIndex, iRankIndex,
+                    bCqiReport ? iCQI0 : -1, bCqiReport ? iCQI1 : -1,
+                    bCqiReport ? iWidebandPMI : -1, -1, iSysFN, iSubFN);
+
             return offset - start;
         }
     case 103:
@@ -617,6 +643,12 @@ static int _decode_lte_phy_pucch_csf_payload (const char *b,
                     ValueNameCsiMeasSetIndex,
                     ARRAY_SIZE(ValueNameCsiMeasSetIndex, ValueName),
                     "(MI)Unknown");
+            // Type 3 reports carry the RI alone
+            bool bCqiReport = (iPucchReportType != 3);
+            csf_stats_on_report(CSF_STATS_PUCCH, iCarrierIndex, iRankIndex,
+                    bCqiReport ? iCQI0 : -1, bCqiReport ? iCQI1 : -1,
+                    bCqiReport ? iWidebandPMI : -1, -1, iSysFN, iSubFN);
+
             return offset - start;
         }
     case 142:
@@ -766,6 +798,13 @@ static int _decode_lte_phy_pucch_csf_payload (const char *b,
                     "UL Payload Length", iULPayloadLength);
             Py_DECREF(old_object);
 
+            // Type 3 reports carry the RI alone, Type 1 the CQI of a subband
+            bool bCqiReport = (iPucchReportType != 3);
+            csf_stats_on_report(CSF_STATS_PUCCH, iCarrierIndex, iRankIndex,
+                    bCqiReport ? iCQI0 : -1, bCqiReport ? iCQI1 : -1,
+                    bCqiReport ? iWidebandPMI : -1,
+                    iPucchReportType == 1 ? iSubBandLabel : -1, iSysFN, iSubFN);
+
             return offset - start;
         }
     default:
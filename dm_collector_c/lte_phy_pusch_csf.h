@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_csf_stats.h"
 
 const Fmt LtePhyPuschCsf_Fmt [] = {
     {UINT, "Version", 1},
@@ -267,6 +268,17 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
             //old_object = _replace_result_int(result_pdcch_item, "Reserved5",iresulttemp);
             //Py_DECREF(old_object);
 
+            if (LteCsfStatsEngine.enabled) {
+                csf_stats_on_report(CSF_STATS_PUSCH,
+                        _search_result_int(result, "Carrier Index"),
+                        _search_result_int(result, "Rank Index"),
+                        _search_result_int(result, "WideBand CQI CW0"),
+                        _search_result_int(result, "WideBand CQI CW1"),
+                        _search_result_int(result, "Single WB PMI"), -1,
+                        _search_result_int(result, "Start System Frame Number"),
+                        _search_result_int(result, "Start System Sub-frame Number"));
+            }
+
             (void) _map_result_field_to_name(result, "Carrier Index",
                     ValueNameCarrierIndex,
                     ARRAY_SIZE(ValueNameCarrierIndex, ValueName),
@@ -373,6 +385,10 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
                     ARRAY_SIZE(ValueNameCarrierIndex, ValueName),
                     "(MI)Unknown");
 
+            csf_stats_on_report(CSF_STATS_PUSCH, iCarrierIndex, iRankIndex,
+                    iWideBandCQICW0, iWideBandCQICW1, iSingleWBPMI, -1,
+                    iSysFN, iSubFN);
+
             return offset - start;
         }
 
@@ -464,6 +480,10 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
                     iNumCSIrsPorts);
             Py_DECREF(old_object);
 
+            csf_stats_on_report(CSF_STATS_PUSCH, iCarrierIndex, iRankIndex,
+                    iWideBandCQICW0, iWideBandCQICW1, iSingleWBPMI, -1,
+                    iSysFN, iSubFN);
+
             return offset - start;
         }
 
@@ -555,6 +575,10 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
                     iNumCSIrsPorts);
             Py_DECREF(old_object);
 
+            csf_stats_on_report(CSF_STATS_PUSCH, iCarrierIndex, iRankIndex,
+                    iWideBandCQICW0, iWideBandCQICW1, iSingleWBPMI, -1,
+                    iSysFN, iSubFN);
+
             return offset - start;
         }
 
@@ -638,6 +662,10 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
                     iNumCSIrsPorts);
             Py_DECREF(old_object);
 
+            csf_stats_on_report(CSF_STATS_PUSCH, iCarrierIndex, iRankIndex,
+                    iWideBandCQICW0, iWideBandCQICW1, iSingleWBPMI, -1,
+                    iSysFN, iSubFN);
+
             return offset - start;
         }
 
@@ -716,6 +744,10 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
                     ARRAY_SIZE(ValueNameCarrierIndex, ValueName),
                     "(MI)Unknown");
 
+            csf_stats_on_report(CSF_STATS_PUSCH, iCarrierIndex, iRankIndex,
+                    iWideBandCQICW0, iWideBandCQICW1, iSingleWBPMI, -1,
+                    iSysFN, iSubFN);
+
             return offset - start;
         }
 
@@ -788,6 +820,17 @@ static int _decode_lte_phy_pusch_csf_payload (const char *b,
             old_object = _replace_result_int(result, "Num Csirs Ports",iresulttemp);
             Py_DECREF(old_object);
 
+            if (LteCsfStatsEngine.enabled) {
+                csf_stats_on_report(CSF_STATS_PUSCH,
+                        _search_result_int(result, "Carrier Index"),
+                        _search_result_int(result, "Rank Index"),
+                        _search_result_int(result, "WideBand CQI CW0"),
+                        _search_result_int(result, "WideBand CQI CW1"),
+                        _search_result_int(result, "Single WB PMI"), -1,
+                        _search_result_int(result, "Start System Frame Number"),
+                        _search_result_int(result, "Start System Sub-frame Number"));
+            }
+
             (void) _map_result_field_to_name(result, "PUSCH Reporting Mode",
                     ValueNamePuschReportingMode,
                     ARRAY_SIZE(ValueNamePuschReportingMode, ValueName),
@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "lte_pusch_tx_columns.h"
 
 const Fmt LtePhyPuschTxReport_Fmt [] = {
     {UINT, "Version", 1},
@@ -527,6 +528,383 @@ const Fmt LtePhyPuschTxReport_Record_v145 [] = {
 };
 
 
+// A column read from a record: bits [shift, shift + bits) of the UINT field,
+// plus bias
+struct LtePhyPuschTxReportField {
+    int column;     // PuschTxColumn
+    const char *field;
+    int shift;
+    int bits;
+    int bias;
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v23 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate Data", 0, 16, 0},
+    {PUSCH_TX_ACK, "ACK", 0, 1, 0},
+    {PUSCH_TX_CQI, "ACK", 1, 1, 0},
+    {PUSCH_TX_RI, "ACK", 2, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "ACK", 3, 2, 0},
+    {PUSCH_TX_REDUND_VER, "ACK", 5, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "ACK", 7, 2, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "ACK", 9, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "ACK", 13, 4, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT0, "ACK", 17, 11, 0},
+    {PUSCH_TX_UE_SRS, "ACK", 28, 1, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT1, "DMRS Root Slot 1", 0, 11, 0},
+    {PUSCH_TX_START_RB_SLOT0, "DMRS Root Slot 1", 11, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "DMRS Root Slot 1", 18, 7, 0},
+    {PUSCH_TX_NUM_RB, "DMRS Root Slot 1", 25, 7, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_NUM_ACK_BITS, "Num ACK Bits", 0, 3, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 11, 0},
+    {PUSCH_TX_NUM_RI_BITS, "Rate Matched ACK Bits", 11, 2, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "Rate Matched ACK Bits", 15, 11, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "Rate Matched ACK Bits", 26, 2, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "PUSCH Digital Gain (dB)", 0, 8, 0},
+    {PUSCH_TX_SRS_OCCASION, "SRS Occasion", 0, 1, 0},
+    {PUSCH_TX_RETX_INDEX, "SRS Occasion", 1, 5, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 10, 0},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 10, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 18, 14, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v26 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate Data", 0, 16, 0},
+    {PUSCH_TX_ACK, "ACK", 0, 1, 0},
+    {PUSCH_TX_CQI, "ACK", 1, 1, 0},
+    {PUSCH_TX_RI, "ACK", 2, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "ACK", 3, 2, 0},
+    {PUSCH_TX_REDUND_VER, "ACK", 5, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "ACK", 7, 2, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "ACK", 9, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "ACK", 13, 4, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT0, "ACK", 17, 11, 0},
+    {PUSCH_TX_UE_SRS, "ACK", 28, 1, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT1, "DMRS Root Slot 1", 0, 11, 0},
+    {PUSCH_TX_START_RB_SLOT0, "DMRS Root Slot 1", 11, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "DMRS Root Slot 1", 18, 7, 0},
+    {PUSCH_TX_NUM_RB, "DMRS Root Slot 1", 25, 7, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_NUM_ACK_BITS, "Num ACK Bits", 0, 3, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 11, 0},
+    {PUSCH_TX_NUM_RI_BITS, "Rate Matched ACK Bits", 11, 2, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "Rate Matched ACK Bits", 15, 11, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "Rate Matched ACK Bits", 26, 2, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "PUSCH Digital Gain (dB)", 0, 8, 0},
+    {PUSCH_TX_SRS_OCCASION, "SRS Occasion", 0, 1, 0},
+    {PUSCH_TX_RETX_INDEX, "SRS Occasion", 1, 5, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 10, 0},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 10, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 18, 14, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+    {PUSCH_TX_NUM_REPETITION, "Num Repetition", 0, 12, 0},
+    {PUSCH_TX_RB_NB_START_INDEX, "Num Repetition", 12, 8, 0},
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v43 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate Data", 0, 16, 0},
+    {PUSCH_TX_ACK, "ACK", 0, 1, 0},
+    {PUSCH_TX_CQI, "ACK", 1, 1, 0},
+    {PUSCH_TX_RI, "ACK", 2, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "ACK", 3, 2, 0},
+    {PUSCH_TX_REDUND_VER, "ACK", 5, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "ACK", 7, 2, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "ACK", 9, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "ACK", 13, 4, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT0, "ACK", 17, 11, 0},
+    {PUSCH_TX_UE_SRS, "ACK", 28, 1, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT1, "DMRS Root Slot 1", 0, 11, 0},
+    {PUSCH_TX_START_RB_SLOT0, "DMRS Root Slot 1", 11, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "DMRS Root Slot 1", 18, 7, 0},
+    {PUSCH_TX_NUM_RB, "DMRS Root Slot 1", 25, 7, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 16, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH0, "ACK Payload", 20, 4, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH1, "ACK Payload", 24, 4, 0},
+    {PUSCH_TX_NUM_RI_BITS, "ACK Payload", 29, 3, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "RI Payload", 4, 11, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "RI Payload", 15, 2, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "RI Payload", 17, 8, 0},
+    {PUSCH_TX_SRS_OCCASION, "RI Payload", 25, 1, 0},
+    {PUSCH_TX_RETX_INDEX, "RI Payload", 26, 3, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 7, 0},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 7, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 15, 16, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v102 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_UL_CARRIER_INDEX, "Carrier Index", 0, 2, 0},
+    {PUSCH_TX_ACK, "Carrier Index", 2, 1, 0},
+    {PUSCH_TX_CQI, "Carrier Index", 3, 1, 0},
+    {PUSCH_TX_RI, "Carrier Index", 4, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "Carrier Index", 5, 2, 0},
+    {PUSCH_TX_RETX_INDEX, "Carrier Index", 7, 5, 0},
+    {PUSCH_TX_REDUND_VER, "Carrier Index", 12, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "Carrier Index", 14, 2, 0},
+    {PUSCH_TX_RESOURCE_ALLOCATION_TYPE, "Resource Allocation Type", 0, 1, 0},
+    {PUSCH_TX_START_RB_SLOT0, "Resource Allocation Type", 1, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "Resource Allocation Type", 8, 7, 0},
+    {PUSCH_TX_NUM_RB, "Resource Allocation Type", 15, 7, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate", 0, 16, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 14, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "Rate Matched ACK Bits", 18, 11, 0},
+    {PUSCH_TX_UE_SRS, "Rate Matched ACK Bits", 29, 1, 0},
+    {PUSCH_TX_SRS_OCCASION, "Rate Matched ACK Bits", 30, 1, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH0, "ACK Payload", 20, 4, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH1, "ACK Payload", 24, 4, 0},
+    {PUSCH_TX_NUM_RI_BITS, "ACK Payload", 28, 3, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "PUSCH Mod Order", 0, 2, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "PUSCH Mod Order", 2, 8, 0},
+    {PUSCH_TX_START_RB_CLUSTER1, "PUSCH Mod Order", 10, 8, 0},
+    {PUSCH_TX_NUM_RB_CLUSTER1, "PUSCH Mod Order", 18, 6, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 7, -128},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 7, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 15, 16, 0},
+    {PUSCH_TX_NUM_DL_CARRIERS, "Num DL Carriers", 0, 2, 0},
+    {PUSCH_TX_ACK_NACK_INDEX, "Num DL Carriers", 2, 12, 0},
+    {PUSCH_TX_ACK_NACK_LATE, "Num DL Carriers", 14, 1, 0},
+    {PUSCH_TX_CSF_LATE, "Num DL Carriers", 15, 1, 0},
+    {PUSCH_TX_DROP_PUSCH, "Num DL Carriers", 16, 1, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 0, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 4, 4, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 8, 11, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 19, 11, 0},
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v122 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_UL_CARRIER_INDEX, "UL Carrier Index", 0, 2, 0},
+    {PUSCH_TX_ACK, "UL Carrier Index", 2, 1, 0},
+    {PUSCH_TX_CQI, "UL Carrier Index", 3, 1, 0},
+    {PUSCH_TX_RI, "UL Carrier Index", 4, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "UL Carrier Index", 5, 2, 0},
+    {PUSCH_TX_RETX_INDEX, "UL Carrier Index", 7, 5, 0},
+    {PUSCH_TX_REDUND_VER, "UL Carrier Index", 12, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "UL Carrier Index", 14, 2, 0},
+    {PUSCH_TX_START_RB_SLOT0, "Start RB Slot 0", 0, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "Start RB Slot 0", 7, 7, 0},
+    {PUSCH_TX_NUM_RB, "Start RB Slot 0", 14, 7, 0},
+    {PUSCH_TX_DL_CARRIER_INDEX, "Start RB Slot 0", 21, 3, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate", 0, 16, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 14, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "Rate Matched ACK Bits", 19, 11, 0},
+    {PUSCH_TX_UE_SRS, "Rate Matched ACK Bits", 29, 1, 0},
+    {PUSCH_TX_SRS_OCCASION, "Rate Matched ACK Bits", 30, 1, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH0, "ACK Payload", 20, 4, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH1, "ACK Payload", 24, 4, 0},
+    {PUSCH_TX_NUM_RI_BITS, "ACK Payload", 28, 3, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "PUSCH Mod Order", 0, 2, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "PUSCH Mod Order", 2, 8, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 7, 0},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 7, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 18, 14, 0},
+    {PUSCH_TX_NUM_DL_CARRIERS, "Num DL Carriers", 0, 2, 0},
+    {PUSCH_TX_ACK_NACK_INDEX, "Num DL Carriers", 2, 12, 0},
+    {PUSCH_TX_ACK_NACK_LATE, "Num DL Carriers", 14, 1, 0},
+    {PUSCH_TX_CSF_LATE, "Num DL Carriers", 15, 1, 0},
+    {PUSCH_TX_DROP_PUSCH, "Num DL Carriers", 16, 1, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 0, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 4, 4, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 8, 11, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 19, 11, 0},
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v124 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_UL_CARRIER_INDEX, "UL Carrier Index", 0, 2, 0},
+    {PUSCH_TX_ACK, "UL Carrier Index", 2, 1, 0},
+    {PUSCH_TX_CQI, "UL Carrier Index", 3, 1, 0},
+    {PUSCH_TX_RI, "UL Carrier Index", 4, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "UL Carrier Index", 5, 2, 0},
+    {PUSCH_TX_RETX_INDEX, "UL Carrier Index", 7, 5, 0},
+    {PUSCH_TX_REDUND_VER, "UL Carrier Index", 12, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "UL Carrier Index", 14, 2, 0},
+    {PUSCH_TX_RESOURCE_ALLOCATION_TYPE, "Resource Allocation Type", 0, 1, 0},
+    {PUSCH_TX_START_RB_SLOT0, "Resource Allocation Type", 1, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "Resource Allocation Type", 8, 7, 0},
+    {PUSCH_TX_NUM_RB, "Resource Allocation Type", 15, 7, 0},
+    {PUSCH_TX_DL_CARRIER_INDEX, "Resource Allocation Type", 25, 2, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate", 0, 16, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 14, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "Rate Matched ACK Bits", 19, 11, 0},
+    {PUSCH_TX_UE_SRS, "Rate Matched ACK Bits", 29, 1, 0},
+    {PUSCH_TX_SRS_OCCASION, "Rate Matched ACK Bits", 30, 1, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH0, "ACK Payload", 20, 4, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH1, "ACK Payload", 24, 4, 0},
+    {PUSCH_TX_NUM_RI_BITS, "ACK Payload", 28, 3, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "PUSCH Mod Order", 0, 2, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "PUSCH Mod Order", 2, 8, 0},
+    {PUSCH_TX_START_RB_CLUSTER1, "PUSCH Mod Order", 10, 8, 0},
+    {PUSCH_TX_NUM_RB_CLUSTER1, "PUSCH Mod Order", 18, 6, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 7, 0},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 7, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 18, 14, 0},
+    {PUSCH_TX_NUM_DL_CARRIERS, "Num DL Carriers", 0, 2, 0},
+    {PUSCH_TX_ACK_NACK_INDEX, "Num DL Carriers", 2, 12, 0},
+    {PUSCH_TX_ACK_NACK_LATE, "Num DL Carriers", 14, 1, 0},
+    {PUSCH_TX_CSF_LATE, "Num DL Carriers", 15, 1, 0},
+    {PUSCH_TX_DROP_PUSCH, "Num DL Carriers", 16, 1, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 0, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 4, 4, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 8, 11, 0},
+    {PUSCH_TX_DMRS_ROOT_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 19, 11, 0},
+};
+
+const LtePhyPuschTxReportField LtePhyPuschTxReport_Fields_v144 [] = {
+    {PUSCH_TX_CURRENT_SFN_SF, "Current SFN SF", 0, 16, 0},
+    {PUSCH_TX_UL_CARRIER_INDEX, "UL Carrier Index", 0, 2, 0},
+    {PUSCH_TX_ACK, "UL Carrier Index", 2, 1, 0},
+    {PUSCH_TX_CQI, "UL Carrier Index", 3, 1, 0},
+    {PUSCH_TX_RI, "UL Carrier Index", 4, 1, 0},
+    {PUSCH_TX_FREQUENCY_HOPPING, "UL Carrier Index", 5, 2, 0},
+    {PUSCH_TX_RETX_INDEX, "UL Carrier Index", 7, 5, 0},
+    {PUSCH_TX_REDUND_VER, "UL Carrier Index", 12, 2, 0},
+    {PUSCH_TX_MIRROR_HOPPING, "UL Carrier Index", 14, 2, 0},
+    {PUSCH_TX_RESOURCE_ALLOCATION_TYPE, "Resource Allocation Type", 0, 1, 0},
+    {PUSCH_TX_START_RB_SLOT0, "Resource Allocation Type", 1, 7, 0},
+    {PUSCH_TX_START_RB_SLOT1, "Resource Allocation Type", 8, 7, 0},
+    {PUSCH_TX_NUM_RB, "Resource Allocation Type", 15, 7, 0},
+    {PUSCH_TX_DL_CARRIER_INDEX, "Resource Allocation Type", 22, 3, 0},
+    {PUSCH_TX_ENABLE_UL_DMRS_OCC, "Resource Allocation Type", 25, 1, 0},
+    {PUSCH_TX_PUSCH_TB_SIZE, "PUSCH TB Size", 0, 16, 0},
+    {PUSCH_TX_CODING_RATE, "Coding Rate", 0, 16, 0},
+    {PUSCH_TX_RATE_MATCHED_ACK_BITS, "Rate Matched ACK Bits", 0, 14, 0},
+    {PUSCH_TX_NUM_RI_BITS, "Rate Matched ACK Bits", 28, 4, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH0, "ACK/NAK Inp Length 0", 0, 7, 0},
+    {PUSCH_TX_ACK_NAK_INP_LENGTH1, "ACK/NAK Inp Length 0", 7, 7, 0},
+    {PUSCH_TX_RATE_MATCHED_RI_BITS, "ACK/NAK Inp Length 0", 14, 11, 0},
+    {PUSCH_TX_UE_SRS, "UE SRS", 0, 1, 0},
+    {PUSCH_TX_SRS_OCCASION, "UE SRS", 1, 1, 0},
+    {PUSCH_TX_PUSCH_MOD_ORDER, "UE SRS", 2, 3, 0},
+    {PUSCH_TX_PUSCH_DIGITAL_GAIN, "UE SRS", 5, 8, 0},
+    {PUSCH_TX_START_RB_CLUSTER1, "UE SRS", 13, 7, 0},
+    {PUSCH_TX_NUM_RB_CLUSTER1, "UE SRS", 20, 7, 0},
+    {PUSCH_TX_PUSCH_TX_POWER, "PUSCH Tx Power (dBm)", 0, 7, 0},
+    {PUSCH_TX_NUM_CQI_BITS, "PUSCH Tx Power (dBm)", 7, 8, 0},
+    {PUSCH_TX_RATE_MATCHED_CQI_BITS, "PUSCH Tx Power (dBm)", 18, 14, 0},
+    {PUSCH_TX_NUM_DL_CARRIERS, "Num DL Carriers", 0, 2, 0},
+    {PUSCH_TX_ACK_NACK_INDEX, "Num DL Carriers", 2, 12, 0},
+    {PUSCH_TX_ACK_NACK_LATE, "Num DL Carriers", 14, 1, 0},
+    {PUSCH_TX_CSF_LATE, "Num DL Carriers", 15, 1, 0},
+    {PUSCH_TX_DROP_PUSCH, "Num DL Carriers", 16, 1, 0},
+    {PUSCH_TX_TX_RESAMPLER, "Tx Resampler", 0, 32, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 0, 4, 0},
+    {PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1, "Cyclic Shift of DMRS Symbols Slot 0 (Samples)", 4, 4, 0},
+};
+
+// Layout of a version, to fill the "lte_pusch_tx_columns" engine without the
+// result lists
+struct LtePhyPuschTxReportLayout {
+    int version;
+    const Fmt *payload;
+    int n_payload;
+    const Fmt *record;
+    int n_record;
+    const LtePhyPuschTxReportField *fields;
+    int n_fields;
+};
+
+#define LTE_PHY_PUSCH_TX_REPORT_LAYOUT(ver, payload_ver, record_ver, fields_ver) \
+    {ver, \
+     LtePhyPuschTxReport_Payload_v##payload_ver, \
+     ARRAY_SIZE(LtePhyPuschTxReport_Payload_v##payload_ver, Fmt), \
+     LtePhyPuschTxReport_Record_v##record_ver, \
+     ARRAY_SIZE(LtePhyPuschTxReport_Record_v##record_ver, Fmt), \
+     LtePhyPuschTxReport_Fields_v##fields_ver, \
+     ARRAY_SIZE(LtePhyPuschTxReport_Fields_v##fields_ver, LtePhyPuschTxReportField)}
+
+// Versions 144 and 145 are decoded with the formats of 144
+const LtePhyPuschTxReportLayout LtePhyPuschTxReport_Layouts [] = {
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(23, 23, 23, 23),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(24, 24, 24, 23),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(26, 26, 26, 26),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(43, 43, 43, 43),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(102, 102, 102, 102),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(122, 102, 122, 122),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(124, 102, 124, 124),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(144, 144, 144, 144),
+    LTE_PHY_PUSCH_TX_REPORT_LAYOUT(145, 144, 144, 144),
+};
+
+#undef LTE_PHY_PUSCH_TX_REPORT_LAYOUT
+
+// Feed the records of a payload to the "lte_pusch_tx_columns" engine. If
+// result is not NULL, the fields before the records are then decoded into it.
+// Return: bytes of the payload, or -1 for an unknown version or a short payload
+static int _feed_lte_phy_pusch_tx_report_columns (const char *b,
+        int offset, size_t length, int pkt_ver, PyObject *result) {
+    const LtePhyPuschTxReportLayout *l = NULL;
+    for (size_t i = 0;
+            i < ARRAY_SIZE(LtePhyPuschTxReport_Layouts, LtePhyPuschTxReportLayout);
+            i++) {
+        if (LtePhyPuschTxReport_Layouts[i].version == pkt_ver)
+            l = &LtePhyPuschTxReport_Layouts[i];
+    }
+    if (l == NULL)
+        return -1;
+    int start = offset;
+    int payload_size = _fmt_offset(l->payload, l->n_payload, NULL);
+    int record_size = _fmt_offset(l->record, l->n_record, NULL);
+    int cell_at = _fmt_offset(l->payload, l->n_payload, "Serving Cell ID");
+    int dispatch_at = _fmt_offset(l->payload, l->n_payload, "Dispatch SFN SF");
+    int field_at[PUSCH_TX_NUM_COLUMNS];
+    int field_len[PUSCH_TX_NUM_COLUMNS];
+    for (int k = 0; k < l->n_fields; k++) {
+        field_at[k] = _fmt_offset(l->record, l->n_record, l->fields[k].field);
+        field_len[k] = 0;
+        for (int j = 0; j < l->n_record; j++) {
+            if (l->record[j].field_name != NULL
+                    && strcmp(l->record[j].field_name, l->fields[k].field) == 0)
+                field_len[k] = l->record[j].len;
+        }
+    }
+
+    if (offset + payload_size > (int) length)
+        return -1;
+    int iCell = _read_uint_le(b + offset + cell_at, 2);
+    int num_record = (iCell >> 9) & 31;
+    int iDispatchSFNSF = _read_uint_le(b + offset + dispatch_at, 2);
+    if (offset + payload_size + num_record * record_size > (int) length)
+        return -1;
+    offset += payload_size;
+    for (int i = 0; i < num_record; i++) {
+        long long values[PUSCH_TX_NUM_COLUMNS];
+        for (int k = 0; k < PUSCH_TX_NUM_COLUMNS; k++)
+            values[k] = PUSCH_TX_MISSING;
+        values[PUSCH_TX_SERVING_CELL_ID] = iCell & 511;
+        values[PUSCH_TX_DISPATCH_SFN_SF] = iDispatchSFNSF;
+        for (int k = 0; k < l->n_fields; k++) {
+            const LtePhyPuschTxReportField &f = l->fields[k];
+            unsigned int u_temp = _read_uint_le(b + offset + field_at[k], field_len[k]);
+            unsigned long long mask = (1ULL << f.bits) - 1;
+            values[f.column] = (long long) ((u_temp >> f.shift) & mask) + f.bias;
+        }
+        pusch_tx_columns_on_record(pkt_ver, values);
+        offset += record_size;
+    }
+    if (result != NULL) {
+        _decode_by_fmt(l->payload, l->n_payload, b, start, length, result);
+        PyObject *old_object = _replace_result_int(result, "Number of Records",
+                num_record);
+        Py_DECREF(old_object);
+        old_object = _replace_result_int(result, "Serving Cell ID", iCell & 511);
+        Py_DECREF(old_object);
+    }
+    return offset - start;
+}
+
 static int _decode_lte_phy_pusch_tx_report_payload (const char *b,
         int offset, size_t length, PyObject *result) {
     int start = offset;
@@ -538,6 +916,14 @@ static int _decode_lte_phy_pusch_tx_report_payload (const char *b,
     PyObject *pyfloat;
     PyObject *pystr;
 
+    if (LtePuschTxColumnsEngine.enabled) {
+        bool skip_records = pusch_tx_columns_skip_records();
+        int n = _feed_lte_phy_pusch_tx_report_columns(b, offset, length, pkt_ver,
+                skip_records ? result : NULL);
+        if (n >= 0 && skip_records)
+            return n;
+    }
+
     switch (pkt_ver) {
     case 23:
         {
@@ -1555,7 +1941,7 @@ static int _decode_lte_phy_pusch_tx_report_payload (const char *b,
                 u_temp = _search_result_uint(result_record_item,
                         "Num DL Carriers");
                 int iNumDLCarriers = u_temp & 3;    // 2 bits
-                int iAckNackIndex = (u_temp >> 2) & 4096;   // 12 bits
+                int iAckNackIndex = (u_temp >> 2) & 4095;   // 12 bits
                 int iAckNackLate = (u_temp >> 14) & 1;  // 1 bit
                 int iCSFLate = (u_temp >> 15) & 1;  // 1 bit
                 int iDropPusch = (u_temp >> 16) & 1;  // 1 bit
@@ -1820,7 +2206,7 @@ static int _decode_lte_phy_pusch_tx_report_payload (const char *b,
                 u_temp = _search_result_uint(result_record_item,
                         "Num DL Carriers");
                 int iNumDLCarriers = u_temp & 3;    // 2 bits
-                int iAckNackIndex = (u_temp >> 2) & 4096;   // 12 bits
+                int iAckNackIndex = (u_temp >> 2) & 4095;   // 12 bits
                 int iAckNackLate = (u_temp >> 14) & 1;  // 1 bit
                 int iCSFLate = (u_temp >> 15) & 1;  // 1 bit
                 int iDropPusch = (u_temp >> 16) & 1;  // 1 bit
@@ -2096,7 +2482,7 @@ static int _decode_lte_phy_pusch_tx_report_payload (const char *b,
                 u_temp = _search_result_uint(result_record_item,
                         "Num DL Carriers");
                 int iNumDLCarriers = u_temp & 3;    // 2 bits
-                int iAckNackIndex = (u_temp >> 2) & 4096;   // 12 bits
+                int iAckNackIndex = (u_temp >> 2) & 4095;   // 12 bits
                 int iAckNackLate = (u_temp >> 14) & 1;  // 1 bit
                 int iCSFLate = (u_temp >> 15) & 1;  // 1 bit
                 int iDropPusch = (u_temp >> 16) & 1;  // 1 bit
@@ -2372,7 +2758,7 @@ static int _decode_lte_phy_pusch_tx_report_payload (const char *b,
                 u_temp = _search_result_uint(result_record_item,
                         "Num DL Carriers");
                 int iNumDLCarriers = u_temp & 3;    // 2 bits
-                int iAckNackIndex = (u_temp >> 2) & 4096;   // 12 bits
+                int iAckNackIndex = (u_temp >> 2) & 4095;   // 12 bits
                 int iAckNackLate = (u_temp >> 14) & 1;  // 1 bit
                 int iCSFLate = (u_temp >> 15) & 1;  // 1 bit
                 int iDropPusch = (u_temp >> 16) & 1;  // 1 bit
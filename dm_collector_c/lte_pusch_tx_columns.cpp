@@ -0,0 +1,192 @@
+/* lte_pusch_tx_columns.cpp
+ * Implements the "lte_pusch_tx_columns" analysis engine.
+ */
+
+#include "lte_pusch_tx_columns.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#define PUSCH_TX_DEFAULT_MAX_ROWS 1000000
+
+struct PuschTxColumnDef {
+    const char *name;
+    char format;    // h, i, q or f
+};
+
+// Indexed by PuschTxColumn
+static const PuschTxColumnDef PuschTxColumnDefs[PUSCH_TX_NUM_COLUMNS] = {
+    {"serving_cell_id", 'h'},
+    {"dispatch_sfn_sf", 'i'},
+    {"current_sfn_sf", 'i'},
+    {"ul_carrier_index", 'h'},
+    {"dl_carrier_index", 'h'},
+    {"ack", 'h'},
+    {"cqi", 'h'},
+    {"ri", 'h'},
+    {"frequency_hopping", 'h'},
+    {"retx_index", 'h'},
+    {"redund_ver", 'h'},
+    {"mirror_hopping", 'h'},
+    {"resource_allocation_type", 'h'},
+    {"start_rb_slot0", 'h'},
+    {"start_rb_slot1", 'h'},
+    {"num_rb", 'h'},
+    {"start_rb_cluster1", 'h'},
+    {"num_rb_cluster1", 'h'},
+    {"enable_ul_dmrs_occ", 'h'},
+    {"pusch_tb_size", 'i'},
+    {"coding_rate", 'f'},
+    {"num_ack_bits", 'h'},
+    {"rate_matched_ack_bits", 'i'},
+    {"ack_nak_inp_length0", 'h'},
+    {"ack_nak_inp_length1", 'h'},
+    {"num_ri_bits", 'h'},
+    {"rate_matched_ri_bits", 'h'},
+    {"ue_srs", 'h'},
+    {"srs_occasion", 'h'},
+    {"pusch_mod_order", 'h'},
+    {"pusch_digital_gain", 'h'},
+    {"pusch_tx_power", 'h'},
+    {"num_cqi_bits", 'h'},
+    {"rate_matched_cqi_bits", 'i'},
+    {"num_dl_carriers", 'h'},
+    {"ack_nack_index", 'h'},
+    {"ack_nack_late", 'h'},
+    {"csf_late", 'h'},
+    {"drop_pusch", 'h'},
+    {"tx_resampler", 'q'},
+    {"cyclic_shift_dmrs_slot0", 'h'},
+    {"cyclic_shift_dmrs_slot1", 'h'},
+    {"dmrs_root_slot0", 'h'},
+    {"dmrs_root_slot1", 'h'},
+    {"num_repetition", 'h'},
+    {"rb_nb_start_index", 'h'},
+};
+
+static std::vector<double> g_time;
+static std::vector<short> g_version;
+// Raw items of the columns, in their formats
+static std::vector<char> g_columns[PUSCH_TX_NUM_COLUMNS];
+static size_t g_rows = 0;
+static unsigned long long g_dropped_rows = 0;
+static size_t g_max_rows = PUSCH_TX_DEFAULT_MAX_ROWS;
+static bool g_records = true;
+
+static size_t
+get_item_size (char format) {
+    switch (format) {
+    case 'h':
+        return sizeof(short);
+    case 'i':
+        return sizeof(int);
+    case 'q':
+        return sizeof(long long);
+    default:
+        return sizeof(float);
+    }
+}
+
+template <typename T>
+static void
+append_item (std::vector<char> &column, T item) {
+    const char *p = (const char *) &item;
+    column.insert(column.end(), p, p + sizeof(T));
+}
+
+void
+pusch_tx_columns_on_record (int version, const long long values[PUSCH_TX_NUM_COLUMNS]) {
+    if (!LtePuschTxColumnsEngine.enabled)
+        return;
+    if (g_rows >= g_max_rows) {
+        g_dropped_rows++;
+        return;
+    }
+    g_time.push_back(analysis_packet_time());
+    g_version.push_back((short) version);
+    for (int i = 0; i < PUSCH_TX_NUM_COLUMNS; i++) {
+        bool missing = (values[i] == PUSCH_TX_MISSING);
+        long long v = values[i];
+        // A missing field is the minimum of its format, which no field reaches
+        switch (PuschTxColumnDefs[i].format) {
+        case 'h':
+            append_item(g_columns[i], missing ? (short) SHRT_MIN : (short) v);
+            break;
+        case 'i':
+            append_item(g_columns[i], missing ? (int) INT_MIN : (int) v);
+            break;
+        case 'q':
+            append_item(g_columns[i], v);   // PUSCH_TX_MISSING is LLONG_MIN
+            break;
+        default:
+            // Only coding_rate is a float
+            append_item(g_columns[i], missing ? NAN : (float) (v / 1024.0));
+            break;
+        }
+    }
+    g_rows++;
+}
+
+bool
+pusch_tx_columns_skip_records () {
+    return LtePuschTxColumnsEngine.enabled && !g_records;
+}
+
+static void
+clear_rows () {
+    g_time.clear();
+    g_version.clear();
+    for (int i = 0; i < PUSCH_TX_NUM_COLUMNS; i++)
+        g_columns[i].clear();
+    g_rows = 0;
+    g_dropped_rows = 0;
+}
+
+static bool
+lte_pusch_tx_columns_configure (PyObject *options) {
+    bool records = true;
+    long long max_rows = PUSCH_TX_DEFAULT_MAX_ROWS;
+    if (!analysis_get_bool_option(options, "records", &records)
+            || !analysis_get_int_option(options, "max_rows", &max_rows))
+        return false;
+    if (max_rows < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_rows must not be negative");
+        return false;
+    }
+    clear_rows();
+    g_records = records;
+    g_max_rows = (size_t) max_rows;
+    return true;
+}
+
+static PyObject *
+lte_pusch_tx_columns_collect () {
+    PyObject *columns = PyDict_New();
+    // The columns take the rows, without copying them
+    PyObject *column = analysis_take_column(g_time, "d");
+    PyDict_SetItemString(columns, "time", column);
+    Py_DECREF(column);
+    column = analysis_take_column(g_version, "h");
+    PyDict_SetItemString(columns, "version", column);
+    Py_DECREF(column);
+    for (int i = 0; i < PUSCH_TX_NUM_COLUMNS; i++) {
+        char format[2] = {PuschTxColumnDefs[i].format, '\0'};
+        column = analysis_take_column(g_columns[i], format, get_item_size(format[0]));
+        PyDict_SetItemString(columns, PuschTxColumnDefs[i].name, column);
+        Py_DECREF(column);
+    }
+    PyObject *ret = Py_BuildValue("{s:N,s:K}",
+                                  "columns", columns,
+                                  "dropped_rows", g_dropped_rows);
+    clear_rows();
+    return ret;
+}
+
+AnalysisEngine LtePuschTxColumnsEngine = {
+    "lte_pusch_tx_columns",
+    false,
+    lte_pusch_tx_columns_configure,
+    lte_pusch_tx_columns_collect,
+};
@@ -0,0 +1,114 @@
+/* lte_pusch_tx_columns.h
+ * Analysis engine "lte_pusch_tx_columns": collects the records of
+ * LTE_PHY_PUSCH_Tx_Report as columns, a struct of arrays with one column per
+ * record field, filled by the C decoder.
+ *
+ * All versions share the columns below (memoryviews that take over the rows
+ * of the engine, so that no copy is made from the decoder to
+ * numpy.asarray(); numpy.rec.fromarrays() makes a structured array of
+ * them). Fields that the version of a record lacks are the minimum of their
+ * format (-2 ** 15 for h, -2 ** 31 for i, -2 ** 63 for q, that is
+ * numpy.iinfo(column.dtype).min), or NaN for coding_rate, so that they are
+ * told apart from negative values such as a Tx power of -1 dBm. Values are
+ * those of the "Records" of the decoded packets, except that the ACK, RI and
+ * CQI payloads are left out.
+ *     time (d): log packet time, in seconds since the Unix epoch
+ *     version (h), serving_cell_id (h), dispatch_sfn_sf (i)
+ *     current_sfn_sf (i), ul_carrier_index (h), dl_carrier_index (h)
+ *     ack (h), cqi (h), ri (h), frequency_hopping (h), retx_index (h),
+ *     redund_ver (h), mirror_hopping (h), resource_allocation_type (h)
+ *     start_rb_slot0 (h), start_rb_slot1 (h), num_rb (h),
+ *     start_rb_cluster1 (h), num_rb_cluster1 (h), enable_ul_dmrs_occ (h)
+ *     pusch_tb_size (i), coding_rate (f)
+ *     num_ack_bits (h), rate_matched_ack_bits (i), ack_nak_inp_length0 (h),
+ *     ack_nak_inp_length1 (h), num_ri_bits (h), rate_matched_ri_bits (h)
+ *     ue_srs (h), srs_occasion (h), pusch_mod_order (h),
+ *     pusch_digital_gain (h), pusch_tx_power (h): dBm
+ *     num_cqi_bits (h), rate_matched_cqi_bits (i)
+ *     num_dl_carriers (h), ack_nack_index (h), ack_nack_late (h),
+ *     csf_late (h), drop_pusch (h)
+ *     tx_resampler (q)
+ *     cyclic_shift_dmrs_slot0 (h), cyclic_shift_dmrs_slot1 (h),
+ *     dmrs_root_slot0 (h), dmrs_root_slot1 (h)
+ *     num_repetition (h), rb_nb_start_index (h)
+ *
+ * Options:
+ *     records:  keep the "Records" of the decoded packets. With False, only
+ *               the columns are filled. Default True
+ *     max_rows: rows kept between two collect_engine() calls; more are
+ *               counted as "dropped_rows". Default 1000000
+ *
+ * collect_engine() returns
+ *     {"columns": {column: memoryview}, "dropped_rows": n}
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_PUSCH_TX_COLUMNS_H__
+#define __DM_COLLECTOR_C_LTE_PUSCH_TX_COLUMNS_H__
+
+#include "analysis_engine.h"
+
+#include <climits>
+
+// Value of fields that a version lacks
+#define PUSCH_TX_MISSING LLONG_MIN
+
+// Columns filled by the decoder, after time and version
+enum PuschTxColumn {
+    PUSCH_TX_SERVING_CELL_ID,
+    PUSCH_TX_DISPATCH_SFN_SF,
+    PUSCH_TX_CURRENT_SFN_SF,
+    PUSCH_TX_UL_CARRIER_INDEX,
+    PUSCH_TX_DL_CARRIER_INDEX,
+    PUSCH_TX_ACK,
+    PUSCH_TX_CQI,
+    PUSCH_TX_RI,
+    PUSCH_TX_FREQUENCY_HOPPING,
+    PUSCH_TX_RETX_INDEX,
+    PUSCH_TX_REDUND_VER,
+    PUSCH_TX_MIRROR_HOPPING,
+    PUSCH_TX_RESOURCE_ALLOCATION_TYPE,
+    PUSCH_TX_START_RB_SLOT0,
+    PUSCH_TX_START_RB_SLOT1,
+    PUSCH_TX_NUM_RB,
+    PUSCH_TX_START_RB_CLUSTER1,
+    PUSCH_TX_NUM_RB_CLUSTER1,
+    PUSCH_TX_ENABLE_UL_DMRS_OCC,
+    PUSCH_TX_PUSCH_TB_SIZE,
+    PUSCH_TX_CODING_RATE,   // In 1/1024
+    PUSCH_TX_NUM_ACK_BITS,
+    PUSCH_TX_RATE_MATCHED_ACK_BITS,
+    PUSCH_TX_ACK_NAK_INP_LENGTH0,
+    PUSCH_TX_ACK_NAK_INP_LENGTH1,
+    PUSCH_TX_NUM_RI_BITS,
+    PUSCH_TX_RATE_MATCHED_RI_BITS,
+    PUSCH_TX_UE_SRS,
+    PUSCH_TX_SRS_OCCASION,
+    PUSCH_TX_PUSCH_MOD_ORDER,
+    PUSCH_TX_PUSCH_DIGITAL_GAIN,
+    PUSCH_TX_PUSCH_TX_POWER,
+    PUSCH_TX_NUM_CQI_BITS,
+    PUSCH_TX_RATE_MATCHED_CQI_BITS,
+    PUSCH_TX_NUM_DL_CARRIERS,
+    PUSCH_TX_ACK_NACK_INDEX,
+    PUSCH_TX_ACK_NACK_LATE,
+    PUSCH_TX_CSF_LATE,
+    PUSCH_TX_DROP_PUSCH,
+    PUSCH_TX_TX_RESAMPLER,
+    PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT0,
+    PUSCH_TX_CYCLIC_SHIFT_DMRS_SLOT1,
+    PUSCH_TX_DMRS_ROOT_SLOT0,
+    PUSCH_TX_DMRS_ROOT_SLOT1,
+    PUSCH_TX_NUM_REPETITION,
+    PUSCH_TX_RB_NB_START_INDEX,
+    PUSCH_TX_NUM_COLUMNS
+};
+
+extern AnalysisEngine LtePuschTxColumnsEngine;
+
+// A record, with values indexed by PuschTxColumn
+void pusch_tx_columns_on_record (int version, const long long values[PUSCH_TX_NUM_COLUMNS]);
+
+// Return: whether the decoder should leave out the records
+bool pusch_tx_columns_skip_records ();
+
+#endif // __DM_COLLECTOR_C_LTE_PUSCH_TX_COLUMNS_H__
@@ -0,0 +1,272 @@
+/* lte_rlc_tracker.cpp
+ * Implements the "lte_rlc_tracker" analysis engine.
+ */
+
+#include "lte_rlc_tracker.h"
+
+#include <map>
+#include <utility>
+
+#define RLC_SN_MODULUS 1024
+#define RLC_WINDOW_SIZE 512
+
+#define RLC_TRACKER_DEFAULT_MAX_EVENTS 100000
+
+enum RlcEventKind {
+    RLC_EVENT_RETX,
+    RLC_EVENT_HOLE_FILLED,
+    RLC_EVENT_HOLE_LOST,
+    RLC_EVENT_NACK,
+    RLC_EVENT_RESET,
+};
+
+static const char *RlcEventKindNames[] = {
+    "retx",
+    "hole_filled",
+    "hole_lost",
+    "nack",
+    "reset",
+};
+
+static const char *RlcDirectionNames[] = {
+    "UL",
+    "DL",
+};
+
+struct RlcEvent {
+    double time;
+    int kind;
+    int direction;
+    int rb_cfg_idx;
+    int sn;
+    int delay_ms;
+};
+
+struct RlcBearerCounters {
+    unsigned long long data_pdus;
+    unsigned long long data_bytes;
+    unsigned long long retx_pdus;
+    unsigned long long retx_bytes;
+    unsigned long long holes;
+    unsigned long long holes_filled;
+    unsigned long long holes_lost;
+    unsigned long long status_pdus;
+    unsigned long long nacks;
+    unsigned long long resets;
+};
+
+struct RlcBearerState {
+    int max_sn;     // -1 before the first data PDU
+    // System times in ms, or -1
+    int sent_time[RLC_SN_MODULUS];
+    int hole_time[RLC_SN_MODULUS];
+    int nack_time[RLC_SN_MODULUS];
+    RlcBearerCounters counters;
+
+    RlcBearerState () : counters() {
+        clear_sns();
+    }
+
+    void clear_sns () {
+        max_sn = -1;
+        for (int i = 0; i < RLC_SN_MODULUS; i++) {
+            sent_time[i] = -1;
+            hole_time[i] = -1;
+            nack_time[i] = -1;
+        }
+    }
+};
+
+// Keyed by (data direction, rb_cfg_idx)
+typedef std::map<std::pair<int, int>, RlcBearerState> RlcBearerMap;
+
+static RlcBearerMap g_bearers;
+static std::vector<RlcEvent> g_events;
+static unsigned long long g_dropped_events = 0;
+static size_t g_max_events = RLC_TRACKER_DEFAULT_MAX_EVENTS;
+
+static void
+add_event (int kind, int direction, int rb_cfg_idx, int sn, int delay_ms) {
+    if (g_events.size() >= g_max_events) {
+        g_dropped_events++;
+        return;
+    }
+    RlcEvent e = {analysis_packet_time(), kind, direction, rb_cfg_idx, sn, delay_ms};
+    g_events.push_back(e);
+}
+
+static RlcBearerState &
+get_bearer (int direction, int rb_cfg_idx) {
+    return g_bearers[std::make_pair(direction, rb_cfg_idx)];
+}
+
+void
+rlc_tracker_on_data (int direction, int rb_cfg_idx, int sn, bool rf, bool lsf,
+                     int pdu_bytes, int sys_fn, int sub_fn) {
+    if (!LteRlcTrackerEngine.enabled)
+        return;
+    RlcBearerState &s = get_bearer(direction, rb_cfg_idx);
+    int t = lte_sys_time(sys_fn, sub_fn);
+    sn %= RLC_SN_MODULUS;
+    s.counters.data_pdus++;
+    s.counters.data_bytes += pdu_bytes;
+    if (rf && !lsf)
+        return;
+
+    if (s.max_sn < 0) {
+        s.max_sn = sn;
+        s.sent_time[sn] = t;
+        return;
+    }
+    int ahead = (sn - s.max_sn + RLC_SN_MODULUS) % RLC_SN_MODULUS;
+    if (ahead > 0 && ahead < RLC_WINDOW_SIZE) {
+        // New SN. SNs in between are holes, and as many old SNs leave the window
+        for (int i = 1; i <= ahead; i++) {
+            int cur = (s.max_sn + i) % RLC_SN_MODULUS;
+            int old = (cur + RLC_WINDOW_SIZE) % RLC_SN_MODULUS;
+            if (s.hole_time[old] >= 0) {
+                s.counters.holes_lost++;
+                add_event(RLC_EVENT_HOLE_LOST, direction, rb_cfg_idx, old,
+                          lte_sys_time_diff(t, s.hole_time[old]));
+                s.hole_time[old] = -1;
+            }
+            s.sent_time[old] = -1;
+            s.nack_time[old] = -1;
+            s.nack_time[cur] = -1;
+            if (i < ahead) {
+                s.sent_time[cur] = -1;
+                s.hole_time[cur] = t;
+                s.counters.holes++;
+            } else {
+                s.sent_time[cur] = t;
+                s.hole_time[cur] = -1;
+            }
+        }
+        s.max_sn = sn;
+        return;
+    }
+
+    // An SN within the window: a skipped one arrives, or one is sent again
+    if (s.hole_time[sn] >= 0 && s.nack_time[sn] < 0) {
+        s.counters.holes_filled++;
+        add_event(RLC_EVENT_HOLE_FILLED, direction, rb_cfg_idx, sn,
+                  lte_sys_time_diff(t, s.hole_time[sn]));
+    } else if (s.hole_time[sn] >= 0 || s.sent_time[sn] >= 0 || rf) {
+        int since = s.nack_time[sn] >= 0 ? s.nack_time[sn] : s.sent_time[sn];
+        s.counters.retx_pdus++;
+        s.counters.retx_bytes += pdu_bytes;
+        add_event(RLC_EVENT_RETX, direction, rb_cfg_idx, sn,
+                  since >= 0 ? lte_sys_time_diff(t, since) : 0);
+    }
+    s.hole_time[sn] = -1;
+    s.nack_time[sn] = -1;
+    if (s.sent_time[sn] < 0)
+        s.sent_time[sn] = t;
+}
+
+void
+rlc_tracker_on_window (int direction, int rb_cfg_idx, int lower, int upper, int n_pdus) {
+    if (!LteRlcTrackerEngine.enabled)
+        return;
+    RlcBearerState &s = get_bearer(direction, rb_cfg_idx);
+    if (s.max_sn < 0 || n_pdus >= RLC_WINDOW_SIZE)
+        return;
+    // The window is logged after the PDUs of the subpacket, which move its
+    // lower edge by at most one SN each. Before them, the highest SN lies
+    // between there and the upper edge, unless the bearer was re-established.
+    int from = ((lower - 1 - n_pdus) % RLC_SN_MODULUS + RLC_SN_MODULUS) % RLC_SN_MODULUS;
+    int span = ((upper - 1 - from) % RLC_SN_MODULUS + RLC_SN_MODULUS) % RLC_SN_MODULUS;
+    if ((s.max_sn - from + RLC_SN_MODULUS) % RLC_SN_MODULUS <= span)
+        return;
+    s.counters.resets++;
+    add_event(RLC_EVENT_RESET, direction, rb_cfg_idx, s.max_sn, 0);
+    s.clear_sns();
+}
+
+void
+rlc_tracker_on_status (int direction, int rb_cfg_idx,
+                       const std::vector<int> &nack_sns, int sys_fn, int sub_fn) {
+    if (!LteRlcTrackerEngine.enabled)
+        return;
+    int data_direction = (direction == RLC_TRACKER_UL) ? RLC_TRACKER_DL : RLC_TRACKER_UL;
+    RlcBearerState &s = get_bearer(data_direction, rb_cfg_idx);
+    int t = lte_sys_time(sys_fn, sub_fn);
+    s.counters.status_pdus++;
+    for (size_t i = 0; i < nack_sns.size(); i++) {
+        int sn = nack_sns[i] % RLC_SN_MODULUS;
+        s.counters.nacks++;
+        if (s.nack_time[sn] >= 0)
+            continue;
+        s.nack_time[sn] = t;
+        int since = s.sent_time[sn] >= 0 ? s.sent_time[sn] : s.hole_time[sn];
+        add_event(RLC_EVENT_NACK, data_direction, rb_cfg_idx, sn,
+                  since >= 0 ? lte_sys_time_diff(t, since) : 0);
+    }
+}
+
+static bool
+lte_rlc_tracker_configure (PyObject *options) {
+    long long max_events = RLC_TRACKER_DEFAULT_MAX_EVENTS;
+    if (!analysis_get_int_option(options, "max_events", &max_events))
+        return false;
+    if (max_events < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_events must not be negative");
+        return false;
+    }
+    g_bearers.clear();
+    g_events.clear();
+    g_dropped_events = 0;
+    g_max_events = (size_t) max_events;
+    return true;
+}
+
+static PyObject *
+build_counters (const RlcBearerCounters &c) {
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+                         "data_pdus", c.data_pdus,
+                         "data_bytes", c.data_bytes,
+                         "retx_pdus", c.retx_pdus,
+                         "retx_bytes", c.retx_bytes,
+                         "holes", c.holes,
+                         "holes_filled", c.holes_filled,
+                         "holes_lost", c.holes_lost,
+                         "status_pdus", c.status_pdus,
+                         "nacks", c.nacks,
+                         "resets", c.resets);
+}
+
+static PyObject *
+lte_rlc_tracker_collect () {
+    PyObject *events = PyList_New(g_events.size());
+    for (size_t i = 0; i < g_events.size(); i++) {
+        const RlcEvent &e = g_events[i];
+        PyList_SetItem(events, i, Py_BuildValue("(dssiii)", e.time,
+                                                RlcEventKindNames[e.kind],
+                                                RlcDirectionNames[e.direction],
+                                                e.rb_cfg_idx, e.sn, e.delay_ms));
+    }
+    PyObject *bearers = PyDict_New();
+    for (RlcBearerMap::iterator it = g_bearers.begin(); it != g_bearers.end(); ++it) {
+        PyObject *key = Py_BuildValue("(si)", RlcDirectionNames[it->first.first],
+                                      it->first.second);
+        PyObject *counters = build_counters(it->second.counters);
+        PyDict_SetItem(bearers, key, counters);
+        Py_DECREF(key);
+        Py_DECREF(counters);
+        it->second.counters = RlcBearerCounters();
+    }
+    PyObject *ret = Py_BuildValue("{s:N,s:K,s:N}",
+                                  "events", events,
+                                  "dropped_events", g_dropped_events,
+                                  "bearers", bearers);
+    g_events.clear();
+    g_dropped_events = 0;
+    return ret;
+}
+
+AnalysisEngine LteRlcTrackerEngine = {
+    "lte_rlc_tracker",
+    false,
+    lte_rlc_tracker_configure,
+    lte_rlc_tracker_collect,
+};
@@ -0,0 +1,70 @@
+/* lte_rlc_tracker.h
+ * Analysis engine "lte_rlc_tracker": tracks the sequence numbers of LTE RLC AM
+ * bearers, from LTE_RLC_UL_AM_All_PDU and LTE_RLC_DL_AM_All_PDU, and reports
+ * retransmissions and losses as they are seen.
+ *
+ * Every bearer (data direction, RB config index) keeps the highest SN seen and
+ * a window of the last 512 SNs. Events are tuples
+ *     (time, kind, direction, rb_cfg_idx, sn, delay_ms)
+ * where time is the log packet time in seconds since the Unix epoch,
+ * direction is the data direction ("UL" or "DL"), delay_ms is measured on the
+ * system frame numbers, and kind is one of
+ *     "retx":        an SN was sent again. delay_ms since it was NACKed, or
+ *                    else since its first transmission
+ *     "hole_filled": an SN skipped by a higher SN arrived without a NACK (e.g.
+ *                    after HARQ retransmissions). delay_ms since it was skipped
+ *     "hole_lost":   a skipped SN left the window without arriving. delay_ms
+ *                    since it was skipped
+ *     "nack":        a STATUS PDU NACKed an SN for the first time. delay_ms
+ *                    since its first transmission, or since it was skipped
+ *     "reset":       the bearer was re-established. sn is the highest SN
+ *                    before, delay_ms is 0
+ *
+ * A re-establishment restarts the SNs from 0, which may look like a step
+ * forward. It is found on the state logged with every subpacket (VT(A) and
+ * VT(S), or VR(R) and VR(H)): when the window it gives no longer holds the
+ * highest SN seen, the SNs of the bearer are forgotten, without events.
+ *
+ * STATUS PDUs logged in one direction refer to the data of the other one.
+ * Segments other than the last one of a retransmitted PDU (RF=1, LSF=0) are
+ * only counted.
+ *
+ * Options:
+ *     max_events: events kept between two collect_engine() calls; more are
+ *                 counted as "dropped_events". Default 100000
+ *
+ * collect_engine() returns
+ *     {"events": [...], "dropped_events": n,
+ *      "bearers": {(direction, rb_cfg_idx): {counter: value}}}
+ * Counters are reset at every call; sequence numbers are kept.
+ */
+
+#ifndef __DM_COLLECTOR_C_LTE_RLC_TRACKER_H__
+#define __DM_COLLECTOR_C_LTE_RLC_TRACKER_H__
+
+#include "analysis_engine.h"
+
+#include <vector>
+
+// Direction of the log packet a PDU is logged in
+enum RlcTrackerDirection {
+    RLC_TRACKER_UL = 0,
+    RLC_TRACKER_DL = 1,
+};
+
+extern AnalysisEngine LteRlcTrackerEngine;
+
+// A data PDU. rf and lsf are the resegmentation and last segment flags.
+void rlc_tracker_on_data (int direction, int rb_cfg_idx, int sn, bool rf, bool lsf,
+                          int pdu_bytes, int sys_fn, int sub_fn);
+
+// The window logged with a subpacket of n_pdus PDUs, after them: VT(A) and
+// VT(S) for UL data, VR(R) and VR(H) for DL data. Call before the PDUs.
+void rlc_tracker_on_window (int direction, int rb_cfg_idx, int lower, int upper,
+                            int n_pdus);
+
+// A STATUS PDU, about the data of the opposite direction.
+void rlc_tracker_on_status (int direction, int rb_cfg_idx,
+                            const std::vector<int> &nack_sns, int sys_fn, int sub_fn);
+
+#endif // __DM_COLLECTOR_C_LTE_RLC_TRACKER_H__
@@ -0,0 +1,393 @@
+/* msg_classifier.cpp
+ * Implements the message type classifier, see msg_classifier.h.
+ */
+
+#include "msg_classifier.h"
+#include "utils.h"
+
+#include <cstring>
+
+// ------------------------------------------------------------
+// RRC
+
+// A message class such as DL-DCCH-Message:
+//   CHOICE { c1 CHOICE {...}, messageClassExtension ... }
+// For LTE UL-CCCH and UL-DCCH, messageClassExtension is itself
+//   CHOICE { c2 CHOICE {...}, messageClassExtensionFuture ... }
+struct RrcChannel {
+    const char *type;
+    int c1_bits;
+    const char *const *c1;      // NULL for spare alternatives
+    int n_c1;
+    int c2_bits;
+    const char *const *c2;
+    int n_c2;
+};
+
+static const char *const LteBcchDlSch[] = {
+    "systemInformation", "systemInformationBlockType1",
+};
+static const char *const LtePcch[] = {
+    "paging",
+};
+static const char *const LteDlCcch[] = {
+    "rrcConnectionReestablishment", "rrcConnectionReestablishmentReject",
+    "rrcConnectionReject", "rrcConnectionSetup",
+};
+static const char *const LteDlDcch[] = {
+    "csfbParametersResponseCDMA2000", "dlInformationTransfer",
+    "handoverFromEUTRAPreparationRequest", "mobilityFromEUTRACommand",
+    "rrcConnectionReconfiguration", "rrcConnectionRelease",
+    "securityModeCommand", "ueCapabilityEnquiry",
+    "counterCheck", "ueInformationRequest-r9",
+    "loggedMeasurementConfigurationRequest-r10", "rnReconfiguration-r10",
+    "rrcConnectionResume-r13", NULL, NULL, NULL,
+};
+static const char *const LteUlCcch[] = {
+    "rrcConnectionReestablishmentRequest", "rrcConnectionRequest",
+};
+static const char *const LteUlCcchC2[] = {
+    "rrcConnectionResumeRequest-r13",
+};
+static const char *const LteUlDcch[] = {
+    "csfbParametersRequestCDMA2000", "measurementReport",
+    "rrcConnectionReconfigurationComplete", "rrcConnectionReestablishmentComplete",
+    "rrcConnectionSetupComplete", "securityModeComplete",
+    "securityModeFailure", "ueCapabilityInformation",
+    "ulHandoverPreparationTransfer", "ulInformationTransfer",
+    "counterCheckResponse", "ueInformationResponse-r9",
+    "proximityIndication-r9", "rnReconfigurationComplete-r10",
+    "mbmsCountingResponse-r10", "interFreqRSTDMeasurementIndication-r10",
+};
+static const char *const LteUlDcchC2[] = {
+    "ueAssistanceInformation-r11", "inDeviceCoexIndication-r11",
+    "mbmsInterestIndication-r11", "scgFailureInformation-r12",
+    "sidelinkUEInformation-r12", "wlanConnectionStatusReport-r13",
+    "rrcConnectionResumeComplete-r13", "ulInformationTransferMRDC-r15",
+    "scgFailureInformationNR-r15", "measReportAppLayer-r15",
+    "failureInformation-r15", NULL, NULL, NULL, NULL, NULL,
+};
+
+static const char *const NrBcchBch[] = {
+    "mib",
+};
+static const char *const NrBcchDlSch[] = {
+    "systemInformation", "systemInformationBlockType1",
+};
+static const char *const NrDlCcch[] = {
+    "rrcReject", "rrcSetup", NULL, NULL,
+};
+static const char *const NrDlDcch[] = {
+    "rrcReconfiguration", "rrcResume", "rrcRelease", "rrcReestablishment",
+    "securityModeCommand", "dlInformationTransfer", "ueCapabilityEnquiry", "counterCheck",
+    "mobilityFromNRCommand", "dlDedicatedMessageSegment-r16", "ueInformationRequest-r16",
+    "dlInformationTransferMRDC-r16", "loggedMeasurementConfiguration-r16", NULL, NULL, NULL,
+};
+static const char *const NrPcch[] = {
+    "paging", NULL,
+};
+static const char *const NrUlCcch[] = {
+    "rrcSetupRequest", "rrcResumeRequest", "rrcReestablishmentRequest", "rrcSystemInfoRequest",
+};
+static const char *const NrUlCcch1[] = {
+    "rrcResumeRequest1", NULL, NULL, NULL,
+};
+static const char *const NrUlDcch[] = {
+    "measurementReport", "rrcReconfigurationComplete", "rrcSetupComplete",
+    "rrcReestablishmentComplete", "rrcResumeComplete", "securityModeComplete",
+    "securityModeFailure", "ulInformationTransfer", "locationMeasurementIndication",
+    "ueCapabilityInformation", "counterCheckResponse", "ueAssistanceInformation",
+    "failureInformation", "ulInformationTransferMRDC", "scgFailureInformation",
+    "scgFailureInformationEUTRA",
+};
+
+#define RRC_CHANNEL(type, bits, c1) {type, bits, c1, ARRAY_SIZE(c1, const char *), 0, NULL, 0}
+
+static const RrcChannel RrcChannels[] = {
+    RRC_CHANNEL("LTE-RRC_BCCH_DL_SCH", 1, LteBcchDlSch),
+    RRC_CHANNEL("LTE-RRC_PCCH", 0, LtePcch),
+    RRC_CHANNEL("LTE-RRC_DL_CCCH", 2, LteDlCcch),
+    RRC_CHANNEL("LTE-RRC_DL_DCCH", 4, LteDlDcch),
+    {"LTE-RRC_UL_CCCH", 1, LteUlCcch, ARRAY_SIZE(LteUlCcch, const char *),
+                        0, LteUlCcchC2, ARRAY_SIZE(LteUlCcchC2, const char *)},
+    {"LTE-RRC_UL_DCCH", 4, LteUlDcch, ARRAY_SIZE(LteUlDcch, const char *),
+                        4, LteUlDcchC2, ARRAY_SIZE(LteUlDcchC2, const char *)},
+    RRC_CHANNEL("nr-rrc.bcch.bch", 0, NrBcchBch),
+    RRC_CHANNEL("nr-rrc.bcch.dl.sch", 1, NrBcchDlSch),
+    RRC_CHANNEL("nr-rrc.dl.ccch", 2, NrDlCcch),
+    RRC_CHANNEL("nr-rrc.dl.dcch", 4, NrDlDcch),
+    RRC_CHANNEL("nr-rrc.pcch", 1, NrPcch),
+    RRC_CHANNEL("nr-rrc.ul.ccch", 2, NrUlCcch),
+    RRC_CHANNEL("nr-rrc.ul.ccch1", 2, NrUlCcch1),
+    RRC_CHANNEL("nr-rrc.ul.dcch", 4, NrUlDcch),
+};
+
+// Types whose payload is a single message rather than a message class
+static const char *const RrcSingleMessages[][2] = {
+    {"nr-rrc.rrc_reconf", "rrcReconfiguration"},
+    {"nr-rrc.radio_bearer_conf", "radioBearerConfig"},
+    {"nr-rrc.ue_nr_cap", "ue-NR-Capability"},
+    {"nr-rrc.ue_mrdc_cap", "ue-MRDC-Capability"},
+    {"nr-rrc.ue_radio_paging_info", "ue-RadioPagingInformation"},
+    {"nr-rrc.ue_radio_access_cap_info", "ue-RadioAccessCapabilityInformation"},
+};
+
+// Read n bits (at most 8) of a UPER message, most significant first.
+// Return: the bits, or -1 past the end
+static int
+read_bits (const unsigned char *b, size_t length, size_t *pos, int n) {
+    if (*pos + n > length * 8)
+        return -1;
+    int v = 0;
+    for (int i = 0; i < n; i++, (*pos)++)
+        v = (v << 1) | ((b[*pos / 8] >> (7 - *pos % 8)) & 1);
+    return v;
+}
+
+static const char *
+classify_rrc (const RrcChannel &ch, const unsigned char *b, size_t length) {
+    size_t pos = 0;
+    int ext = read_bits(b, length, &pos, 1);
+    if (ext < 0)
+        return NULL;
+    const char *const *names = ch.c1;
+    int n = ch.n_c1;
+    int bits = ch.c1_bits;
+    if (ext == 1) {
+        // messageClassExtension, then c2 if there is one
+        if (ch.c2 == NULL || read_bits(b, length, &pos, 1) != 0)
+            return "messageClassExtension";
+        names = ch.c2;
+        n = ch.n_c2;
+        bits = ch.c2_bits;
+    }
+    int i = read_bits(b, length, &pos, bits);
+    if (i < 0 || i >= n)
+        return NULL;
+    return names[i] != NULL ? names[i] : "spare";
+}
+
+// ------------------------------------------------------------
+// NAS
+
+const ValueName EpsEmmMessageType[] = {
+    {0x41, "Attach request"},
+    {0x42, "Attach accept"},
+    {0x43, "Attach complete"},
+    {0x44, "Attach reject"},
+    {0x45, "Detach request"},
+    {0x46, "Detach accept"},
+    {0x48, "Tracking area update request"},
+    {0x49, "Tracking area update accept"},
+    {0x4a, "Tracking area update complete"},
+    {0x4b, "Tracking area update reject"},
+    {0x4c, "Extended service request"},
+    {0x4d, "Control plane service request"},
+    {0x4e, "Service reject"},
+    {0x4f, "Service accept"},
+    {0x50, "GUTI reallocation command"},
+    {0x51, "GUTI reallocation complete"},
+    {0x52, "Authentication request"},
+    {0x53, "Authentication response"},
+    {0x54, "Authentication reject"},
+    {0x55, "Identity request"},
+    {0x56, "Identity response"},
+    {0x5c, "Authentication failure"},
+    {0x5d, "Security mode command"},
+    {0x5e, "Security mode complete"},
+    {0x5f, "Security mode reject"},
+    {0x60, "EMM status"},
+    {0x61, "EMM information"},
+    {0x62, "Downlink NAS transport"},
+    {0x63, "Uplink NAS transport"},
+    {0x64, "CS Service notification"},
+    {0x68, "Downlink generic NAS transport"},
+    {0x69, "Uplink generic NAS transport"},
+};
+
+const ValueName EpsEsmMessageType[] = {
+    {0xc1, "Activate default EPS bearer context request"},
+    {0xc2, "Activate default EPS bearer context accept"},
+    {0xc3, "Activate default EPS bearer context reject"},
+    {0xc5, "Activate dedicated EPS bearer context request"},
+    {0xc6, "Activate dedicated EPS bearer context accept"},
+    {0xc7, "Activate dedicated EPS bearer context reject"},
+    {0xc9, "Modify EPS bearer context request"},
+    {0xca, "Modify EPS bearer context accept"},
+    {0xcb, "Modify EPS bearer context reject"},
+    {0xcd, "Deactivate EPS bearer context request"},
+    {0xce, "Deactivate EPS bearer context accept"},
+    {0xd0, "PDN connectivity request"},
+    {0xd1, "PDN connectivity reject"},
+    {0xd2, "PDN disconnect request"},
+    {0xd3, "PDN disconnect reject"},
+    {0xd4, "Bearer resource allocation request"},
+    {0xd5, "Bearer resource allocation reject"},
+    {0xd6, "Bearer resource modification request"},
+    {0xd7, "Bearer resource modification reject"},
+    {0xd9, "ESM information request"},
+    {0xda, "ESM information response"},
+    {0xdb, "Notification"},
+    {0xdc, "ESM dummy message"},
+    {0xe8, "ESM status"},
+    {0xe9, "Remote UE report"},
+    {0xea, "Remote UE report response"},
+    {0xeb, "ESM data transport"},
+};
+
+const ValueName Nr5gmmMessageType[] = {
+    {0x41, "Registration request"},
+    {0x42, "Registration accept"},
+    {0x43, "Registration complete"},
+    {0x44, "Registration reject"},
+    {0x45, "Deregistration request (UE originating)"},
+    {0x46, "Deregistration accept (UE originating)"},
+    {0x47, "Deregistration request (UE terminated)"},
+    {0x48, "Deregistration accept (UE terminated)"},
+    {0x4c, "Service request"},
+    {0x4d, "Service reject"},
+    {0x4e, "Service accept"},
+    {0x4f, "Control plane service request"},
+    {0x50, "Network slice-specific authentication command"},
+    {0x51, "Network slice-specific authentication complete"},
+    {0x52, "Network slice-specific authentication result"},
+    {0x54, "Configuration update command"},
+    {0x55, "Configuration update complete"},
+    {0x56, "Authentication request"},
+    {0x57, "Authentication response"},
+    {0x58, "Authentication reject"},
+    {0x59, "Authentication failure"},
+    {0x5a, "Authentication result"},
+    {0x5b, "Identity request"},
+    {0x5c, "Identity response"},
+    {0x5d, "Security mode command"},
+    {0x5e, "Security mode complete"},
+    {0x5f, "Security mode reject"},
+    {0x64, "5GMM status"},
+    {0x65, "Notification"},
+    {0x66, "Notification response"},
+    {0x67, "UL NAS transport"},
+    {0x68, "DL NAS transport"},
+};
+
+const ValueName Nr5gsmMessageType[] = {
+    {0xc1, "PDU session establishment request"},
+    {0xc2, "PDU session establishment accept"},
+    {0xc3, "PDU session establishment reject"},
+    {0xc5, "PDU session authentication command"},
+    {0xc6, "PDU session authentication complete"},
+    {0xc7, "PDU session authentication result"},
+    {0xc9, "PDU session modification request"},
+    {0xca, "PDU session modification reject"},
+    {0xcb, "PDU session modification command"},
+    {0xcc, "PDU session modification complete"},
+    {0xcd, "PDU session modification command reject"},
+    {0xd1, "PDU session release request"},
+    {0xd2, "PDU session release reject"},
+    {0xd3, "PDU session release command"},
+    {0xd4, "PDU session release complete"},
+    {0xd6, "5GSM status"},
+};
+
+// EPS NAS (24.301): security header type and protocol discriminator, then the
+// message type (EMM), or the PTI and the message type (ESM).
+static const char *
+classify_eps_nas (const unsigned char *b, size_t length, bool protected_ok) {
+    if (length < 2)
+        return NULL;
+    int pd = b[0] & 0x0F;
+    int sht = b[0] >> 4;
+    if (pd == 7) {
+        if (sht == 0x0C)
+            return "Service request";
+        if (sht != 0) {
+            // Skip the MAC and sequence number, to the plain message
+            if (!protected_ok)
+                return NULL;
+            return length > 6 ? classify_eps_nas(b + 6, length - 6, false) : NULL;
+        }
+        return search_name(EpsEmmMessageType, ARRAY_SIZE(EpsEmmMessageType, ValueName), b[1]);
+    }
+    if (pd == 2 && length >= 3)
+        return search_name(EpsEsmMessageType, ARRAY_SIZE(EpsEsmMessageType, ValueName), b[2]);
+    return NULL;
+}
+
+// 5GS NAS (24.501): extended protocol discriminator, then the security header
+// type and the message type (5GMM), or the PDU session ID, the PTI and the
+// message type (5GSM).
+static const char *
+classify_5gs_nas (const unsigned char *b, size_t length, bool protected_ok) {
+    if (length < 3)
+        return NULL;
+    if (b[0] == 0x7E) {
+        if ((b[1] & 0x0F) != 0) {
+            if (!protected_ok)
+                return NULL;
+            return length > 7 ? classify_5gs_nas(b + 7, length - 7, false) : NULL;
+        }
+        return search_name(Nr5gmmMessageType, ARRAY_SIZE(Nr5gmmMessageType, ValueName), b[2]);
+    }
+    if (b[0] == 0x2E && length >= 4)
+        return search_name(Nr5gsmMessageType, ARRAY_SIZE(Nr5gsmMessageType, ValueName), b[3]);
+    return NULL;
+}
+
+// ------------------------------------------------------------
+
+const char *
+classify_raw_msg (const char *type, const unsigned char *b, size_t length) {
+    if (strcmp(type, "LTE-NAS_EPS_PLAIN") == 0)
+        return classify_eps_nas(b, length, true);
+    if (strcmp(type, "nas-5gs") == 0)
+        return classify_5gs_nas(b, length, true);
+    for (size_t i = 0; i < ARRAY_SIZE(RrcChannels, RrcChannel); i++) {
+        if (strcmp(type, RrcChannels[i].type) == 0)
+            return classify_rrc(RrcChannels[i], b, length);
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(RrcSingleMessages, RrcSingleMessages[0]); i++) {
+        if (strcmp(type, RrcSingleMessages[i][0]) == 0)
+            return RrcSingleMessages[i][1];
+    }
+    return NULL;
+}
+
+static bool g_msg_types_enabled = false;
+
+void
+set_msg_types_enabled (bool enabled) {
+    g_msg_types_enabled = enabled;
+}
+
+bool
+msg_types_enabled () {
+    return g_msg_types_enabled;
+}
+
+void
+add_msg_types (PyObject *result) {
+    static const char RAW_MSG_PREFIX[] = "raw_msg/";
+    for (Py_ssize_t i = 0; i < PyList_Size(result); i++) {
+        PyObject *t = PyList_GetItem(result, i);    // borrowed
+        if (!PyTuple_Check(t) || PyTuple_Size(t) != 3)
+            continue;
+        const char *type_str = PyUnicode_AsUTF8(PyTuple_GetItem(t, 2));
+        PyObject *val = PyTuple_GetItem(t, 1);
+        if (type_str == NULL) {
+            PyErr_Clear();
+            continue;
+        }
+        if (strncmp(type_str, RAW_MSG_PREFIX, sizeof(RAW_MSG_PREFIX) - 1) != 0
+                || !PyBytes_Check(val))
+            continue;
+        const char *name = classify_raw_msg(type_str + sizeof(RAW_MSG_PREFIX) - 1,
+                                            (const unsigned char *) PyBytes_AsString(val),
+                                            PyBytes_Size(val));
+        if (name == NULL)
+            continue;
+        PyObject *field = Py_BuildValue("(sss)", "Msg Type", name, "");
+        PyList_Insert(result, i, field);
+        Py_DECREF(field);
+        i++;
+    }
+}
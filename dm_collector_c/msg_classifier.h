@@ -0,0 +1,35 @@
+/* msg_classifier.h
+ * Tells the type of a raw signaling message (e.g. rrcConnectionReconfiguration
+ * or Attach accept) without dissecting it.
+ *
+ * RRC messages are UPER encoded, and their type is given by the first few bits
+ * of the message: the extension bit of the message class, then the index of
+ * the c1 alternative. NAS messages have their type at a fixed offset after
+ * the protocol discriminator, once any security protected header is skipped.
+ *
+ * Supported: LTE RRC and NR RRC channels, EPS NAS (24.301) and 5GS NAS
+ * (24.501). Names follow the ASN.1 alternatives for RRC and the 3GPP message
+ * names for NAS.
+ */
+
+#ifndef __DM_COLLECTOR_C_MSG_CLASSIFIER_H__
+#define __DM_COLLECTOR_C_MSG_CLASSIFIER_H__
+
+#include <Python.h>
+
+#include <stddef.h>
+
+// Classify a raw message of the given raw_msg type (e.g. "LTE-RRC_DL_DCCH").
+// Return: the name of the message type, or NULL if it cannot be told
+const char *classify_raw_msg (const char *type, const unsigned char *b, size_t length);
+
+// Add a "Msg Type" field before every "raw_msg/" field of a result list whose
+// type can be told.
+void add_msg_types (PyObject *result);
+
+// Whether decode_log_packet() adds the "Msg Type" fields. Off by default, so
+// that decoded packets keep their fields unless asked for.
+void set_msg_types_enabled (bool enabled);
+bool msg_types_enabled ();
+
+#endif // __DM_COLLECTOR_C_MSG_CLASSIFIER_H__
@@ -0,0 +1,275 @@
+/* nr_beam_store.cpp
+ * Implements the "nr_beam_store" analysis engine.
+ */
+
+#include "nr_beam_store.h"
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#define NR_BEAM_STORE_DEFAULT_CAPACITY 256
+#define NR_BEAM_STORE_DEFAULT_WINDOW 1.0
+
+struct NrBeamKey {
+    int pci;
+    int ssb_index;
+
+    bool operator< (const NrBeamKey &other) const {
+        if (pci != other.pci)
+            return pci < other.pci;
+        return ssb_index < other.ssb_index;
+    }
+};
+
+struct NrBeamSample {
+    double time;
+    float rsrp;
+    float rsrq;
+    unsigned char serving;
+    unsigned char source;
+};
+
+// The last samples of a beam
+struct NrBeamRing {
+    std::vector<NrBeamSample> samples;
+    size_t next;    // Index of the oldest sample once full, else 0
+    unsigned long long pushed;
+    unsigned long long collected;   // pushed at the last collect
+
+    NrBeamRing () : next(0), pushed(0), collected(0) {}
+
+    // Return: the i-th sample, from the oldest
+    const NrBeamSample &at (size_t i) const {
+        return samples[(next + i) % samples.size()];
+    }
+};
+
+// Mean RSRP and RSRQ of the samples of a beam over a window
+struct NrBeamMean {
+    double rsrp;
+    double rsrq;
+    unsigned int samples;
+};
+
+typedef std::map<NrBeamKey, NrBeamRing> NrBeamRingMap;
+
+static NrBeamRingMap g_beams;
+static size_t g_capacity = NR_BEAM_STORE_DEFAULT_CAPACITY;
+static unsigned long long g_dropped_samples = 0;
+static double g_last_time = 0;
+static bool g_has_serving = false;
+static NrBeamKey g_serving;     // Beam of the latest serving sample
+
+void
+nr_beam_store_on_beam (int source, int pci, int ssb_index, bool serving,
+                       float rsrp, float rsrq) {
+    if (!NrBeamStoreEngine.enabled)
+        return;
+    NrBeamKey key = {pci, ssb_index};
+    NrBeamRing &r = g_beams[key];
+    NrBeamSample s = {analysis_packet_time(), rsrp, rsrq,
+                      (unsigned char) serving, (unsigned char) source};
+    if (r.samples.size() < g_capacity) {
+        r.samples.push_back(s);
+    } else {
+        r.samples[r.next] = s;
+        r.next = (r.next + 1) % g_capacity;
+    }
+    r.pushed++;
+    g_last_time = s.time;
+    if (serving) {
+        g_has_serving = true;
+        g_serving = key;
+    }
+}
+
+// Return: the mean of the samples of r since start. NaN values are left out
+static NrBeamMean
+mean_since (const NrBeamRing &r, double start) {
+    NrBeamMean m = {0, 0, 0};
+    unsigned int n_rsrq = 0;
+    for (size_t i = r.samples.size(); i > 0; i--) {
+        const NrBeamSample &s = r.at(i - 1);
+        if (s.time < start)
+            break;
+        if (std::isnan(s.rsrp))
+            continue;
+        m.rsrp += s.rsrp;
+        m.samples++;
+        if (!std::isnan(s.rsrq)) {
+            m.rsrq += s.rsrq;
+            n_rsrq++;
+        }
+    }
+    m.rsrp = m.samples > 0 ? m.rsrp / m.samples : NAN;
+    m.rsrq = n_rsrq > 0 ? m.rsrq / n_rsrq : NAN;
+    return m;
+}
+
+// Find the beam with the highest mean RSRP of every cell.
+// Return: the means of the best beams, by PCI
+static std::map<int, std::pair<int, NrBeamMean> >
+best_beams (double start) {
+    std::map<int, std::pair<int, NrBeamMean> > best;
+    for (NrBeamRingMap::const_iterator it = g_beams.begin(); it != g_beams.end(); ++it) {
+        NrBeamMean m = mean_since(it->second, start);
+        if (m.samples == 0)
+            continue;
+        std::map<int, std::pair<int, NrBeamMean> >::iterator b = best.find(it->first.pci);
+        if (b == best.end() || m.rsrp > b->second.second.rsrp)
+            best[it->first.pci] = std::make_pair(it->first.ssb_index, m);
+    }
+    return best;
+}
+
+static bool
+nr_beam_store_configure (PyObject *options) {
+    long long capacity = NR_BEAM_STORE_DEFAULT_CAPACITY;
+    if (!analysis_get_int_option(options, "capacity", &capacity))
+        return false;
+    if (capacity < 1) {
+        PyErr_SetString(PyExc_ValueError, "capacity must be at least 1");
+        return false;
+    }
+    g_beams.clear();
+    g_capacity = (size_t) capacity;
+    g_dropped_samples = 0;
+    g_last_time = 0;
+    g_has_serving = false;
+    return true;
+}
+
+static PyObject *
+build_columns (const NrBeamRing &r, size_t first) {
+    size_t n = r.samples.size() - first;
+    std::vector<double> time(n);
+    std::vector<float> rsrp(n);
+    std::vector<float> rsrq(n);
+    std::vector<unsigned char> serving(n);
+    std::vector<unsigned char> source(n);
+    for (size_t i = 0; i < n; i++) {
+        const NrBeamSample &s = r.at(first + i);
+        time[i] = s.time;
+        rsrp[i] = s.rsrp;
+        rsrq[i] = s.rsrq;
+        serving[i] = s.serving;
+        source[i] = s.source;
+    }
+    return Py_BuildValue("{s:N,s:N,s:N,s:N,s:N}",
+                         "time", analysis_make_column(time, "d"),
+                         "rsrp", analysis_make_column(rsrp, "f"),
+                         "rsrq", analysis_make_column(rsrq, "f"),
+                         "serving", analysis_make_column(serving, "B"),
+                         "source", analysis_make_column(source, "B"));
+}
+
+static PyObject *
+nr_beam_store_collect () {
+    PyObject *beams = PyDict_New();
+    for (NrBeamRingMap::iterator it = g_beams.begin(); it != g_beams.end(); ++it) {
+        NrBeamRing &r = it->second;
+        unsigned long long n_new = r.pushed - r.collected;
+        if (n_new == 0)
+            continue;
+        if (n_new > r.samples.size()) {
+            g_dropped_samples += n_new - r.samples.size();
+            n_new = r.samples.size();
+        }
+        PyObject *key = Py_BuildValue("(ii)", it->first.pci, it->first.ssb_index);
+        PyObject *columns = build_columns(r, r.samples.size() - (size_t) n_new);
+        PyDict_SetItem(beams, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        r.collected = r.pushed;
+    }
+    PyObject *ret = Py_BuildValue("{s:n,s:K,s:N}",
+                                  "capacity", (Py_ssize_t) g_capacity,
+                                  "dropped_samples", g_dropped_samples,
+                                  "beams", beams);
+    g_dropped_samples = 0;
+    return ret;
+}
+
+static PyObject *
+query_best_beam (PyObject *params, double start) {
+    long long pci = -1;
+    if (!analysis_get_int_option(params, "pci", &pci))
+        return NULL;
+    std::map<int, std::pair<int, NrBeamMean> > best = best_beams(start);
+    PyObject *ret = PyDict_New();
+    for (std::map<int, std::pair<int, NrBeamMean> >::iterator it = best.begin();
+            it != best.end(); ++it) {
+        if (pci >= 0 && it->first != pci)
+            continue;
+        const NrBeamMean &m = it->second.second;
+        PyObject *key = PyLong_FromLong(it->first);
+        PyObject *beam = Py_BuildValue("{s:i,s:d,s:d,s:I}",
+                                       "ssb_index", it->second.first,
+                                       "rsrp", m.rsrp,
+                                       "rsrq", m.rsrq,
+                                       "samples", m.samples);
+        PyDict_SetItem(ret, key, beam);
+        Py_DECREF(key);
+        Py_DECREF(beam);
+    }
+    return ret;
+}
+
+static PyObject *
+query_serving_delta (double start) {
+    if (!g_has_serving)
+        Py_RETURN_NONE;
+    NrBeamMean serving = mean_since(g_beams[g_serving], start);
+    if (serving.samples == 0)
+        Py_RETURN_NONE;
+    std::map<int, std::pair<int, NrBeamMean> > best = best_beams(start);
+    best.erase(g_serving.pci);
+    int neighbor_pci = -1;
+    for (std::map<int, std::pair<int, NrBeamMean> >::iterator it = best.begin();
+            it != best.end(); ++it) {
+        if (neighbor_pci < 0 || it->second.second.rsrp > best[neighbor_pci].second.rsrp)
+            neighbor_pci = it->first;
+    }
+    if (neighbor_pci < 0)
+        return Py_BuildValue("{s:(ii),s:d,s:O,s:O,s:O}",
+                             "serving", g_serving.pci, g_serving.ssb_index,
+                             "serving_rsrp", serving.rsrp,
+                             "neighbor", Py_None,
+                             "neighbor_rsrp", Py_None,
+                             "delta", Py_None);
+    const std::pair<int, NrBeamMean> &neighbor = best[neighbor_pci];
+    return Py_BuildValue("{s:(ii),s:d,s:(ii),s:d,s:d}",
+                         "serving", g_serving.pci, g_serving.ssb_index,
+                         "serving_rsrp", serving.rsrp,
+                         "neighbor", neighbor_pci, neighbor.first,
+                         "neighbor_rsrp", neighbor.second.rsrp,
+                         "delta", neighbor.second.rsrp - serving.rsrp);
+}
+
+static PyObject *
+nr_beam_store_query (const char *query, PyObject *params) {
+    double window = NR_BEAM_STORE_DEFAULT_WINDOW;
+    if (!analysis_get_double_option(params, "window", &window))
+        return NULL;
+    if (!(window > 0)) {
+        PyErr_SetString(PyExc_ValueError, "window must be positive");
+        return NULL;
+    }
+    double start = g_last_time - window;
+    if (strcmp(query, "best_beam") == 0)
+        return query_best_beam(params, start);
+    if (strcmp(query, "serving_delta") == 0)
+        return query_serving_delta(start);
+    PyErr_Format(PyExc_ValueError, "Unknown query of nr_beam_store: %s", query);
+    return NULL;
+}
+
+AnalysisEngine NrBeamStoreEngine = {
+    "nr_beam_store",
+    false,
+    nr_beam_store_configure,
+    nr_beam_store_collect,
+    nr_beam_store_query,
+};
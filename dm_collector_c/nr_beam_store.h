@@ -0,0 +1,58 @@
+/* nr_beam_store.h
+ * Analysis engine "nr_beam_store": keeps the latest RSRP and RSRQ samples of
+ * every NR beam, from NR_ML1_Searcher_Measurement_Database_Update_Ext and
+ * NR_ML1_Serving_Cell_Beam_Management, for beam management dashboards.
+ *
+ * Beams are keyed by
+ *     (pci, ssb_index)
+ * and hold their last "capacity" samples in a ring buffer, timed by their
+ * log packet. The searcher gives the L3 filtered RSRP and RSRQ of the
+ * detected beams of every cell (but not available ones), and the serving cell
+ * beam management the filtered ones of the detected beams of the serving cell.
+ * A sample is a serving one when its beam is the serving SSB of the packet.
+ *
+ * collect_engine() returns the samples added since the last call, which stay
+ * in the store for the queries:
+ *     {"capacity": samples per beam,
+ *      "dropped_samples": samples overwritten before they were collected,
+ *      "beams": {key: {column: memoryview}}}
+ * with the columns (memoryviews of copies of the samples, as the samples stay
+ * in the store; numpy.asarray() takes them without copying again)
+ *     time (d): time of the log packet, in seconds since the Unix epoch
+ *     rsrp (f), rsrq (f): in dBm and dB; rsrq is NaN when not available
+ *     serving (B): 1 for a sample of the serving beam, else 0
+ *     source (B): NR_BEAM_STORE_SEARCHER (0) or NR_BEAM_STORE_BEAM_MNGT (1)
+ *
+ * Options:
+ *     capacity: samples kept per beam, at least 1. Default 256
+ *
+ * query_engine() takes the queries, over the samples of the last "window"
+ * seconds (default 1.0) before the latest one:
+ *     "best_beam": the beam with the highest mean RSRP of every cell, or of
+ *                  the cell of the "pci" parameter, as
+ *                  {pci: {"ssb_index", "rsrp", "rsrq", "samples"}}
+ *     "serving_delta": the latest serving beam against the beam with the
+ *                      highest mean RSRP of the other cells, as
+ *                      {"serving": key, "serving_rsrp", "neighbor": key,
+ *                       "neighbor_rsrp", "delta": neighbor - serving RSRP};
+ *                      neighbor, neighbor_rsrp and delta are None without
+ *                      neighbor samples. None without a serving sample
+ */
+
+#ifndef __DM_COLLECTOR_C_NR_BEAM_STORE_H__
+#define __DM_COLLECTOR_C_NR_BEAM_STORE_H__
+
+#include "analysis_engine.h"
+
+enum NrBeamStoreSource {
+    NR_BEAM_STORE_SEARCHER = 0,
+    NR_BEAM_STORE_BEAM_MNGT = 1,
+};
+
+extern AnalysisEngine NrBeamStoreEngine;
+
+// A measurement of a beam. rsrq is NaN when not available.
+void nr_beam_store_on_beam (int source, int pci, int ssb_index, bool serving,
+                            float rsrp, float rsrq);
+
+#endif // __DM_COLLECTOR_C_NR_BEAM_STORE_H__
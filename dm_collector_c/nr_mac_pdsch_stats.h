@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "nr_mac_tput.h"
 
 const Fmt NrMacPdschStats_Fmt [] = {
     {UINT, "Minor Version",                 2},
@@ -39,6 +40,27 @@ const Fmt NrMacPdschStatsRecord_v2_2 [] = {
 
 };
 
+// Feed a v2.2 record to the nr_mac_tput engine, if it fits in the buffer.
+static void
+_feed_nr_mac_pdsch_stats_record_v2_2 (const char *b, int offset, size_t length) {
+    const Fmt *fmt = NrMacPdschStatsRecord_v2_2;
+    int n_fmt = ARRAY_SIZE(NrMacPdschStatsRecord_v2_2, Fmt);
+    if (!NrMacTputEngine.enabled || offset + _fmt_offset(fmt, n_fmt, NULL) > (int) length)
+        return;
+    const char *p = b + offset;
+    unsigned long long crc_pass = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "Num CRC Pass TB"), 4);
+    NrMacTputStats stats = NrMacTputStats();
+    stats.slots = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "Num Slots Elapsed"), 4);
+    stats.failed_tbs = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "Num CRC Fail TB"), 4);
+    stats.tbs = crc_pass + stats.failed_tbs;
+    stats.retx_tbs = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "Num ReTx"), 4);
+    stats.harq_failures = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "HARQ Failure"), 4);
+    stats.bytes = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "CRC Pass TB Bytes"), 8);
+    stats.retx_bytes = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "ReTx Bytes"), 8);
+    int carrier = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "Carrier ID"), 4);
+    nr_mac_tput_on_stats(NR_MAC_TPUT_DL, carrier, stats);
+}
+
 static int
 _decode_nr_mac_pdsch_stats_subpkt(const char *b, int offset, size_t length,
                        PyObject *result) {
@@ -59,6 +81,7 @@ _decode_nr_mac_pdsch_stats_subpkt(const char *b, int offset, size_t length,
                     PyObject *t = NULL;
 
                     for(int i = 0; i < n_record; i++){
+                        _feed_nr_mac_pdsch_stats_record_v2_2(b, offset, length);
                         PyObject *result_record = PyList_New(0);
                         offset += _decode_by_fmt(NrMacPdschStatsRecord_v2_2,
                                                  ARRAY_SIZE(NrMacPdschStatsRecord_v2_2, Fmt),
@@ -0,0 +1,152 @@
+/* nr_mac_tput.cpp
+ * Implements the "nr_mac_tput" analysis engine.
+ */
+
+#include "nr_mac_tput.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#define NR_MAC_TPUT_DEFAULT_GRANULARITY 1.0
+#define NR_MAC_TPUT_MIN_GRANULARITY 0.001
+
+static const char *NrMacTputDirectionNames[] = {
+    "UL",
+    "DL",
+};
+
+struct NrMacTputKey {
+    int direction;
+    int carrier;
+
+    bool operator< (const NrMacTputKey &other) const {
+        if (direction != other.direction)
+            return direction < other.direction;
+        return carrier < other.carrier;
+    }
+};
+
+// Closed windows, as columns
+struct NrMacTputColumns {
+    std::vector<double> time;
+    std::vector<unsigned long long> slots;
+    std::vector<unsigned long long> tbs;
+    std::vector<unsigned long long> retx_tbs;
+    std::vector<unsigned long long> failed_tbs;
+    std::vector<unsigned long long> harq_failures;
+    std::vector<unsigned long long> bytes;
+    std::vector<unsigned long long> retx_bytes;
+    std::vector<double> bler;
+};
+
+struct NrMacTputSeries {
+    long long window;   // Index of the window in progress, or -1
+    NrMacTputStats counts;
+    NrMacTputColumns columns;
+
+    NrMacTputSeries () : window(-1), counts() {}
+};
+
+typedef std::map<NrMacTputKey, NrMacTputSeries> NrMacTputSeriesMap;
+
+static NrMacTputSeriesMap g_series;
+static long long g_granularity_ms = 1000;
+
+// Move the window in progress, if any, to the columns.
+static void
+close_window (NrMacTputSeries &s) {
+    if (s.window < 0)
+        return;
+    NrMacTputColumns &c = s.columns;
+    const NrMacTputStats &w = s.counts;
+    c.time.push_back(s.window * g_granularity_ms / 1000.0);
+    c.slots.push_back(w.slots);
+    c.tbs.push_back(w.tbs);
+    c.retx_tbs.push_back(w.retx_tbs);
+    c.failed_tbs.push_back(w.failed_tbs);
+    c.harq_failures.push_back(w.harq_failures);
+    c.bytes.push_back(w.bytes);
+    c.retx_bytes.push_back(w.retx_bytes);
+    c.bler.push_back(w.tbs > 0 ? (double) w.failed_tbs / w.tbs : 0.0);
+    s.counts = NrMacTputStats();
+    s.window = -1;
+}
+
+void
+nr_mac_tput_on_stats (int direction, int carrier, const NrMacTputStats &stats) {
+    if (!NrMacTputEngine.enabled)
+        return;
+    NrMacTputKey key = {direction, carrier};
+    NrMacTputSeries &s = g_series[key];
+    long long t = llround(analysis_packet_time() * 1000);
+    long long window = t / g_granularity_ms;
+    // A late record is added to the window in progress
+    if (window > s.window) {
+        close_window(s);
+        s.window = window;
+    }
+    NrMacTputStats &w = s.counts;
+    w.slots += stats.slots;
+    w.tbs += stats.tbs;
+    w.retx_tbs += stats.retx_tbs;
+    w.failed_tbs += stats.failed_tbs;
+    w.harq_failures += stats.harq_failures;
+    w.bytes += stats.bytes;
+    w.retx_bytes += stats.retx_bytes;
+}
+
+static bool
+nr_mac_tput_configure (PyObject *options) {
+    double granularity = NR_MAC_TPUT_DEFAULT_GRANULARITY;
+    if (!analysis_get_double_option(options, "granularity", &granularity))
+        return false;
+    if (!(granularity >= NR_MAC_TPUT_MIN_GRANULARITY)) {
+        PyErr_SetString(PyExc_ValueError, "granularity must be at least 0.001");
+        return false;
+    }
+    g_series.clear();
+    g_granularity_ms = (long long) llround(granularity * 1000);
+    return true;
+}
+
+static PyObject *
+build_columns (const NrMacTputColumns &c) {
+    return Py_BuildValue("{s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N,s:N}",
+                         "time", analysis_make_column(c.time, "d"),
+                         "slots", analysis_make_column(c.slots, "Q"),
+                         "tbs", analysis_make_column(c.tbs, "Q"),
+                         "retx_tbs", analysis_make_column(c.retx_tbs, "Q"),
+                         "failed_tbs", analysis_make_column(c.failed_tbs, "Q"),
+                         "harq_failures", analysis_make_column(c.harq_failures, "Q"),
+                         "bytes", analysis_make_column(c.bytes, "Q"),
+                         "retx_bytes", analysis_make_column(c.retx_bytes, "Q"),
+                         "bler", analysis_make_column(c.bler, "d"));
+}
+
+static PyObject *
+nr_mac_tput_collect () {
+    PyObject *series = PyDict_New();
+    for (NrMacTputSeriesMap::iterator it = g_series.begin(); it != g_series.end(); ++it) {
+        close_window(it->second);
+        if (it->second.columns.time.empty())
+            continue;
+        PyObject *key = Py_BuildValue("(si)", NrMacTputDirectionNames[it->first.direction],
+                                      it->first.carrier);
+        PyObject *columns = build_columns(it->second.columns);
+        PyDict_SetItem(series, key, columns);
+        Py_DECREF(key);
+        Py_DECREF(columns);
+        it->second.columns = NrMacTputColumns();
+    }
+    return Py_BuildValue("{s:d,s:N}",
+                         "granularity", g_granularity_ms / 1000.0,
+                         "series", series);
+}
+
+AnalysisEngine NrMacTputEngine = {
+    "nr_mac_tput",
+    false,
+    nr_mac_tput_configure,
+    nr_mac_tput_collect,
+};
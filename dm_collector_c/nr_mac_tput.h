@@ -0,0 +1,63 @@
+/* nr_mac_tput.h
+ * Analysis engine "nr_mac_tput": sums the records of NR_MAC_PDSCH_Stats and
+ * NR_MAC_UL_TB_Stats over fixed time windows, as throughput, HARQ and BLER
+ * time series.
+ *
+ * The records count the transport blocks of the slots elapsed since the
+ * previous packet; they carry no SFN or slot, so they are timed by their log
+ * packet. Series are keyed by
+ *     (direction, carrier)
+ * where direction is "UL" or "DL", and carrier the logged Carrier ID for DL
+ * and the index of the record for UL. Every series has the columns
+ * (memoryviews of copies of the series, which numpy.asarray() takes without
+ * copying again)
+ *     time (d): start of the window, in seconds since the Unix epoch
+ *     slots (Q): slots elapsed (DL only); with packets covering the window,
+ *                slots / (1000 * granularity) is 2 ** numerology
+ *     tbs (Q): transport blocks, DL decoded (CRC passed or failed), UL sent
+ *              (new and retransmitted)
+ *     retx_tbs (Q): retransmitted transport blocks
+ *     failed_tbs (Q): DL transport blocks that failed their CRC, UL
+ *                     retransmitted ones (each follows a NACK)
+ *     harq_failures (Q): DL HARQ failures (DL only)
+ *     bytes (Q): DL bytes of the blocks that passed their CRC, UL bytes of
+ *                new transmissions
+ *     retx_bytes (Q): bytes of the retransmissions
+ *     bler (d): failed_tbs / tbs, or 0 without transport blocks
+ * with a row per window that has records. Throughput over a window is
+ * bytes * 8 / granularity. The window in progress is closed by
+ * collect_engine().
+ *
+ * Options:
+ *     granularity: seconds per window, at least 0.001. Default 1.0
+ *
+ * collect_engine() returns
+ *     {"granularity": seconds, "series": {key: {column: memoryview}}}
+ */
+
+#ifndef __DM_COLLECTOR_C_NR_MAC_TPUT_H__
+#define __DM_COLLECTOR_C_NR_MAC_TPUT_H__
+
+#include "analysis_engine.h"
+
+enum NrMacTputDirection {
+    NR_MAC_TPUT_UL = 0,
+    NR_MAC_TPUT_DL = 1,
+};
+
+// The counters of a record, see the columns of the same names
+struct NrMacTputStats {
+    unsigned long long slots;
+    unsigned long long tbs;
+    unsigned long long retx_tbs;
+    unsigned long long failed_tbs;
+    unsigned long long harq_failures;
+    unsigned long long bytes;
+    unsigned long long retx_bytes;
+};
+
+extern AnalysisEngine NrMacTputEngine;
+
+void nr_mac_tput_on_stats (int direction, int carrier, const NrMacTputStats &stats);
+
+#endif // __DM_COLLECTOR_C_NR_MAC_TPUT_H__
@@ -0,0 +1,239 @@
+/* nr_mac_ul_pcsr_columns.cpp
+ * Implements the "nr_mac_ul_pcsr_columns" analysis engine.
+ */
+
+#include "nr_mac_ul_pcsr_columns.h"
+
+#include <vector>
+
+#define NR_UL_PCSR_DEFAULT_MAX_ROWS 1000000
+
+struct NrUlPcsrColumnDef {
+    const char *name;
+    char format;    // h or i
+};
+
+// Indexed by NrUlPcsrCarrierColumn
+static const NrUlPcsrColumnDef NrUlPcsrCarrierColumnDefs[NR_UL_PCSR_NUM_CARRIER_COLUMNS] = {
+    {"frame", 'i'},
+    {"slot", 'h'},
+    {"numerology", 'h'},
+    {"carrier_id", 'h'},
+    {"rnti_type", 'h'},
+};
+
+// Indexed by NrUlPcsrPuschColumn
+static const NrUlPcsrColumnDef NrUlPcsrPuschColumnDefs[NR_UL_PCSR_PUSCH_NUM_COLUMNS] = {
+    {"is_second_phychan", 'h'},
+    {"start_symbol", 'h'},
+    {"num_symbols", 'h'},
+    {"harq_id", 'h'},
+    {"mcs", 'h'},
+    {"mcs_table", 'h'},
+    {"dmrs_add_pos", 'h'},
+    {"rb_start", 'h'},
+    {"num_rbs", 'h'},
+    {"ra_type", 'h'},
+    {"mapping_type", 'h'},
+    {"tb_size", 'i'},
+    {"tx_mode", 'h'},
+    {"rv_index", 'h'},
+    {"tx_type", 'h'},
+    {"bwp_idx", 'h'},
+    {"code_rate", 'i'},
+    {"num_csf_p1_bits", 'h'},
+    {"num_csf_p2_bits", 'h'},
+    {"num_harq_ack_bits", 'h'},
+    {"transform_precoding", 'h'},
+    {"num_cbs", 'h'},
+    {"cb_size", 'i'},
+    {"tx_slot_offset", 'h'},
+    {"tpmi", 'h'},
+    {"mod_type", 'h'},
+    {"rnti_value", 'i'},
+};
+
+// Indexed by NrUlPcsrPucchColumn
+static const NrUlPcsrColumnDef NrUlPcsrPucchColumnDefs[NR_UL_PCSR_PUCCH_NUM_COLUMNS] = {
+    {"is_second_phychan", 'h'},
+    {"pucch_format", 'h'},
+    {"uci_request_bmask", 'h'},
+    {"start_symbol", 'h'},
+    {"num_symbols", 'h'},
+    {"starting_rb", 'h'},
+    {"num_rb", 'h'},
+    {"freq_hopping_flag", 'h'},
+    {"second_hop_rb", 'h'},
+    {"num_harq_ack_bits", 'h'},
+    {"num_sr_bits", 'h'},
+    {"num_uci_p1_bits", 'h'},
+    {"num_uci_p2_bits", 'i'},
+    {"m0", 'h'},
+    {"i_dmrs", 'h'},
+};
+
+// Indexed by NrUlPcsrPrachColumn
+static const NrUlPcsrColumnDef NrUlPcsrPrachColumnDefs[NR_UL_PCSR_PRACH_NUM_COLUMNS] = {
+    {"resource_allocation", 'h'},
+    {"zc_root_seq", 'h'},
+    {"preamble_format", 'h'},
+    {"symbol_offset", 'h'},
+    {"prach_numerology", 'h'},
+    {"prach_number", 'h'},
+    {"zc_cyclic_shift", 'i'},
+};
+
+struct NrUlPcsrTableDef {
+    const char *name;
+    const NrUlPcsrColumnDef *columns;
+    int n_columns;
+};
+
+// Indexed by NrUlPcsrTable
+static const NrUlPcsrTableDef NrUlPcsrTableDefs[NR_UL_PCSR_NUM_TABLES] = {
+    {"pusch", NrUlPcsrPuschColumnDefs, NR_UL_PCSR_PUSCH_NUM_COLUMNS},
+    {"pucch", NrUlPcsrPucchColumnDefs, NR_UL_PCSR_PUCCH_NUM_COLUMNS},
+    {"srs", NULL, 0},
+    {"prach", NrUlPcsrPrachColumnDefs, NR_UL_PCSR_PRACH_NUM_COLUMNS},
+};
+
+// The rows of a table. The buffers keep their capacity across collects.
+struct NrUlPcsrRows {
+    std::vector<double> time;
+    std::vector<short> version;
+    // Raw items of the columns, in their formats
+    std::vector<char> carrier[NR_UL_PCSR_NUM_CARRIER_COLUMNS];
+    std::vector<char> columns[NR_UL_PCSR_MAX_COLUMNS];
+    size_t n;
+};
+
+static NrUlPcsrRows g_tables[NR_UL_PCSR_NUM_TABLES];
+static unsigned long long g_dropped_rows = 0;
+static size_t g_max_rows = NR_UL_PCSR_DEFAULT_MAX_ROWS;
+static bool g_records = true;
+
+static size_t
+get_item_size (char format) {
+    return format == 'h' ? sizeof(short) : sizeof(int);
+}
+
+static void
+append_item (std::vector<char> &column, char format, long long value) {
+    long long v = (value == NR_UL_PCSR_MISSING) ? -1 : value;
+    if (format == 'h') {
+        short item = (short) v;
+        const char *p = (const char *) &item;
+        column.insert(column.end(), p, p + sizeof(item));
+    } else {
+        int item = (int) v;
+        const char *p = (const char *) &item;
+        column.insert(column.end(), p, p + sizeof(item));
+    }
+}
+
+void
+nr_ul_pcsr_columns_on_row (int table, int version,
+                           const long long carrier[NR_UL_PCSR_NUM_CARRIER_COLUMNS],
+                           const long long *values) {
+    if (!NrMacUlPcsrColumnsEngine.enabled)
+        return;
+    NrUlPcsrRows &rows = g_tables[table];
+    if (rows.n >= g_max_rows) {
+        g_dropped_rows++;
+        return;
+    }
+    rows.time.push_back(analysis_packet_time());
+    rows.version.push_back((short) version);
+    for (int i = 0; i < NR_UL_PCSR_NUM_CARRIER_COLUMNS; i++)
+        append_item(rows.carrier[i], NrUlPcsrCarrierColumnDefs[i].format, carrier[i]);
+    const NrUlPcsrTableDef &def = NrUlPcsrTableDefs[table];
+    for (int i = 0; i < def.n_columns; i++)
+        append_item(rows.columns[i], def.columns[i].format, values[i]);
+    rows.n++;
+}
+
+bool
+nr_ul_pcsr_columns_skip_records () {
+    return NrMacUlPcsrColumnsEngine.enabled && !g_records;
+}
+
+static void
+clear_rows () {
+    for (int t = 0; t < NR_UL_PCSR_NUM_TABLES; t++) {
+        NrUlPcsrRows &rows = g_tables[t];
+        rows.time.clear();
+        rows.version.clear();
+        for (int i = 0; i < NR_UL_PCSR_NUM_CARRIER_COLUMNS; i++)
+            rows.carrier[i].clear();
+        for (int i = 0; i < NR_UL_PCSR_MAX_COLUMNS; i++)
+            rows.columns[i].clear();
+        rows.n = 0;
+    }
+    g_dropped_rows = 0;
+}
+
+static bool
+nr_mac_ul_pcsr_columns_configure (PyObject *options) {
+    bool records = true;
+    long long max_rows = NR_UL_PCSR_DEFAULT_MAX_ROWS;
+    if (!analysis_get_bool_option(options, "records", &records)
+            || !analysis_get_int_option(options, "max_rows", &max_rows))
+        return false;
+    if (max_rows < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_rows must not be negative");
+        return false;
+    }
+    clear_rows();
+    g_records = records;
+    g_max_rows = (size_t) max_rows;
+    return true;
+}
+
+static void
+set_column (PyObject *columns, const NrUlPcsrColumnDef &def, std::vector<char> &items) {
+    char format[2] = {def.format, '\0'};
+    PyObject *column = analysis_take_column(items, format, get_item_size(def.format));
+    PyDict_SetItemString(columns, def.name, column);
+    Py_DECREF(column);
+}
+
+// The columns take the rows of the table, without copying them
+static PyObject *
+build_table (int table) {
+    NrUlPcsrRows &rows = g_tables[table];
+    const NrUlPcsrTableDef &def = NrUlPcsrTableDefs[table];
+    PyObject *columns = PyDict_New();
+    PyObject *column = analysis_take_column(rows.time, "d");
+    PyDict_SetItemString(columns, "time", column);
+    Py_DECREF(column);
+    column = analysis_take_column(rows.version, "h");
+    PyDict_SetItemString(columns, "version", column);
+    Py_DECREF(column);
+    for (int i = 0; i < NR_UL_PCSR_NUM_CARRIER_COLUMNS; i++)
+        set_column(columns, NrUlPcsrCarrierColumnDefs[i], rows.carrier[i]);
+    for (int i = 0; i < def.n_columns; i++)
+        set_column(columns, def.columns[i], rows.columns[i]);
+    return columns;
+}
+
+static PyObject *
+nr_mac_ul_pcsr_columns_collect () {
+    PyObject *tables = PyDict_New();
+    for (int t = 0; t < NR_UL_PCSR_NUM_TABLES; t++) {
+        PyObject *columns = build_table(t);
+        PyDict_SetItemString(tables, NrUlPcsrTableDefs[t].name, columns);
+        Py_DECREF(columns);
+    }
+    PyObject *ret = Py_BuildValue("{s:N,s:K}",
+                                  "tables", tables,
+                                  "dropped_rows", g_dropped_rows);
+    clear_rows();
+    return ret;
+}
+
+AnalysisEngine NrMacUlPcsrColumnsEngine = {
+    "nr_mac_ul_pcsr_columns",
+    false,
+    nr_mac_ul_pcsr_columns_configure,
+    nr_mac_ul_pcsr_columns_collect,
+};
@@ -0,0 +1,149 @@
+/* nr_mac_ul_pcsr_columns.h
+ * Analysis engine "nr_mac_ul_pcsr_columns": collects the scheduled channels of
+ * NR_MAC_UL_Physical_Channel_Schedule_Report as tables of columns, one per
+ * channel type, filled by the C decoder.
+ *
+ * Every table has a row per scheduled channel (a row per PUCCH for "pucch"),
+ * with the columns of its carrier (memoryviews that take over the rows of the
+ * engine, so that no copy is made from the decoder to numpy.asarray();
+ * numpy.rec.fromarrays() makes a structured array of them)
+ *     time (d): log packet time, in seconds since the Unix epoch
+ *     version (h): major * 100 + minor, e.g. 211 for 2.11
+ *     frame (i), slot (h), numerology (h), carrier_id (h), rnti_type (h)
+ * followed by the columns of the table. Fields that the version of a packet
+ * lacks are -1. Values are those of the decoded packets, except that named
+ * values are left as numbers and that "NA" is -1.
+ *     "pusch": is_second_phychan (h), start_symbol (h), num_symbols (h),
+ *              harq_id (h), mcs (h), mcs_table (h), dmrs_add_pos (h),
+ *              rb_start (h), num_rbs (h), ra_type (h), mapping_type (h),
+ *              tb_size (i): bytes, tx_mode (h), rv_index (h), tx_type (h),
+ *              bwp_idx (h), code_rate (i), num_csf_p1_bits (h),
+ *              num_csf_p2_bits (h), num_harq_ack_bits (h),
+ *              transform_precoding (h), num_cbs (h), cb_size (i),
+ *              tx_slot_offset (h), tpmi (h), mod_type (h), rnti_value (i)
+ *     "pucch": is_second_phychan (h), pucch_format (h),
+ *              uci_request_bmask (h), start_symbol (h), num_symbols (h),
+ *              starting_rb (h), num_rb (h), freq_hopping_flag (h),
+ *              second_hop_rb (h), num_harq_ack_bits (h), num_sr_bits (h),
+ *              num_uci_p1_bits (h), num_uci_p2_bits (i), m0 (h), i_dmrs (h)
+ *     "srs":   no more columns, as the SRS fields are not decoded yet
+ *     "prach": resource_allocation (h), zc_root_seq (h),
+ *              preamble_format (h), symbol_offset (h),
+ *              prach_numerology (h), prach_number (h), zc_cyclic_shift (i)
+ * Version 2.8 has PUSCH, PUCCH and SRS, of which only part of the PUSCH
+ * fields are decoded; version 2.11 has PUSCH, PUCCH and PRACH.
+ *
+ * Options:
+ *     records:  keep the "Records" of the decoded packets. With False, only
+ *               the tables are filled. Default True
+ *     max_rows: rows kept per table between two collect_engine() calls; more
+ *               are counted as "dropped_rows". Default 1000000
+ *
+ * collect_engine() returns
+ *     {"tables": {table: {column: memoryview}}, "dropped_rows": n}
+ */
+
+#ifndef __DM_COLLECTOR_C_NR_MAC_UL_PCSR_COLUMNS_H__
+#define __DM_COLLECTOR_C_NR_MAC_UL_PCSR_COLUMNS_H__
+
+#include "analysis_engine.h"
+
+#include <climits>
+
+// Value of fields that a version lacks
+#define NR_UL_PCSR_MISSING LLONG_MIN
+
+enum NrUlPcsrTable {
+    NR_UL_PCSR_PUSCH,
+    NR_UL_PCSR_PUCCH,
+    NR_UL_PCSR_SRS,
+    NR_UL_PCSR_PRACH,
+    NR_UL_PCSR_NUM_TABLES
+};
+
+// Columns of the carrier of a row, after time and version
+enum NrUlPcsrCarrierColumn {
+    NR_UL_PCSR_FRAME,
+    NR_UL_PCSR_SLOT,
+    NR_UL_PCSR_NUMEROLOGY,
+    NR_UL_PCSR_CARRIER_ID,
+    NR_UL_PCSR_RNTI_TYPE,
+    NR_UL_PCSR_NUM_CARRIER_COLUMNS
+};
+
+enum NrUlPcsrPuschColumn {
+    NR_UL_PCSR_PUSCH_IS_SECOND_PHYCHAN,
+    NR_UL_PCSR_PUSCH_START_SYMBOL,
+    NR_UL_PCSR_PUSCH_NUM_SYMBOLS,
+    NR_UL_PCSR_PUSCH_HARQ_ID,
+    NR_UL_PCSR_PUSCH_MCS,
+    NR_UL_PCSR_PUSCH_MCS_TABLE,
+    NR_UL_PCSR_PUSCH_DMRS_ADD_POS,
+    NR_UL_PCSR_PUSCH_RB_START,
+    NR_UL_PCSR_PUSCH_NUM_RBS,
+    NR_UL_PCSR_PUSCH_RA_TYPE,
+    NR_UL_PCSR_PUSCH_MAPPING_TYPE,
+    NR_UL_PCSR_PUSCH_TB_SIZE,
+    NR_UL_PCSR_PUSCH_TX_MODE,
+    NR_UL_PCSR_PUSCH_RV_INDEX,
+    NR_UL_PCSR_PUSCH_TX_TYPE,
+    NR_UL_PCSR_PUSCH_BWP_IDX,
+    NR_UL_PCSR_PUSCH_CODE_RATE,
+    NR_UL_PCSR_PUSCH_NUM_CSF_P1_BITS,
+    NR_UL_PCSR_PUSCH_NUM_CSF_P2_BITS,
+    NR_UL_PCSR_PUSCH_NUM_HARQ_ACK_BITS,
+    NR_UL_PCSR_PUSCH_TRANSFORM_PRECODING,
+    NR_UL_PCSR_PUSCH_NUM_CBS,
+    NR_UL_PCSR_PUSCH_CB_SIZE,
+    NR_UL_PCSR_PUSCH_TX_SLOT_OFFSET,
+    NR_UL_PCSR_PUSCH_TPMI,
+    NR_UL_PCSR_PUSCH_MOD_TYPE,
+    NR_UL_PCSR_PUSCH_RNTI_VALUE,
+    NR_UL_PCSR_PUSCH_NUM_COLUMNS
+};
+
+enum NrUlPcsrPucchColumn {
+    NR_UL_PCSR_PUCCH_IS_SECOND_PHYCHAN,
+    NR_UL_PCSR_PUCCH_PUCCH_FORMAT,
+    NR_UL_PCSR_PUCCH_UCI_REQUEST_BMASK,
+    NR_UL_PCSR_PUCCH_START_SYMBOL,
+    NR_UL_PCSR_PUCCH_NUM_SYMBOLS,
+    NR_UL_PCSR_PUCCH_STARTING_RB,
+    NR_UL_PCSR_PUCCH_NUM_RB,
+    NR_UL_PCSR_PUCCH_FREQ_HOPPING_FLAG,
+    NR_UL_PCSR_PUCCH_SECOND_HOP_RB,
+    NR_UL_PCSR_PUCCH_NUM_HARQ_ACK_BITS,
+    NR_UL_PCSR_PUCCH_NUM_SR_BITS,
+    NR_UL_PCSR_PUCCH_NUM_UCI_P1_BITS,
+    NR_UL_PCSR_PUCCH_NUM_UCI_P2_BITS,
+    NR_UL_PCSR_PUCCH_M0,
+    NR_UL_PCSR_PUCCH_I_DMRS,
+    NR_UL_PCSR_PUCCH_NUM_COLUMNS
+};
+
+enum NrUlPcsrPrachColumn {
+    NR_UL_PCSR_PRACH_RESOURCE_ALLOCATION,
+    NR_UL_PCSR_PRACH_ZC_ROOT_SEQ,
+    NR_UL_PCSR_PRACH_PREAMBLE_FORMAT,
+    NR_UL_PCSR_PRACH_SYMBOL_OFFSET,
+    NR_UL_PCSR_PRACH_NUMEROLOGY,
+    NR_UL_PCSR_PRACH_PRACH_NUMBER,
+    NR_UL_PCSR_PRACH_ZC_CYCLIC_SHIFT,
+    NR_UL_PCSR_PRACH_NUM_COLUMNS
+};
+
+// Most columns of a table, after the carrier ones
+#define NR_UL_PCSR_MAX_COLUMNS NR_UL_PCSR_PUSCH_NUM_COLUMNS
+
+extern AnalysisEngine NrMacUlPcsrColumnsEngine;
+
+// A row of a table, with the values of its carrier indexed by
+// NrUlPcsrCarrierColumn, and its own values by the column enum of the table
+void nr_ul_pcsr_columns_on_row (int table, int version,
+                                const long long carrier[NR_UL_PCSR_NUM_CARRIER_COLUMNS],
+                                const long long *values);
+
+// Return: whether the decoder should leave out the records
+bool nr_ul_pcsr_columns_skip_records ();
+
+#endif // __DM_COLLECTOR_C_NR_MAC_UL_PCSR_COLUMNS_H__
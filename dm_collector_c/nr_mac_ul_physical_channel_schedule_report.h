@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "nr_mac_ul_pcsr_columns.h"
 #include <string>
 
 
@@ -780,6 +781,356 @@ _decode_nr_mac_ul_pcsr_records_v2_11(const char* b, int offset, size_t length,
 
 
 
+// A PUSCH column of version 2.8: bits [lsb, lsb + bits) of "PUSCH Raw Data",
+// as the substrings that the decoder reads
+struct NrUlPcsrBitField {
+    int column;     // NrUlPcsrPuschColumn
+    int lsb;
+    int bits;
+};
+
+const NrUlPcsrBitField NrMacUlSchedPUSCHFields_v2_8 [] = {
+    {NR_UL_PCSR_PUSCH_IS_SECOND_PHYCHAN, 0, 4},
+    {NR_UL_PCSR_PUSCH_START_SYMBOL, 4, 1},
+    {NR_UL_PCSR_PUSCH_NUM_SYMBOLS, 5, 4},
+    {NR_UL_PCSR_PUSCH_HARQ_ID, 9, 4},
+    {NR_UL_PCSR_PUSCH_MCS, 13, 5},
+    {NR_UL_PCSR_PUSCH_DMRS_ADD_POS, 18, 6},
+    {NR_UL_PCSR_PUSCH_RB_START, 24, 8},
+    {NR_UL_PCSR_PUSCH_NUM_RBS, 32, 9},
+    {NR_UL_PCSR_PUSCH_RA_TYPE, 41, 1},
+    {NR_UL_PCSR_PUSCH_TB_SIZE, 43, 14},
+    {NR_UL_PCSR_PUSCH_CODE_RATE, 76, 11},
+};
+
+// Bits [lsb, lsb + bits) of a little endian bit stream
+static long long
+_read_bits_le (const char *p, int lsb, int bits) {
+    long long v = 0;
+    for (int k = lsb + bits - 1; k >= lsb; k--)
+        v = (v << 1) | ((p[k / 8] >> (k % 8)) & 1);
+    return v;
+}
+
+// Byte offsets of the named fields of a Fmt table
+static void
+_resolve_fmt_offsets (const Fmt fmt[], int n_fmt, const char *const names[],
+                      int n, int at[]) {
+    for (int i = 0; i < n; i++)
+        at[i] = _fmt_offset(fmt, n_fmt, names[i]);
+}
+
+static void
+_read_nr_mac_ul_pcsr_pusch_v2_11 (const char *p, long long values[]) {
+    enum {IS_SECOND, NUM_SYMBOLS, MCS, RB_START, NUM_RBS, TB_SIZE, TX_MODE,
+          TX_TYPE, CODE_RATE, CSF_P1, CSF_P2, HARQ_ACK, NUM_CBS, CB_SIZE,
+          TX_SLOT_OFFSET, TPC_ACCUM_1, TPMI, RB_START_HOP, RNTI_VALUE, N_AT};
+    static const char *const names[N_AT] = {
+        "Is Second Phychan", "Num Symbols", "MCS", "RB Start", "Num RBs",
+        "TB Size( bytes)", "TX Mode", "TX Type", "Code Rate",
+        "Num CSF P1 Bits", "Num CSF P2 Bits", "Num HARQ ACK Bits", "Num CBs",
+        "CB Size", "Tx Slot Offset", "TPC Accum 1", "TPMI", "RB Start Hop",
+        "RNTI Value",
+    };
+    static int at[N_AT];
+    static bool resolved = false;
+    if (!resolved) {
+        _resolve_fmt_offsets(NrMacUlPhyChannelSchedulePUSCH_Fmt_v2_11,
+                ARRAY_SIZE(NrMacUlPhyChannelSchedulePUSCH_Fmt_v2_11, Fmt),
+                names, N_AT, at);
+        resolved = true;
+    }
+    int tmp = (unsigned char) p[at[IS_SECOND]];
+    values[NR_UL_PCSR_PUSCH_IS_SECOND_PHYCHAN] = tmp & 0b1;
+    values[NR_UL_PCSR_PUSCH_START_SYMBOL] = (tmp >> 1) & 0x0f;
+    int tmp2 = (unsigned char) p[at[NUM_SYMBOLS]];
+    values[NR_UL_PCSR_PUSCH_NUM_SYMBOLS] = ((tmp2 & 0b1) << 3) + ((tmp >> 5) & 0b111);
+    values[NR_UL_PCSR_PUSCH_HARQ_ID] = (tmp2 >> 1) & 0x0f;
+    tmp = (unsigned char) p[at[MCS]];
+    values[NR_UL_PCSR_PUSCH_MCS] = ((tmp & 0b1) << 3) + ((tmp2 >> 5) & 0b111);
+    values[NR_UL_PCSR_PUSCH_MCS_TABLE] = (tmp >> 1) & 0x0f;
+    values[NR_UL_PCSR_PUSCH_DMRS_ADD_POS] = (tmp >> 5) & 0b11;
+    tmp2 = (unsigned char) p[at[RB_START]];
+    values[NR_UL_PCSR_PUSCH_RB_START] = (tmp2 << 1) + (tmp >> 7);
+    tmp = _read_uint_le(p + at[NUM_RBS], 2);
+    values[NR_UL_PCSR_PUSCH_NUM_RBS] = tmp & 0x1ff;
+    values[NR_UL_PCSR_PUSCH_RA_TYPE] = (tmp >> 9) & 0b1;
+    values[NR_UL_PCSR_PUSCH_MAPPING_TYPE] = (tmp >> 10) & 0b1;
+    tmp2 = _read_uint_le(p + at[TB_SIZE], 2);
+    values[NR_UL_PCSR_PUSCH_TB_SIZE] = ((tmp2 & 0x1fff) << 5) + (tmp >> 3);
+    tmp = (unsigned char) p[at[TX_MODE]];
+    values[NR_UL_PCSR_PUSCH_TX_MODE] = tmp & 0b11;
+    values[NR_UL_PCSR_PUSCH_RV_INDEX] = (tmp >> 2) & 0b111;
+    tmp = (unsigned char) p[at[TX_TYPE]];
+    values[NR_UL_PCSR_PUSCH_TX_TYPE] = tmp & 0b11;
+    values[NR_UL_PCSR_PUSCH_BWP_IDX] = (tmp >> 2) & 0b11;
+    tmp2 = _read_uint_le(p + at[CODE_RATE], 2);
+    values[NR_UL_PCSR_PUSCH_CODE_RATE] = ((tmp2 & 0xfff) << 4) + (tmp >> 4);
+    tmp = _read_uint_le(p + at[CSF_P1], 2);
+    values[NR_UL_PCSR_PUSCH_NUM_CSF_P1_BITS] = tmp & 0x3ff;
+    tmp2 = (unsigned char) p[at[CSF_P2]];
+    values[NR_UL_PCSR_PUSCH_NUM_CSF_P2_BITS] = (tmp2 << 6) + (tmp >> 10);
+    tmp = (unsigned char) p[at[HARQ_ACK]];
+    values[NR_UL_PCSR_PUSCH_NUM_HARQ_ACK_BITS] = tmp & 0x3f;
+    values[NR_UL_PCSR_PUSCH_TRANSFORM_PRECODING] = (tmp >> 6) & 0b11;
+    values[NR_UL_PCSR_PUSCH_NUM_CBS] = (unsigned char) p[at[NUM_CBS]];
+    values[NR_UL_PCSR_PUSCH_CB_SIZE] = _read_uint_le(p + at[CB_SIZE], 2) & 0x7fff;
+    values[NR_UL_PCSR_PUSCH_TX_SLOT_OFFSET] = p[at[TX_SLOT_OFFSET]] & 0x3f;
+    tmp = (unsigned char) p[at[TPC_ACCUM_1]];
+    tmp2 = (unsigned char) p[at[TPMI]];
+    values[NR_UL_PCSR_PUSCH_TPMI] = ((tmp2 & 0b111) << 2) + (tmp >> 6);
+    values[NR_UL_PCSR_PUSCH_MOD_TYPE] = ((unsigned char) p[at[RB_START_HOP]]) >> 5;
+    values[NR_UL_PCSR_PUSCH_RNTI_VALUE] = _read_uint_le(p + at[RNTI_VALUE], 2);
+}
+
+static void
+_read_nr_mac_ul_pcsr_per_pucch_v2_11 (const char *p, long long values[]) {
+    enum {IS_SECOND, START_SYMBOL, STARTING_RB, NUM_RB, FREQ_HOPPING,
+          SECOND_HOP_RB, HARQ_ACK, UCI_P1, UCI_P2, M0, I_DMRS, N_AT};
+    static const char *const names[N_AT] = {
+        "Is Second Phychan", "Start symbol", "Starting RB", "Num RB",
+        "Freq Hopping Flag", "Second Hop RB", "Num HARQ ACK Bits",
+        "Num UCI P1 Bits", "Num UCI P2 Bits", "M0", "I DMRS",
+    };
+    static int at[N_AT];
+    static bool resolved = false;
+    if (!resolved) {
+        _resolve_fmt_offsets(NrMacUlPhyChannelSchedulePerPUCCH_Fmt_v2_11,
+                ARRAY_SIZE(NrMacUlPhyChannelSchedulePerPUCCH_Fmt_v2_11, Fmt),
+                names, N_AT, at);
+        resolved = true;
+    }
+    int tmp = (unsigned char) p[at[IS_SECOND]];
+    values[NR_UL_PCSR_PUCCH_IS_SECOND_PHYCHAN] = tmp & 0b1;
+    values[NR_UL_PCSR_PUCCH_PUCCH_FORMAT] = (tmp >> 1) & 0x0f;
+    values[NR_UL_PCSR_PUCCH_UCI_REQUEST_BMASK] = (tmp >> 5) & 0x0f;
+    tmp = (unsigned char) p[at[START_SYMBOL]];
+    values[NR_UL_PCSR_PUCCH_START_SYMBOL] = tmp & 0x0f;
+    values[NR_UL_PCSR_PUCCH_NUM_SYMBOLS] = (tmp >> 4) & 0x0f;
+    values[NR_UL_PCSR_PUCCH_STARTING_RB] = _read_uint_le(p + at[STARTING_RB], 2) & 0x3ff;
+    values[NR_UL_PCSR_PUCCH_NUM_RB] = (unsigned char) p[at[NUM_RB]];
+    tmp = (unsigned char) p[at[FREQ_HOPPING]];
+    values[NR_UL_PCSR_PUCCH_FREQ_HOPPING_FLAG] = tmp & 0b111;
+    int tmp2 = (unsigned char) p[at[SECOND_HOP_RB]];
+    int value = ((tmp2 & 0x0f) << 5) + (tmp >> 3);
+    values[NR_UL_PCSR_PUCCH_SECOND_HOP_RB] = (value == 0x1ff) ? -1 : value;
+    tmp = (unsigned char) p[at[HARQ_ACK]];
+    values[NR_UL_PCSR_PUCCH_NUM_HARQ_ACK_BITS] = ((tmp & 0b11) << 4) + (tmp2 >> 4);
+    values[NR_UL_PCSR_PUCCH_NUM_SR_BITS] = tmp >> 2;
+    tmp = _read_uint_le(p + at[UCI_P1], 2);
+    values[NR_UL_PCSR_PUCCH_NUM_UCI_P1_BITS] = tmp & 0x3ff;
+    tmp2 = _read_uint_le(p + at[UCI_P2], 2);
+    values[NR_UL_PCSR_PUCCH_NUM_UCI_P2_BITS] = ((tmp2 & 0x3ff) << 6) + (tmp >> 10);
+    tmp = (unsigned char) p[at[M0]];
+    values[NR_UL_PCSR_PUCCH_M0] = tmp & 0x0f;
+    tmp2 = (unsigned char) p[at[I_DMRS]];
+    values[NR_UL_PCSR_PUCCH_I_DMRS] = ((tmp2 & 0b11) << 2) + (tmp >> 6);
+}
+
+static void
+_read_nr_mac_ul_pcsr_prach_v2_11 (const char *p, long long values[]) {
+    enum {RESOURCE_ALLOCATION, ZC_ROOT_SEQ, SYMBOL_OFFSET, PRACH_NUMBER,
+          ZC_CYCLIC_SHIFT, N_AT};
+    static const char *const names[N_AT] = {
+        "Resource Allocation", "ZC Root Seq", "Symbol Offset", "PRACH Number",
+        "ZC Cyclic Shift",
+    };
+    static int at[N_AT];
+    static bool resolved = false;
+    if (!resolved) {
+        _resolve_fmt_offsets(NrMacUlPhyChannelSchedulePrach_Fmt_v2_11,
+                ARRAY_SIZE(NrMacUlPhyChannelSchedulePrach_Fmt_v2_11, Fmt),
+                names, N_AT, at);
+        resolved = true;
+    }
+    int tmp = _read_uint_le(p + at[RESOURCE_ALLOCATION], 2);
+    values[NR_UL_PCSR_PRACH_RESOURCE_ALLOCATION] = tmp & 0x1ff;
+    int tmp2 = (unsigned char) p[at[ZC_ROOT_SEQ]];
+    values[NR_UL_PCSR_PRACH_ZC_ROOT_SEQ] = ((tmp2 & 0b11) << 7) + (tmp >> 9);
+    values[NR_UL_PCSR_PRACH_PREAMBLE_FORMAT] = tmp2 >> 2;
+    tmp = (unsigned char) p[at[SYMBOL_OFFSET]];
+    values[NR_UL_PCSR_PRACH_SYMBOL_OFFSET] = tmp & 0x0f;
+    values[NR_UL_PCSR_PRACH_NUMEROLOGY] = (tmp >> 4) & 0b11;
+    tmp = _read_uint_le(p + at[PRACH_NUMBER], 2);
+    values[NR_UL_PCSR_PRACH_PRACH_NUMBER] = tmp & 0x1ff;
+    tmp2 = _read_uint_le(p + at[ZC_CYCLIC_SHIFT], 2);
+    values[NR_UL_PCSR_PRACH_ZC_CYCLIC_SHIFT] = ((tmp2 & 0x1ff) << 7) + (tmp >> 9);
+}
+
+// Emit a row of a table, with its own values all missing
+static void
+_emit_nr_mac_ul_pcsr_empty_row (int table, int version, const long long carrier[]) {
+    long long values[NR_UL_PCSR_MAX_COLUMNS];
+    for (int k = 0; k < NR_UL_PCSR_MAX_COLUMNS; k++)
+        values[k] = NR_UL_PCSR_MISSING;
+    nr_ul_pcsr_columns_on_row(table, version, carrier, values);
+}
+
+// Walk the records of version 2.8 (with emit, emitting their rows).
+// Return: the bytes of the records, or -1 if they overrun the packet
+static int
+_walk_nr_mac_ul_pcsr_v2_8 (const char *b, int offset, size_t length,
+        int version, int n_records, bool emit) {
+    int start = offset;
+    int record_size = _fmt_offset(NrMacUlSchedRecord_v2_8,
+            ARRAY_SIZE(NrMacUlSchedRecord_v2_8, Fmt), NULL);
+    int carrier_size = _fmt_offset(NrMacUlSchedCarrierRecord_v2_8,
+            ARRAY_SIZE(NrMacUlSchedCarrierRecord_v2_8, Fmt), NULL);
+    int pusch_size = _fmt_offset(NrMacUlSchedPUSCHRecord_v2_8,
+            ARRAY_SIZE(NrMacUlSchedPUSCHRecord_v2_8, Fmt), NULL);
+    int pucch_size = _fmt_offset(NrMacUlSchedPUCCHRecord_v2_8,
+            ARRAY_SIZE(NrMacUlSchedPUCCHRecord_v2_8, Fmt), NULL);
+    int srs_size = _fmt_offset(NrMacUlSchedSrsRecord_v2_8,
+            ARRAY_SIZE(NrMacUlSchedSrsRecord_v2_8, Fmt), NULL);
+    for (int i = 0; i < n_records; i++) {
+        if (offset + record_size > (int) length)
+            return -1;
+        long long carrier[NR_UL_PCSR_NUM_CARRIER_COLUMNS];
+        carrier[NR_UL_PCSR_SLOT] = (unsigned char) b[offset];
+        carrier[NR_UL_PCSR_NUMEROLOGY] = (unsigned char) b[offset + 1];
+        carrier[NR_UL_PCSR_FRAME] = _read_uint_le(b + offset + 2, 2);
+        carrier[NR_UL_PCSR_RNTI_TYPE] = NR_UL_PCSR_MISSING;
+        int n_carriers = (unsigned char) b[offset + 4];
+        offset += record_size;
+        for (int j = 0; j < n_carriers; j++) {
+            if (offset + carrier_size > (int) length)
+                return -1;
+            int phy_bitmask = _read_uint_le(b + offset, 2);
+            carrier[NR_UL_PCSR_CARRIER_ID] = phy_bitmask & 0x000f;
+            offset += carrier_size;
+            if (phy_bitmask & 0x0080) {
+                if (offset + pusch_size > (int) length)
+                    return -1;
+                if (emit) {
+                    long long values[NR_UL_PCSR_PUSCH_NUM_COLUMNS];
+                    for (int k = 0; k < NR_UL_PCSR_PUSCH_NUM_COLUMNS; k++)
+                        values[k] = NR_UL_PCSR_MISSING;
+                    for (size_t k = 0;
+                            k < ARRAY_SIZE(NrMacUlSchedPUSCHFields_v2_8, NrUlPcsrBitField);
+                            k++) {
+                        const NrUlPcsrBitField &f = NrMacUlSchedPUSCHFields_v2_8[k];
+                        values[f.column] = _read_bits_le(b + offset, f.lsb, f.bits);
+                    }
+                    nr_ul_pcsr_columns_on_row(NR_UL_PCSR_PUSCH, version, carrier, values);
+                }
+                offset += pusch_size;
+            }
+            if (phy_bitmask & 0x0100) {
+                if (offset + pucch_size > (int) length)
+                    return -1;
+                if (emit)
+                    _emit_nr_mac_ul_pcsr_empty_row(NR_UL_PCSR_PUCCH, version, carrier);
+                offset += pucch_size;
+            }
+            if (phy_bitmask & 0x0200) {
+                if (offset + srs_size > (int) length)
+                    return -1;
+                if (emit)
+                    _emit_nr_mac_ul_pcsr_empty_row(NR_UL_PCSR_SRS, version, carrier);
+                offset += srs_size;
+            }
+        }
+    }
+    return offset - start;
+}
+
+// Walk the records of version 2.11 (with emit, emitting their rows).
+// Return: the bytes of the records, or -1 if they overrun the packet
+static int
+_walk_nr_mac_ul_pcsr_v2_11 (const char *b, int offset, size_t length,
+        int version, int n_records, bool emit) {
+    int start = offset;
+    int systime_size = _fmt_offset(NrMacUlPhyChannelScheduleSystime_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelScheduleSystime_Fmt_v2_11, Fmt), NULL);
+    int records_size = _fmt_offset(NrMacUlPhyChannelScheduleRecords_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelScheduleRecords_Fmt_v2_11, Fmt), NULL);
+    int carrier_size = _fmt_offset(NrMacUlPhyChannelScheduleCarriers_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelScheduleCarriers_Fmt_v2_11, Fmt), NULL);
+    int pusch_size = _fmt_offset(NrMacUlPhyChannelSchedulePUSCH_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelSchedulePUSCH_Fmt_v2_11, Fmt), NULL);
+    int pucch_size = _fmt_offset(NrMacUlPhyChannelSchedulePUCCH_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelSchedulePUCCH_Fmt_v2_11, Fmt), NULL);
+    int per_pucch_size = _fmt_offset(NrMacUlPhyChannelSchedulePerPUCCH_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelSchedulePerPUCCH_Fmt_v2_11, Fmt), NULL);
+    int prach_size = _fmt_offset(NrMacUlPhyChannelSchedulePrach_Fmt_v2_11,
+            ARRAY_SIZE(NrMacUlPhyChannelSchedulePrach_Fmt_v2_11, Fmt), NULL);
+    long long values[NR_UL_PCSR_MAX_COLUMNS];
+    for (int i = 0; i < n_records; i++) {
+        if (offset + systime_size + records_size > (int) length)
+            return -1;
+        long long carrier[NR_UL_PCSR_NUM_CARRIER_COLUMNS];
+        carrier[NR_UL_PCSR_SLOT] = (unsigned char) b[offset];
+        carrier[NR_UL_PCSR_NUMEROLOGY] = b[offset + 1] & 0x0f;
+        carrier[NR_UL_PCSR_FRAME] = _read_uint_le(b + offset + 2, 2) & 0x3ff;
+        offset += systime_size;
+        int n_carriers = (unsigned char) b[offset];
+        offset += records_size;
+        for (int j = 0; j < n_carriers; j++) {
+            if (offset + carrier_size > (int) length)
+                return -1;
+            int tmp = (unsigned char) b[offset];
+            int tmp2 = (unsigned char) b[offset + 1];
+            int ch = ((tmp2 & 0x0f) << 2) + ((tmp >> 6) & 0b11);
+            carrier[NR_UL_PCSR_CARRIER_ID] = tmp & 0b11;
+            carrier[NR_UL_PCSR_RNTI_TYPE] = (tmp >> 2) & 0x0f;
+            offset += carrier_size;
+            if (ch & 0b010) {   // PUSCH
+                if (offset + pusch_size > (int) length)
+                    return -1;
+                if (emit) {
+                    _read_nr_mac_ul_pcsr_pusch_v2_11(b + offset, values);
+                    nr_ul_pcsr_columns_on_row(NR_UL_PCSR_PUSCH, version, carrier, values);
+                }
+                offset += pusch_size;
+            }
+            if (ch & 0b100) {   // PUCCH
+                if (offset + pucch_size > (int) length)
+                    return -1;
+                int n_pucch = (unsigned char) b[offset];
+                offset += pucch_size;
+                if (offset + n_pucch * per_pucch_size > (int) length)
+                    return -1;
+                for (int k = 0; k < n_pucch; k++) {
+                    if (emit) {
+                        _read_nr_mac_ul_pcsr_per_pucch_v2_11(b + offset, values);
+                        nr_ul_pcsr_columns_on_row(NR_UL_PCSR_PUCCH, version, carrier, values);
+                    }
+                    offset += per_pucch_size;
+                }
+            }
+            if (ch & 0b010000) {    // PRACH
+                if (offset + prach_size > (int) length)
+                    return -1;
+                if (emit) {
+                    _read_nr_mac_ul_pcsr_prach_v2_11(b + offset, values);
+                    nr_ul_pcsr_columns_on_row(NR_UL_PCSR_PRACH, version, carrier, values);
+                }
+                offset += prach_size;
+            }
+        }
+    }
+    return offset - start;
+}
+
+// Fill the tables of the "nr_mac_ul_pcsr_columns" engine with the records of
+// a packet, read straight from its bytes. Nothing is emitted unless all the
+// records fit in the packet.
+// Return: the bytes of the records, or -1 for an unknown version or a
+// truncated packet
+static int
+_feed_nr_mac_ul_pcsr_columns (const char *b, int offset, size_t length,
+        int major_ver, int minor_ver, int n_records) {
+    int (*walk) (const char *, int, size_t, int, int, bool) = NULL;
+    if (major_ver == 2 && minor_ver == 8)
+        walk = _walk_nr_mac_ul_pcsr_v2_8;
+    else if (major_ver == 2 && minor_ver == 11)
+        walk = _walk_nr_mac_ul_pcsr_v2_11;
+    int version = major_ver * 100 + minor_ver;
+    if (walk == NULL || walk(b, offset, length, version, n_records, false) < 0)
+        return -1;
+    return walk(b, offset, length, version, n_records, true);
+}
+
 static int
 _decode_nr_mac_ul_physical_channel_schedule_report_subpkt(const char *b, int offset, size_t length,
                        PyObject *result) {
@@ -789,6 +1140,14 @@ _decode_nr_mac_ul_physical_channel_schedule_report_subpkt(const char *b, int off
     int minor_ver = _search_result_int(result, "Minor Version");
     int n_records = _search_result_int(result, "Num Records");
     bool success = false;
+
+    if (NrMacUlPcsrColumnsEngine.enabled) {
+        int n = _feed_nr_mac_ul_pcsr_columns(b, offset, length, major_ver,
+                minor_ver, n_records);
+        if (n >= 0 && nr_ul_pcsr_columns_skip_records())
+            return n;
+    }
+
 	PyObject* tmp_py = PyList_New(0);
 	PyObject* t = NULL;
     int tmp;
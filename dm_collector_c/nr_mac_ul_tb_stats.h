@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "nr_mac_tput.h"
 
 const Fmt NrMacUlTbStats_Fmt[] = {
     {UINT, "Minor Version", 2},
@@ -68,6 +69,26 @@ const Fmt NrMacUlTbStatsRecord_v2_1[] = {
 };
 
 
+// Feed the record i at offset, of the record format fmt, to the nr_mac_tput
+// engine, if it fits in the buffer.
+static void _feed_nr_mac_ul_tb_stats_record(const char* b, int offset,
+    size_t length, const Fmt* fmt, int n_fmt, int i) {
+    if (!NrMacTputEngine.enabled || offset + _fmt_offset(fmt, n_fmt, NULL) > (int)length)
+        return;
+    const char* p = b + offset;
+    int new_tx_at = _fmt_offset(fmt, n_fmt, "Num New Tx TB");
+    if (new_tx_at < 0)
+        new_tx_at = _fmt_offset(fmt, n_fmt, "Num New TX TB");    // v2.0
+    unsigned long long new_tx = _read_uint_le(p + new_tx_at, 4);
+    NrMacTputStats stats = NrMacTputStats();
+    stats.retx_tbs = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "Num ReTx TB"), 4);
+    stats.tbs = new_tx + stats.retx_tbs;
+    stats.failed_tbs = stats.retx_tbs;
+    stats.bytes = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "TB New Tx Bytes"), 8);
+    stats.retx_bytes = _read_uint_le(p + _fmt_offset(fmt, n_fmt, "TB ReTx Bytes"), 8);
+    nr_mac_tput_on_stats(NR_MAC_TPUT_UL, i, stats);
+}
+
 static int _decode_nr_mac_ul_tb_stats_subpkt(const char* b,
     int offset, size_t length, PyObject* result) {
     bool success = false;
@@ -93,6 +114,9 @@ static int _decode_nr_mac_ul_tb_stats_subpkt(const char* b,
                 "ML1_State_Change", iML);
             Py_DECREF(old_object);
             for (int i = 0; i < n_record; i++) {
+                _feed_nr_mac_ul_tb_stats_record(b, offset, length,
+                    NrMacUlTbStatsRecord_v2_1,
+                    ARRAY_SIZE(NrMacUlTbStatsRecord_v2_1, Fmt), i);
                 PyObject* result_record = PyList_New(0);
                 offset += _decode_by_fmt(NrMacUlTbStatsRecord_v2_1,
                     ARRAY_SIZE(NrMacUlTbStatsRecord_v2_1, Fmt),
@@ -133,6 +157,8 @@ static int _decode_nr_mac_ul_tb_stats_subpkt(const char* b,
 
             for (int i = 0; i < n_record; i++) {
                 //Records
+                _feed_nr_mac_ul_tb_stats_record(b, offset, length,
+                    Records_v2_0, ARRAY_SIZE(Records_v2_0, Fmt), i);
                 PyObject* result_Record = PyList_New(0);
                 offset += _decode_by_fmt(Records_v2_0,
                     ARRAY_SIZE(Records_v2_0, Fmt),
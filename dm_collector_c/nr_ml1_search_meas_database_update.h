@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "nr_beam_store.h"
 
 const Fmt NrMl1SearchMeasDatabaseUpdate_Fmt [] = {
     {UINT, "Minor Version",                 2},
@@ -99,6 +100,14 @@ const Fmt NrMl1SearchMeasDetectedBeam_v2_7[] = {
 
 };
 
+// RSRP or RSRQ of a raw v2.7 field, which is not available when 0
+static float
+_nr_rsrp_rsrq_value_v2_7(unsigned int raw) {
+    int integer = (raw >> 7) & 0xff;
+    int frac = raw & 0x7f;
+    return (((integer^0xff)+1)*(-1)) + frac * 0.0078125;
+}
+
 static void
 _convert_nr_rsrp_rsrq_v2_7(PyObject * obj, const char* rsrp_field) {
     int utemp = _search_result_uint(obj, rsrp_field);
@@ -110,9 +119,7 @@ _convert_nr_rsrp_rsrq_v2_7(PyObject * obj, const char* rsrp_field) {
     return;
     }
 
-    int integer = (utemp >> 7) & 0xff;
-    int frac = utemp & 0x7f;
-    float r = (((integer^0xff)+1)*(-1)) + frac * 0.0078125;
+    float r = _nr_rsrp_rsrq_value_v2_7(utemp);
     char  quality[64];
     sprintf(quality,"%.3f",r);
     PyObject * pyfloat = Py_BuildValue("s", quality);
@@ -160,6 +167,8 @@ _decode_nr_ml1_search_meas_subpkt(const char *b, int offset, size_t length,
                                                  b, offset, length, result_layer);
 
                         int n_cells = _search_result_int(result_layer, "Num Cells");
+                        int iServingPci = _search_result_int(result_layer, "Serving Cell PCI");
+                        int iServingSsb = _search_result_int(result_layer, "Serving SSB");
                         PyObject *result_allcells = PyList_New(0);
 
                         for(int j = 0; j < n_cells; j++){
@@ -169,6 +178,7 @@ _decode_nr_ml1_search_meas_subpkt(const char *b, int offset, size_t length,
                                                  ARRAY_SIZE(NrMl1SearchMeasCellList_v2_6, Fmt),
                                                  b, offset, length, result_cell);
 
+                            int iPci = _search_result_int(result_cell, "PCI");
                             _convert_nr_rsrp(result_cell, "CellQualityRsrp");
                             _convert_nr_rsrp(result_cell, "CellQualityRsrq");
 
@@ -181,6 +191,16 @@ _decode_nr_ml1_search_meas_subpkt(const char *b, int offset, size_t length,
                                                  ARRAY_SIZE(NrMl1SearchMeasDetectedBeam_v2_6, Fmt),
                                                  b, offset, length, result_beam);
 
+                                if (NrBeamStoreEngine.enabled) {
+                                    int iSsb = _search_result_int(result_beam, "SSB Index");
+                                    nr_beam_store_on_beam(NR_BEAM_STORE_SEARCHER, iPci, iSsb,
+                                            iPci == iServingPci && iSsb == iServingSsb,
+                                            _nr_rsrp_rsrq_value(_search_result_uint(result_beam,
+                                                    "NR2NR Filtered Tx Beam RSRP L3")),
+                                            _nr_rsrp_rsrq_value(_search_result_uint(result_beam,
+                                                    "NR2NR Filtered Tx Beam RSRQ L3")));
+                                }
+
                                 _convert_nr_rsrp(result_beam, "RSRP 0");
                                 _convert_nr_rsrp(result_beam, "RSRP 1");
 
@@ -258,6 +278,8 @@ _decode_nr_ml1_search_meas_subpkt(const char *b, int offset, size_t length,
                             b, offset, length, result_layer);
 
                         int n_cells = _search_result_int(result_layer, "Num Cells");
+                        int iServingPci = _search_result_int(result_layer, "Serving Cell PCI");
+                        int iServingSsb = _search_result_int(result_layer, "Serving SSB");
                         PyObject* result_allcells = PyList_New(0);
                         _convert_nr_rsrp_rsrq_v2_7(result_layer, "ServingRsrpRx23[0]");
                         _convert_nr_rsrp_rsrq_v2_7(result_layer, "ServingRsrpRx23[1]");
@@ -274,6 +296,7 @@ _decode_nr_ml1_search_meas_subpkt(const char *b, int offset, size_t length,
                             offset += _decode_by_fmt(NrMl1SearchMeasCellList_v2_7,
                                 ARRAY_SIZE(NrMl1SearchMeasCellList_v2_7, Fmt),
                                 b, offset, length, result_cell);
+                            int iPci = _search_result_int(result_cell, "PCI");
                             _convert_nr_rsrp_rsrq_v2_7(result_cell, "Cell Quality Rsrp");
                             _convert_nr_rsrp_rsrq_v2_7(result_cell, "Cell Quality Rsrq");
                             int n_beams = _search_result_int(result_cell, "Num Beams");
@@ -282,6 +305,19 @@ _decode_nr_ml1_search_meas_subpkt(const char *b, int offset, size_t length,
                                 offset += _decode_by_fmt(NrMl1SearchMeasDetectedBeam_v2_7,
                                     ARRAY_SIZE(NrMl1SearchMeasDetectedBeam_v2_7, Fmt),
                                     b, offset, length, result_beam);
+                                if (NrBeamStoreEngine.enabled) {
+                                    int iSsb = _search_result_int(result_beam, "SSB Index");
+                                    unsigned int uRsrp = _search_result_uint(result_beam,
+                                            "Nr2NrFilteredBeamRsrpL3");
+                                    unsigned int uRsrq = _search_result_uint(result_beam,
+                                            "Nr2NrFilteredBeamRsrqL3");
+                                    // 0 is not available
+                                    if (uRsrp != 0)
+                                        nr_beam_store_on_beam(NR_BEAM_STORE_SEARCHER, iPci, iSsb,
+                                                iPci == iServingPci && iSsb == iServingSsb,
+                                                _nr_rsrp_rsrq_value_v2_7(uRsrp),
+                                                uRsrq != 0 ? _nr_rsrp_rsrq_value_v2_7(uRsrq) : NAN);
+                                }
                                 _judge_na_v2_7(result_beam,"Rx Beam Id[0]",0x0000);
                                 _judge_na_v2_7(result_beam,"Rx Beam Id[1]",0x0000);
                                 _convert_nr_rsrp_rsrq_v2_7(result_beam, "RX Beam Info-RSRPs[0]");
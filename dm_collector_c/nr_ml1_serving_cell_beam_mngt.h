@@ -5,6 +5,7 @@
 #include "consts.h"
 #include "log_packet.h"
 #include "log_packet_helper.h"
+#include "nr_beam_store.h"
 
 const Fmt NrMl1ServCellBeamMngt_Fmt [] = {
     {UINT, "Minor Version",                 2},
@@ -66,6 +67,17 @@ _decode_nr_ml1_serv_cell_beam_mngt_subpkt(const char *b, int offset, size_t leng
                                                  b, offset, length, result_record);
 
 
+                        if (NrBeamStoreEngine.enabled) {
+                            int iPci = _search_result_int(result, "PCI");
+                            int iSsb = _search_result_int(result_record, "Tx Beam Index");
+                            nr_beam_store_on_beam(NR_BEAM_STORE_BEAM_MNGT, iPci, iSsb,
+                                    iSsb == (int) ssb_index,
+                                    _nr_rsrp_rsrq_value(_search_result_uint(result_record,
+                                            "RSRP Filtered")),
+                                    _nr_rsrp_rsrq_value(_search_result_uint(result_record,
+                                            "RSRQ Filtered")));
+                        }
+
                         _convert_nr_rsrp(result_record,"RSRP Filtered");
                         _convert_nr_rsrq(result_record,"RSRQ Filtered");
 
@@ -0,0 +1,239 @@
+/* pcap_export.cpp
+ * Implements the pcapng export of raw signaling messages.
+ */
+
+#include "pcap_export.h"
+#include "export_manager.h"
+#include "utils.h"
+
+#include <cstring>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#define printf(fmt,args...) __android_log_print(ANDROID_LOG_INFO, "python [dm_collector_c]", fmt, ##args);
+#endif
+
+// Maps raw_msg types to their AWW protocol number.
+// Keep consistent with ws_dissector/packet-aww.cpp
+static const ValueName AwwTypes[] = {
+    // WCDMA RRC
+    {100, "RRC_UL_CCCH", true},
+    {101, "RRC_UL_DCCH", true},
+    {102, "RRC_DL_CCCH", true},
+    {103, "RRC_DL_DCCH", true},
+    {104, "RRC_DL_BCCH_BCH", true},
+    {106, "RRC_DL_PCCH", true},
+    {150, "RRC_MIB", true},
+    {151, "RRC_SIB1", true},
+    {152, "RRC_SIB2", true},
+    {153, "RRC_SIB3", true},
+    {155, "RRC_SIB5", true},
+    {157, "RRC_SIB7", true},
+    {161, "RRC_SIB11", true},
+    {162, "RRC_SIB12", true},
+    {169, "RRC_SIB19", true},
+    {181, "RRC_SB1", true},
+    {190, "NAS", true},
+    // LTE
+    {200, "LTE-RRC_PCCH", true},
+    {201, "LTE-RRC_DL_DCCH", true},
+    {202, "LTE-RRC_UL_DCCH", true},
+    {203, "LTE-RRC_BCCH_DL_SCH", true},
+    {204, "LTE-RRC_DL_CCCH", true},
+    {205, "LTE-RRC_UL_CCCH", true},
+    {206, "LTE-RRC_DL_DCCH_NB", true},
+    {207, "LTE-RRC_UL_DCCH_NB", true},
+    {208, "LTE-RRC_BCCH_DL_SCH_NB", true},
+    {209, "LTE-RRC_DL_CCCH_NB", true},
+    {210, "LTE-RRC_UL_CCCH_NB", true},
+    {250, "LTE-NAS_EPS_PLAIN", true},
+    {300, "LTE-PDCP_DL_SRB", true},
+    {301, "LTE-PDCP_UL_SRB", true},
+    // 5G NR
+    {400, "nr-rrc.ue_radio_paging_info", true},
+    {401, "nr-rrc.ue_radio_access_cap_info", true},
+    {402, "nr-rrc.bcch.bch", true},
+    {403, "nr-rrc.bcch.dl.sch", true},
+    {404, "nr-rrc.dl.ccch", true},
+    {405, "nr-rrc.dl.dcch", true},
+    {406, "nr-rrc.pcch", true},
+    {407, "nr-rrc.ul.ccch", true},
+    {408, "nr-rrc.ul.ccch1", true},
+    {409, "nr-rrc.ul.dcch", true},
+    {410, "nr-rrc.rrc_reconf", true},
+    {411, "nr-rrc.ue_mrdc_cap", true},
+    {412, "nr-rrc.ue_nr_cap", true},
+    {413, "nr-rrc.sbcch.sl.bch", true},
+    {414, "nr-rrc.scch", true},
+    {415, "nr-rrc.radio_bearer_conf", true},
+    {416, "nas-5gs", true},
+};
+
+// Framing of LTE PDCP signaling messages, see packet-pdcp-lte.h in Wireshark
+#define PDCP_LTE_START_STRING "pdcp-lte"
+#define PDCP_LTE_PAYLOAD_TAG 0x01
+#define PDCP_LTE_DIRECTION_TAG 0x03
+#define PDCP_LTE_LOG_CHAN_TYPE_TAG 0x04
+#define PDCP_LTE_BCCH_TRANSPORT_TYPE_TAG 0x05
+#define PDCP_LTE_SIGNALING_PLANE 1
+#define PDCP_LTE_DIRECTION_UPLINK 0
+#define PDCP_LTE_DIRECTION_DOWNLINK 1
+#define PDCP_LTE_CHANNEL_DCCH 1
+
+#define PCAPNG_SHB_TYPE 0x0A0D0D0A
+#define PCAPNG_IDB_TYPE 0x00000001
+#define PCAPNG_EPB_TYPE 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+// pcapng blocks are in host byte order, aww headers in network byte order.
+static void
+put_u16 (std::string &out, unsigned short v) {
+    out.append((const char *) &v, sizeof(v));
+}
+
+static void
+put_u32 (std::string &out, unsigned int v) {
+    out.append((const char *) &v, sizeof(v));
+}
+
+static void
+put_u32_be (std::string &out, unsigned int v) {
+    char b[4] = {(char) (v >> 24), (char) (v >> 16), (char) (v >> 8), (char) v};
+    out.append(b, 4);
+}
+
+// A section header block, then an interface description block with the
+// default timestamp resolution of microseconds.
+static std::string
+pcapng_file_header () {
+    std::string out;
+    put_u32(out, PCAPNG_SHB_TYPE);
+    put_u32(out, 28);
+    put_u32(out, PCAPNG_BYTE_ORDER_MAGIC);
+    put_u16(out, 1);            // Major version
+    put_u16(out, 0);            // Minor version
+    put_u32(out, 0xFFFFFFFF);   // Section length: unspecified
+    put_u32(out, 0xFFFFFFFF);
+    put_u32(out, 28);
+
+    put_u32(out, PCAPNG_IDB_TYPE);
+    put_u32(out, 20);
+    put_u16(out, PCAP_LINKTYPE_AWW);
+    put_u16(out, 0);            // Reserved
+    put_u32(out, 0);            // Snap length: none
+    put_u32(out, 20);
+    return out;
+}
+
+// Append the aww header of a message, as aww_frame_header() does.
+static void
+put_aww_header (std::string &out, int type, size_t data_len) {
+    put_u32_be(out, type);
+    put_u32_be(out, data_len);
+    if (type == 300 || type == 301) {
+        out.append(PDCP_LTE_START_STRING);
+        out.push_back(0);   // no_header_pdu
+        out.push_back(PDCP_LTE_SIGNALING_PLANE);
+        out.push_back(0);   // rohc_compression
+        out.push_back(PDCP_LTE_DIRECTION_TAG);
+        out.push_back(type == 300 ? PDCP_LTE_DIRECTION_DOWNLINK : PDCP_LTE_DIRECTION_UPLINK);
+        out.push_back(PDCP_LTE_LOG_CHAN_TYPE_TAG);
+        out.push_back(PDCP_LTE_CHANNEL_DCCH);
+        out.push_back(PDCP_LTE_BCCH_TRANSPORT_TYPE_TAG);
+        out.push_back(0);
+        out.push_back(PDCP_LTE_PAYLOAD_TAG);
+    }
+}
+
+// Append an enhanced packet block holding an aww frame.
+static void
+put_packet (std::string &out, int type, const char *b, size_t length,
+            unsigned long long usecs) {
+    size_t start = out.size();
+    put_u32(out, PCAPNG_EPB_TYPE);
+    put_u32(out, 0);            // Block length, set below
+    put_u32(out, 0);            // Interface ID
+    put_u32(out, (unsigned int) (usecs >> 32));
+    put_u32(out, (unsigned int) usecs);
+    put_u32(out, 0);            // Captured length, set below
+    put_u32(out, 0);            // Original length
+    size_t data_start = out.size();
+    put_aww_header(out, type, length);
+    out.append(b, length);
+    unsigned int cap_len = out.size() - data_start;
+    out.append((4 - cap_len % 4) % 4, '\0');
+    unsigned int block_len = out.size() - start + 4;
+    put_u32(out, block_len);
+    memcpy(&out[start + 4], &block_len, 4);
+    memcpy(&out[start + 20], &cap_len, 4);
+    memcpy(&out[start + 24], &cap_len, 4);
+}
+
+void
+pcap_export_init_state (struct PcapExportState *pstate) {
+    writer_init_state(&pstate->writer);
+    pstate->packet.clear();
+    pstate->unknown_msgs = 0;
+}
+
+bool
+pcap_export_open (struct PcapExportState *pstate, const char *path,
+                  const struct LogWriterOptions *options) {
+    pcap_export_close(pstate);
+    LogWriterOptions pcap_options = *options;
+    pcap_options.segment_header = pcapng_file_header();
+    if (!writer_open(&pstate->writer, path, &pcap_options)) {
+        printf("dm_collector_c: cannot open %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+void
+pcap_export_packet (struct PcapExportState *pstate, PyObject *decoded,
+                    unsigned long long qcdm_timestamp) {
+    static const char RAW_MSG_PREFIX[] = "raw_msg/";
+    if (!pstate->writer.opened || decoded == NULL || !PyList_Check(decoded))
+        return;
+    unsigned long long usecs = qcdm_timestamp_to_unix_usecs(qcdm_timestamp);
+    for (Py_ssize_t i = 0; i < PyList_Size(decoded); i++) {
+        PyObject *t = PyList_GetItem(decoded, i);   // borrowed
+        if (!PyTuple_Check(t) || PyTuple_Size(t) != 3)
+            continue;
+        PyObject *val = PyTuple_GetItem(t, 1);
+        const char *type_str = PyUnicode_AsUTF8(PyTuple_GetItem(t, 2));
+        if (type_str == NULL) {
+            PyErr_Clear();
+            continue;
+        }
+        if (strncmp(type_str, RAW_MSG_PREFIX, sizeof(RAW_MSG_PREFIX) - 1) != 0
+                || !PyBytes_Check(val))
+            continue;
+        IdVector types;
+        if (find_ids(AwwTypes, ARRAY_SIZE(AwwTypes, ValueName),
+                     type_str + sizeof(RAW_MSG_PREFIX) - 1, types) == 0) {
+            pstate->unknown_msgs++;
+            continue;
+        }
+        pstate->packet.clear();
+        put_packet(pstate->packet, types[0], PyBytes_AsString(val), PyBytes_Size(val), usecs);
+        writer_append(&pstate->writer, pstate->packet.data(), pstate->packet.size());
+    }
+}
+
+void
+pcap_export_flush (struct PcapExportState *pstate) {
+    writer_flush(&pstate->writer);
+}
+
+void
+pcap_export_close (struct PcapExportState *pstate) {
+    if (!pstate->writer.opened)
+        return;
+    writer_close(&pstate->writer);
+}
+
+void
+pcap_export_get_stats (struct PcapExportState *pstate, struct LogWriterStats *stats) {
+    writer_get_stats(&pstate->writer, stats);
+}
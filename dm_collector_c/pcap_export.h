@@ -0,0 +1,55 @@
+/* pcap_export.h
+ * Exports the raw signaling messages of decoded log packets (their "raw_msg/"
+ * fields) to pcapng files, so that they can be dissected in bulk with tshark
+ * instead of one at a time through ws_dissector.
+ *
+ * Each message is framed as by ws_dissector (see ws_dissector/packet-aww.cpp)
+ * in a packet of link type USER1 (DLT 148), timestamped with the QCDM
+ * timestamp of its log packet. Wireshark needs the aww dissector, and DLT 148
+ * mapped to it in its "DLT_USER" preferences.
+ *
+ * Packets are written by a LogWriterState, so the file can be rotated by size
+ * or duration and gzip compressed. Every segment is a complete pcapng file.
+ */
+
+#ifndef __DM_COLLECTOR_C_PCAP_EXPORT_H__
+#define __DM_COLLECTOR_C_PCAP_EXPORT_H__
+
+#include <Python.h>
+
+#include "log_writer.h"
+
+#include <string>
+
+#define PCAP_LINKTYPE_AWW 148   // LINKTYPE_USER1
+
+struct PcapExportState {
+    LogWriterState writer;
+    std::string packet;     // Reused to build each packet
+    unsigned long long unknown_msgs;    // raw_msg types without an aww number
+};
+
+// Must be called before usage
+void pcap_export_init_state (struct PcapExportState *pstate);
+
+// Start writing packets to path, after closing the current file if any.
+// Block compression is not supported.
+// Return: successful or not
+bool pcap_export_open (struct PcapExportState *pstate, const char *path,
+                       const struct LogWriterOptions *options);
+
+// Write a packet for every raw message of a decoded log packet.
+// qcdm_timestamp: the timestamp of the log packet, in 1/52428800 s since
+// 1980-01-06.
+void pcap_export_packet (struct PcapExportState *pstate, PyObject *decoded,
+                         unsigned long long qcdm_timestamp);
+
+// Write all staged packets, and wait until they are written.
+void pcap_export_flush (struct PcapExportState *pstate);
+
+// Write all staged packets, then stop the writer and close the current file.
+void pcap_export_close (struct PcapExportState *pstate);
+
+void pcap_export_get_stats (struct PcapExportState *pstate, struct LogWriterStats *stats);
+
+#endif // __DM_COLLECTOR_C_PCAP_EXPORT_H__
@@ -1,5 +1,6 @@
 #include "utils.h"
 
+#include <chrono>
 #include <cstring>
 
 // Find multiple IDs coressponding to name, and append all IDs to out_vector
@@ -25,3 +26,21 @@ search_name (const ValueName id_to_name [], int n, int val) {
     }
     return NULL;
 }
+
+double
+get_monotonic_time () {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Seconds from 1970-01-01 to 1980-01-06, the epoch of QCDM timestamps
+#define QCDM_EPOCH_OFFSET 315964800ULL
+#define QCDM_TICKS_PER_SECOND 52428800ULL
+
+unsigned long long
+qcdm_timestamp_to_unix_usecs (unsigned long long ts) {
+    unsigned long long secs = ts / QCDM_TICKS_PER_SECOND;
+    unsigned long long ticks = ts % QCDM_TICKS_PER_SECOND;
+    return (secs + QCDM_EPOCH_OFFSET) * 1000000ULL
+            + ticks * 1000000ULL / QCDM_TICKS_PER_SECOND;
+}
@@ -16,4 +16,11 @@ struct ValueName {
 int find_ids (const ValueName id_to_name [], int n, const char *name, IdVector& out_vector);
 const char* search_name (const ValueName id_to_name [], int n, int val);
 
+// Seconds from an arbitrary starting point, unaffected by system clock changes.
+double get_monotonic_time ();
+
+// Convert a QCDM timestamp (1/52428800 s since 1980-01-06) into microseconds
+// since the Unix epoch.
+unsigned long long qcdm_timestamp_to_unix_usecs (unsigned long long ts);
+
 #endif // __DM_COLLECTOR_C_UTILS_H__
@@ -0,0 +1,47 @@
+#!/usr/bin/python
+# Filename: export-flush-test.py
+"""
+Checks that exported logs reach the disk when the device goes quiet, without
+waiting for more logs or an explicit flush. Run from this directory:
+
+    python export-flush-test.py
+"""
+
+import os
+import sys
+import shutil
+import tempfile
+import time
+
+from mobile_insight.monitor.dm_collector import dm_collector_c
+
+LOGS = ["LTE_RRC_OTA_Packet", "LTE_RRC_MIB_Packet", "LTE_PHY_PDSCH_Packet"]
+
+
+if __name__ == "__main__":
+    tmp = tempfile.mkdtemp()
+    mi2log = os.path.join(tmp, "quiet.mi2log")
+    pcap = os.path.join(tmp, "quiet.pcapng")
+    try:
+        dm_collector_c.set_filtered(LOGS)
+        dm_collector_c.set_filtered_export(mi2log, LOGS)
+        dm_collector_c.set_pcap_export(pcap)
+        dm_collector_c.reset()
+        # Far less than a batch of the writer
+        with open("./offline_log_example.mi2log", "rb") as f:
+            dm_collector_c.feed_binary(f.read(200 * 1024))
+        while dm_collector_c.receive_log_packet(False, True):
+            pass
+        # Then nothing more arrives.
+        time.sleep(1.5)
+        mi2log_size = os.path.getsize(mi2log)
+        pcap_size = os.path.getsize(pcap)
+        print("mi2log", mi2log_size, "bytes, pcapng", pcap_size, "bytes")
+        dm_collector_c.set_pcap_export(None)
+        # The pcapng file starts with a 48-byte header.
+        if mi2log_size == 0 or pcap_size <= 48:
+            print("FAILED")
+            sys.exit(1)
+        print("OK")
+    finally:
+        shutil.rmtree(tmp)
@@ -0,0 +1,73 @@
+#!/usr/bin/python
+# Filename: export-wrapper-test.py
+"""
+Checks that frames with the 0x98 wrapper some modems put before each frame are
+exported without it, with a valid CRC, while other frames are exported as
+they were fed. Run from this directory:
+
+    python export-wrapper-test.py
+"""
+
+import os
+import sys
+import shutil
+import tempfile
+
+from mobile_insight.monitor.dm_collector import dm_collector_c
+
+LOGS = ["LTE_RRC_OTA_Packet", "LTE_RRC_MIB_Packet", "LTE_PHY_PDSCH_Packet"]
+WRAPPER = b"\x98\x01\x00\x00\x01\x00\x00\x00"
+
+
+def crc16(b):
+    crc = 0xFFFF
+    for c in b:
+        crc ^= c
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc ^ 0xFFFF
+
+
+def unescape(raw):
+    return raw.replace(b"\x7d\x5e", b"\x7e").replace(b"\x7d\x5d", b"\x7d")
+
+
+def encode(payload):
+    b = payload + crc16(payload).to_bytes(2, "little")
+    return b.replace(b"\x7d", b"\x7d\x5d").replace(b"\x7e", b"\x7d\x5e") + b"\x7e"
+
+
+def export(data):
+    tmp = tempfile.mkdtemp()
+    path = os.path.join(tmp, "export.mi2log")
+    try:
+        dm_collector_c.set_filtered(LOGS)
+        dm_collector_c.set_filtered_export(path, LOGS)
+        dm_collector_c.reset()
+        dm_collector_c.feed_binary(data)
+        while dm_collector_c.receive_log_packet(False, True):
+            pass
+        dm_collector_c.reset()
+        with open(path, "rb") as f:
+            return f.read()
+    finally:
+        shutil.rmtree(tmp)
+
+
+if __name__ == "__main__":
+    with open("./offline_log_example.mi2log", "rb") as f:
+        data = f.read(200 * 1024)
+    # Whole frames only
+    data = data[:data.rfind(b"\x7e") + 1]
+    plain = export(data)
+    wrapped = b"".join(encode(WRAPPER + unescape(raw)[:-2])
+                       for raw in data.split(b"\x7e")[:-1])
+    unwrapped = export(wrapped)
+    frames = unwrapped.split(b"\x7e")[:-1]
+    print("plain", len(plain), "bytes, wrapped", len(unwrapped), "bytes,",
+          len(frames), "frames")
+    if not plain or unwrapped != plain \
+            or any(unescape(raw).startswith(WRAPPER) for raw in frames):
+        print("FAILED")
+        sys.exit(1)
+    print("OK")
@@ -0,0 +1,78 @@
+#!/usr/bin/python
+# Filename: msg-types-test.py
+"""
+Checks that decoded packets only get "Msg Type" fields once asked for with
+set_msg_types(True), and that they then tell the RRC and NAS messages of the
+attach in offline_log_example. Run from this directory:
+
+    python msg-types-test.py
+"""
+
+import sys
+
+from mobile_insight.monitor import OfflineReplayer
+from mobile_insight.analyzer.analyzer import Analyzer
+
+LOGS = ["LTE_RRC_OTA_Packet",
+        "LTE_NAS_EMM_OTA_Incoming_Packet",
+        "LTE_NAS_EMM_OTA_Outgoing_Packet",
+        "LTE_NAS_ESM_OTA_Incoming_Packet",
+        "LTE_NAS_ESM_OTA_Outgoing_Packet"]
+
+ATTACH = ["systemInformationBlockType1", "systemInformation", "Attach request",
+          "rrcConnectionRequest", "rrcConnectionSetup", "rrcConnectionSetupComplete",
+          "systemInformation", "systemInformation", "dlInformationTransfer",
+          "ESM information request", "ESM information response", "ulInformationTransfer",
+          "systemInformation", "securityModeCommand", "securityModeComplete",
+          "ueCapabilityEnquiry", "ueCapabilityInformation", "rrcConnectionReconfiguration",
+          "rrcConnectionReconfigurationComplete", "Attach accept",
+          "Activate default EPS bearer context request", "Attach complete",
+          "ulInformationTransfer"]
+
+
+class MsgTypeRecorder(Analyzer):
+
+    def __init__(self):
+        Analyzer.__init__(self)
+        self.add_source_callback(self.__msg_callback)
+        self.msg_types = []
+        self.fields = 0
+
+    def set_source(self, source):
+        Analyzer.set_source(self, source)
+        for log in LOGS:
+            source.enable_log(log)
+
+    def __msg_callback(self, msg):
+        self.msg_types.append(msg.data.get_msg_type())
+        self.fields += sum(1 for name in msg.data.decode() if name == "Msg Type")
+
+
+def replay(msg_types):
+    src = OfflineReplayer()
+    src.set_input_path("./offline_log_example.mi2log")
+    if msg_types is not None:
+        src.set_msg_types(msg_types)
+    recorder = MsgTypeRecorder()
+    recorder.set_source(src)
+    src.run()
+    return recorder
+
+
+if __name__ == "__main__":
+    ok = True
+    for msg_types in (None, False):
+        recorder = replay(msg_types)
+        print("set_msg_types", msg_types, "packets", len(recorder.msg_types),
+              "Msg Type fields", recorder.fields)
+        if not recorder.msg_types or recorder.fields \
+                or any(t is not None for t in recorder.msg_types):
+            ok = False
+    recorder = replay(True)
+    print("set_msg_types True", recorder.msg_types)
+    if recorder.msg_types != ATTACH or recorder.fields != len(ATTACH):
+        ok = False
+    if not ok:
+        print("FAILED")
+        sys.exit(1)
+    print("OK")
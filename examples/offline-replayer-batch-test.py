@@ -0,0 +1,56 @@
+#!/usr/bin/python
+# Filename: offline-replayer-batch-test.py
+"""
+Checks that OfflineReplayer sends the same events, in the same order, whether
+or not it dissects the raw messages of several packets at once. Run from this
+directory:
+
+    python offline-replayer-batch-test.py
+"""
+
+import sys
+
+from mobile_insight.monitor import OfflineReplayer
+from mobile_insight.analyzer.analyzer import Analyzer
+
+LOGS = ["LTE_RRC_OTA_Packet",
+        "LTE_NAS_EMM_OTA_Incoming_Packet",
+        "LTE_NAS_EMM_OTA_Outgoing_Packet",
+        "LTE_PHY_Serv_Cell_Measurement"]
+
+
+class EventRecorder(Analyzer):
+
+    def __init__(self):
+        Analyzer.__init__(self)
+        self.add_source_callback(self.__msg_callback)
+        self.events = []
+
+    def set_source(self, source):
+        Analyzer.set_source(self, source)
+        for log in LOGS:
+            source.enable_log(log)
+
+    def __msg_callback(self, msg):
+        decoded = msg.data.decode()
+        self.events.append((msg.type_id, str(decoded.get("timestamp")),
+                            str(decoded.get("Msg"))))
+
+
+def replay(prefs):
+    src = OfflineReplayer(prefs)
+    src.set_input_path("./offline_log_example.mi2log")
+    recorder = EventRecorder()
+    recorder.set_source(src)
+    src.run()
+    return recorder.events
+
+
+if __name__ == "__main__":
+    unbatched = replay({})
+    batched = replay({"ws_dissector_batch_size": 256})
+    print("events", len(unbatched), "unbatched,", len(batched), "batched")
+    if not unbatched or batched != unbatched:
+        print("FAILED")
+        sys.exit(1)
+    print("OK")
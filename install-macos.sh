@@ -20,6 +20,8 @@ ws_ver=3.4.0
 PREFIX=/usr/local
 MOBILEINSIGHT_PATH=$(pwd)
 WIRESHARK_SRC_PATH=${MOBILEINSIGHT_PATH}/wireshark-${ws_ver}
+# Set WS_DISSECTOR_IN_PROCESS=1 to also build ws_dissector_c, which dissects
+# in-process with libwireshark instead of running ws_dissector
 
 PYTHON=python3
 PIP=pip3
@@ -156,11 +158,17 @@ fi
 
 echo -e "${GREEN}[INFO]${NC} Installing mobileinsight-core..."
 cd ${MOBILEINSIGHT_PATH}
+SUDO_ENV=""
+if [[ "${WS_DISSECTOR_IN_PROCESS}" == "1" ]]; then
+    echo -e "${GREEN}[INFO]${NC} Building the in-process dissector ws_dissector_c..."
+    export WIRESHARK_SRC_PATH WIRESHARK_LIB_PATH="${PREFIX}/lib"
+    SUDO_ENV="WIRESHARK_SRC_PATH=${WIRESHARK_SRC_PATH} WIRESHARK_LIB_PATH=${WIRESHARK_LIB_PATH}"
+fi
 if [[ $(${PYTHON} setup.py install) ]] ; then
     echo "Congratulations! mobileinsight-core is successfully installed!"
 else
     echo "Installing mobileinsight-core using sudo, your password may be required..."
-    sudo ${PYTHON} setup.py install
+    sudo ${SUDO_ENV} ${PYTHON} setup.py install
 fi
 
 echo -e "${GREEN}[INFO]${NC} Installing GUI for MobileInsight..."
@@ -24,6 +24,8 @@ ws_ver=3.4.0
 PREFIX=/usr/local
 MOBILEINSIGHT_PATH=$(pwd)
 WIRESHARK_SRC_PATH=${MOBILEINSIGHT_PATH}/wireshark-${ws_ver}
+# Set WS_DISSECTOR_IN_PROCESS=1 to also build ws_dissector_c, which dissects
+# in-process with libwireshark instead of running ws_dissector
 
 PYTHON=python3
 PIP=pip3
@@ -127,7 +129,12 @@ fi
 echo "Installing mobileinsight-core..."
 cd ${MOBILEINSIGHT_PATH}
 echo "Installing mobileinsight-core using sudo, your password may be required..."
-sudo ${PYTHON} setup.py install
+if [ "${WS_DISSECTOR_IN_PROCESS}" = "1" ]; then
+    echo "Building the in-process dissector ws_dissector_c..."
+    sudo WIRESHARK_SRC_PATH="${WIRESHARK_SRC_PATH}" WIRESHARK_LIB_PATH="${PREFIX}/lib" ${PYTHON} setup.py install
+else
+    sudo ${PYTHON} setup.py install
+fi
 
 echo "Installing GUI for MobileInsight..."
 cd ${MOBILEINSIGHT_PATH}
@@ -266,6 +266,9 @@ class AndroidDevDiagMonitor(Monitor):
     def set_sampling_rate(self, sampling_rate):
         dm_collector_c.set_sampling_rate(sampling_rate)
 
+    def set_msg_types(self, enabled):
+        dm_collector_c.set_msg_types(enabled)
+
     def enable_log(self, type_name):
         """
         Enable the messages to be monitored. Refer to cls.SUPPORTED_TYPES for supported types.
@@ -0,0 +1,217 @@
+#!/usr/bin/python
+# Filename: block_log.py
+"""
+A reader of indexed, block-compressed logs (.mi2blk)
+
+The file format is described in dm_collector_c/block_log.h. Such files are
+written by save_log_as(..., compression="block"), or converted from .mi2log
+by dm_collector_c.convert_to_block_log().
+"""
+
+__all__ = ["BlockLogReader", "BlockLogError", "qcdm_timestamp"]
+
+import datetime
+import os
+import struct
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+
+MAGIC = b"MI2BLK01"
+BLOCK_MAGIC = b"MIBK"
+INDEX_MAGIC = b"MI2BIDX1"
+HEADER_SIZE = 16
+BLOCK_HEADER_SIZE = 12
+TRAILER_SIZE = 24
+FLAG_UNTYPED = 0x1
+
+_EPOCH = datetime.datetime(1980, 1, 6)
+_TICKS_PER_SECOND = 52428800
+
+
+class BlockLogError(Exception):
+    pass
+
+
+def qcdm_timestamp(t):
+    """
+    Convert a datetime (same convention as the decoded "timestamp" field) into
+    a raw QCDM timestamp.
+    """
+    delta = t - _EPOCH
+    return (delta.days * 86400 + delta.seconds) * _TICKS_PER_SECOND \
+        + delta.microseconds * _TICKS_PER_SECOND // 1000000
+
+
+class BlockInfo(object):
+    """
+    An index entry, i.e. the metadata of one block.
+    """
+
+    def __init__(self, offset, compressed_size, raw_size, frame_count=0,
+                 flags=FLAG_UNTYPED, min_timestamp=0, max_timestamp=0, type_ids=()):
+        self.offset = offset
+        self.compressed_size = compressed_size
+        self.raw_size = raw_size
+        self.frame_count = frame_count
+        self.flags = flags
+        self.min_timestamp = min_timestamp
+        self.max_timestamp = max_timestamp
+        self.type_ids = frozenset(type_ids)
+
+
+class BlockLogReader(object):
+    """
+    A file-like object that returns the HDLC frames of a .mi2blk file, as they
+    would be read from the equivalent .mi2log file.
+
+    Blocks that cannot hold the wanted frames are skipped without being
+    decompressed. Frames of the remaining blocks are returned as a whole, so
+    the caller still has to filter them. Blocks are decompressed in parallel.
+    """
+
+    def __init__(self, path, type_ids=None, start_time=None, end_time=None,
+                 workers=None, read_ahead=None):
+        """
+        :param path: the .mi2blk file
+        :param type_ids: only read blocks holding one of these type IDs (see dm_collector_c.get_type_ids()). None for all blocks
+        :param start_time: skip blocks that end before this datetime
+        :param end_time: skip blocks that start after this datetime
+        :param workers: number of decompression threads. Default to the number of CPUs
+        :param read_ahead: number of blocks decompressed ahead of the caller. Default to twice the number of workers
+        """
+        self._file = open(path, "rb")
+        self._workers = workers or os.cpu_count() or 1
+        self._read_ahead = read_ahead or 2 * self._workers
+        try:
+            self.blocks = self._read_index()
+        except BaseException:
+            self._file.close()
+            raise
+        self._selected = [b for b in self.blocks
+                          if self._wanted(b, type_ids, start_time, end_time)]
+
+        self._executor = None
+        self._pending = []
+        self._next_block = 0
+        self._buffer = b""
+        self._buffer_pos = 0
+
+    def _read_index(self):
+        f = self._file
+        if f.read(HEADER_SIZE)[:8] != MAGIC:
+            raise BlockLogError("Not a .mi2blk file")
+
+        f.seek(0, os.SEEK_END)
+        size = f.tell()
+        if size >= HEADER_SIZE + TRAILER_SIZE:
+            f.seek(size - TRAILER_SIZE)
+            index_offset, index_size, block_count, magic = \
+                struct.unpack("<QII8s", f.read(TRAILER_SIZE))
+            if magic == INDEX_MAGIC:
+                f.seek(index_offset)
+                return self._parse_index(f.read(index_size), block_count)
+        # The writer did not finish the file
+        return self._scan_blocks(size)
+
+    def _parse_index(self, data, block_count):
+        blocks = []
+        pos = 0
+        for _ in range(block_count):
+            fields = struct.unpack_from("<QIIIIQQH", data, pos)
+            pos += 42
+            n = fields[-1]
+            type_ids = struct.unpack_from("<%dH" % n, data, pos)
+            pos += 2 * n
+            blocks.append(BlockInfo(*fields[:-1], type_ids=type_ids))
+        return blocks
+
+    def _scan_blocks(self, size):
+        blocks = []
+        f = self._file
+        offset = HEADER_SIZE
+        while offset + BLOCK_HEADER_SIZE <= size:
+            f.seek(offset)
+            magic, compressed_size, raw_size = struct.unpack("<4sII", f.read(BLOCK_HEADER_SIZE))
+            if magic != BLOCK_MAGIC \
+                    or offset + BLOCK_HEADER_SIZE + compressed_size > size:
+                break
+            # Without the index, nothing is known about the content
+            blocks.append(BlockInfo(offset, compressed_size, raw_size))
+            offset += BLOCK_HEADER_SIZE + compressed_size
+        return blocks
+
+    @staticmethod
+    def _wanted(block, type_ids, start_time, end_time):
+        if block.flags & FLAG_UNTYPED:
+            return True
+        if type_ids is not None and block.type_ids.isdisjoint(type_ids):
+            return False
+        if block.max_timestamp == 0:
+            return True
+        if start_time is not None and block.max_timestamp < qcdm_timestamp(start_time):
+            return False
+        if end_time is not None and block.min_timestamp > qcdm_timestamp(end_time):
+            return False
+        return True
+
+    def _load(self, block):
+        # Each thread opens its own file object to avoid sharing the position.
+        with open(self._file.name, "rb") as f:
+            f.seek(block.offset + BLOCK_HEADER_SIZE)
+            data = f.read(block.compressed_size)
+        # zlib releases the GIL while decompressing
+        raw = zlib.decompress(data)
+        if len(raw) != block.raw_size:
+            raise BlockLogError("Corrupted block at offset %d" % block.offset)
+        return raw
+
+    def _fill(self):
+        if self._executor is None:
+            self._executor = ThreadPoolExecutor(max_workers=self._workers)
+        while len(self._pending) < self._read_ahead \
+                and self._next_block < len(self._selected):
+            block = self._selected[self._next_block]
+            self._pending.append(self._executor.submit(self._load, block))
+            self._next_block += 1
+
+    def read_block(self):
+        """
+        Return the frames of the next selected block, or b"" at the end.
+        """
+        self._fill()
+        if not self._pending:
+            return b""
+        data = self._pending.pop(0).result()
+        self._fill()
+        return data
+
+    def read(self, size=-1):
+        chunks = []
+        while size != 0:
+            if self._buffer_pos >= len(self._buffer):
+                self._buffer = self.read_block()
+                self._buffer_pos = 0
+                if not self._buffer:
+                    break
+            end = len(self._buffer) if size < 0 \
+                else min(len(self._buffer), self._buffer_pos + size)
+            chunks.append(self._buffer[self._buffer_pos:end])
+            if size > 0:
+                size -= end - self._buffer_pos
+            self._buffer_pos = end
+        return b"".join(chunks)
+
+    def close(self):
+        for future in self._pending:
+            future.cancel()
+        self._pending = []
+        if self._executor is not None:
+            self._executor.shutdown(wait=True)
+            self._executor = None
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
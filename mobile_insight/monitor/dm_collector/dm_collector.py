@@ -102,16 +102,34 @@ class DMCollector(Monitor):
         cls = self.__class__
         self.enable_log(cls.SUPPORTED_TYPES)
 
-    def save_log_as(self, path):
+    def save_log_as(self, path, sync_interval=0, max_segment_bytes=0,
+                    max_segment_seconds=0, compression=None):
         """
         Save the log as a mi2log file (for offline analysis)
 
-        :param path: the file name to be saved
+        :param path: the file name to be saved. If the log is split, a naming pattern where "{seq}" is the file number and strftime() conversions give the current time
         :type path: string
-        :param log_types: a filter of message types to be saved
-        :type log_types: list of string
+        :param sync_interval: seconds between flushes of the file to the storage device. 0 (default) leaves it to the OS
+        :type sync_interval: float
+        :param max_segment_bytes: start a new file after this many bytes. 0 (default) for no limit
+        :type max_segment_bytes: int
+        :param max_segment_seconds: start a new file after this many seconds. 0 (default) for no limit
+        :type max_segment_seconds: float
+        :param compression: None (default), "gzip" or "block". Gzip files end with ".gz". "block" writes an indexed .mi2blk file
+        :type compression: string
         """
-        dm_collector_c.set_filtered_export(path, self._type_names)
+        dm_collector_c.set_filtered_export(path, self._type_names, sync_interval,
+                                           max_segment_bytes, max_segment_seconds,
+                                           compression)
+
+    def get_export_stats(self):
+        """
+        Return statistics of the log saving, e.g. bytes written and frames
+        dropped because the storage could not keep up.
+
+        :returns: a dict of counters
+        """
+        return dm_collector_c.get_export_stats()
 
     def run(self):
         """
@@ -60,6 +60,8 @@ class DMLogPacket:
     """
 
     _init_called = False
+    # Dissection results of prefetch(), keyed by (msg_type, raw message)
+    _prefetched = {}
 
     def __init__(self, decoded_list):
         """
@@ -82,6 +84,20 @@ class DMLogPacket:
     def get_type_id(self):
         return self._type_id
 
+    def get_msg_type(self):
+        """
+        Return the type of the signaling message carried by the packet (e.g.
+        "rrcConnectionReconfiguration" or "Attach accept"), as told by
+        *dm_collector_c* without dissecting the message. Only packets decoded
+        after the monitor's set_msg_types(True) have it.
+
+        :returns: the message type, or None if the packet has none or it cannot be told
+        """
+        for field_name, val, type_str in self._decoded_list or ():
+            if field_name == "Msg Type":
+                return val
+        return None
+
     @classmethod
     @static_var("wcdma_sib_types", {0: "RRC_MIB",
                                     1: "RRC_SIB1",
@@ -110,7 +126,10 @@ class DMLogPacket:
                     decoded = cls._decode_msg(msg_type, val)
                     xmls = [decoded, ]
 
-                    if msg_type == "RRC_DL_BCCH_BCH":
+                    if msg_type == "RRC_DL_BCCH_BCH" and isinstance(decoded, list):
+                        # Compact tree: no XML to parse
+                        xmls += cls._decode_wcdma_sibs(decoded)
+                    elif msg_type == "RRC_DL_BCCH_BCH":
                         sib_types = cls._preparse_internal_list.wcdma_sib_types
                         try:
                             # xml = ET.fromstring(decoded)
@@ -161,8 +180,12 @@ class DMLogPacket:
                                 # Zengwen: need to use log it back
                                 # print "RRC SIB Segment(type: %d) not handled"
                                 # % sib_id
-                    xx = cls._wrap_decoded_xml(xmls)
-                    lst.append((field_name, xx, "msg"))
+                    if isinstance(decoded, list):
+                        # Converted to XML only when decoded
+                        lst.append((field_name, xmls, "msg"))
+                    else:
+                        xx = cls._wrap_decoded_xml(xmls)
+                        lst.append((field_name, xx, "msg"))
                 else:
                     lst.append(decoded_list[i])
                 i = i + 1
@@ -179,6 +202,39 @@ class DMLogPacket:
             import traceback
             raise RuntimeError(str(traceback.format_exc()))
 
+    @classmethod
+    def _decode_wcdma_sibs(cls, tree):
+        """
+        Decode the complete SIBs in a compact tree of RRC_DL_BCCH_BCH.
+
+        :returns: a list of compact trees
+        """
+        sib_types = cls._preparse_internal_list.wcdma_sib_types
+        ret = []
+        for complete_sib in WSDissector.find_fields(tree, "rrc.CompleteSIBshort_element"):
+            sib_type = next(WSDissector.find_fields(complete_sib[4], "rrc.sib_Type"), None)
+            sib_data = next(WSDissector.find_fields(complete_sib[4], "rrc.sib_Data_variable"), None)
+            if sib_type is None or sib_data is None:
+                continue
+            sib_id = int(sib_type[2])
+            if sib_id in sib_types:
+                ret.append(cls._decode_msg(sib_types[sib_id],
+                                           WSDissector.field_bytes(sib_data)))
+            else:
+                print(("(MI)Unknown RRC SIB Type: %d" % sib_id))
+        return ret
+
+    @classmethod
+    def _msg_to_xml(cls, val):
+        """
+        :returns: a "msg" field as an XML string
+        """
+        if isinstance(val, str):
+            return val
+        if None in val:
+            return cls._wrap_decoded_xml([None])
+        return cls._wrap_decoded_xml([WSDissector.to_pdml(tree) for tree in val])
+
     @classmethod
     def _parse_internal_list(cls, out_type, decoded_list):
         """
@@ -212,7 +268,9 @@ class DMLogPacket:
                 xx = cls._parse_internal_list_dict(val)
             elif type_str == "list":
                 xx = cls._parse_internal_list_list(val)
-            else:    # "msg" or None: default type
+            elif type_str == "msg":
+                xx = cls._msg_to_xml(val)
+            else:    # None: default type
                 xx = val
 
             output_d[field_name] = xx
@@ -231,7 +289,9 @@ class DMLogPacket:
                 xx = cls._parse_internal_list_dict(val)
             elif type_str == "list":
                 xx = cls._parse_internal_list_list(val)
-            else:    # "msg" or None: default type
+            elif type_str == "msg":
+                xx = cls._msg_to_xml(val)
+            else:    # None: default type
                 xx = val
             output_lst.append(xx)
             i += 1
@@ -265,7 +325,7 @@ class DMLogPacket:
                 sub_tag.text = xx
             else:
                 if type_str == "msg":
-                    xx = ET.XML(xx)
+                    xx = ET.XML(cls._msg_to_xml(xx))
                     sub_tag.set("type", "list")
                 else:
                     sub_tag.set("type", type_str)
@@ -454,7 +514,12 @@ class DMLogPacket:
         if cls._init_called:
             return
         WSDissector.init_proc(prefs.get("ws_dissect_executable_path", None),
-                              prefs.get("libwireshark_path", None))
+                              prefs.get("libwireshark_path", None),
+                              prefs.get("ws_dissector_workers", 1),
+                              prefs.get("ws_dissector_in_process", False),
+                              prefs.get("ws_dissector_output", "pdml"))
+        WSDissector.set_cache(prefs.get("ws_dissector_cache_size", 1024),
+                              prefs.get("ws_dissector_cache_path", None))
         cls._init_called = True
 
     @classmethod
@@ -478,6 +543,25 @@ class DMLogPacket:
         else:
             return tuple(ret)
 
+    @classmethod
+    def prefetch(cls, decoded_lists):
+        """
+        Dissect the raw messages of many packets in one batch. The results
+        replace those of the previous call, and are used when the packets are
+        created from the same decoded lists.
+
+        :param decoded_lists: outputs of *dm_collector_c* library
+        :type decoded_lists: list
+        """
+        assert cls._init_called
+        msgs = []
+        for decoded_list in decoded_lists:
+            for field_name, val, type_str in decoded_list or ():
+                if type_str.startswith("raw_msg/"):
+                    msgs.append((type_str[len("raw_msg/"):], val))
+        results = WSDissector.decode_msgs(msgs) if msgs else []
+        cls._prefetched = dict(zip(msgs, results))
+
     @classmethod
     def _decode_msg(cls, msg_type, b):
         """
@@ -485,6 +569,9 @@ class DMLogPacket:
         """
         assert cls._init_called
 
+        key = (msg_type, b)
+        if key in cls._prefetched:
+            return cls._prefetched[key]
         s = WSDissector.decode_msg(msg_type, b)
         return s
 
@@ -9,11 +9,16 @@ Author: Jiayao Li
 __all__ = ["WSDissector"]
 
 import os
+import atexit
 import binascii
+import hashlib
+import json
+import pickle
 import platform
 import struct
 import subprocess
 import sys
+from collections import OrderedDict
 
 
 class WSDissector:
@@ -24,6 +29,31 @@ class WSDissector:
     This wrapper communicates with the ws_dissector program using a
     trivial TLV-formatted protocol named AWW (Automator Wireshark Wrapper),
     through the standard input/output interfaces.
+
+    If ws_dissector supports it, the wrapper switches to protocol 2, where
+    many messages are sent at once and replies are length-prefixed (see
+    ws_dissector.cpp). Otherwise each message is a separate round trip.
+    With protocol 3, messages of any size are dissected, e.g. large NR RRC
+    reconfigurations and UE capabilities. Older ws_dissector has a fixed
+    buffer, and longer messages are not sent to it.
+    Several ws_dissector processes can be started to dissect in parallel.
+
+    When the optional ws_dissector_c extension is built (see setup.py), the
+    wrapper can instead call libwireshark in-process, without any pipe.
+
+    Results are PDML by default. With the "compact" output format they are
+    trees of (name, showname, show, value, children) nodes instead, which are
+    several times smaller than PDML and need no XML parsing. Use
+    find_fields() to search them and to_pdml() to get PDML back.
+
+    decode_fields() dissects only some fields, like tshark -e, which is much
+    cheaper than building and printing the whole tree.
+
+    Results are kept in an LRU cache keyed by message type and payload hash,
+    since SIBs, paging and many RRC messages repeat byte for byte. The cache
+    can be saved to disk and reused by later replays of the same logs.
+    Compact trees and field dicts are copied out of the cache, so callers may
+    modify them; PDML strings are immutable and shared.
     """
 
     # Maps all supported message types to their AWW protocol number.
@@ -87,11 +117,38 @@ class WSDissector:
         "nr-rrc.radio_bearer_conf": 415,
         "nas-5gs":416,
     }
-    _proc = None
+    # Keep consistent with ws_dissector/ws_dissector.cpp
+    PROTOCOL_VERSION = 3
+    HELLO_TYPE = 0xFFFFFFFF
+    FORMAT_TYPE = 0xFFFFFFFE
+    FIELDS_TYPE = 0xFFFFFFFD
+    OUTPUT_FORMATS = {"pdml": 0, "compact": 1, "compact_hidden": 2}
+    MAX_MSG_LENGTH = 64 * 1024 * 1024  # MAX_MESSAGE_SIZE
+    MAX_BATCH_SIZE = 64 * 1024  # Messages per request of protocol 2
+    # ws_dissector before protocol 3 copies each message, after an AWW header
+    # of up to 26 bytes, into a 2000-byte buffer
+    LEGACY_MAX_MSG_LENGTH = 2000 - 26
+
+    _proc = None    # The first worker
+    _procs = []
     _init_proc_called = False
+    _protocol = 1
+    _module = None  # ws_dissector_c, when dissecting in-process
+    _output_format = "pdml"
+    _fields = ()                # Selected in the workers
+    _fields_supported = True
+
+    CACHE_FILE_VERSION = 2
+    _cache = OrderedDict()  # (msg_type, payload digest) -> result
+    _cache_size = 0
+    _cache_path = None
+    _cache_hits = 0
+    _cache_misses = 0
+    _cache_saved_at_exit = False
 
     @classmethod
-    def init_proc(cls, executable_path, ws_library_path):
+    def init_proc(cls, executable_path, ws_library_path, workers=1, in_process=False,
+                  output_format="pdml"):
         """
         Launch the ws_dissector program. Must be called before any actual
         decoding, and should be called only once.
@@ -101,10 +158,30 @@ class WSDissector:
 
         :param ws_library_path: a directory that contains libwireshark. If set to None, uses the default path.
         :type ws_library_path: string or None
+
+        :param workers: number of ws_dissector processes. Messages passed to decode_msgs() are split among them.
+        :type workers: int
+
+        :param in_process: dissect with the ws_dissector_c extension if it is available, instead of launching ws_dissector.
+        :type in_process: bool
+
+        :param output_format: "pdml", "compact" or "compact_hidden" (compact with hidden fields). Falls back to "pdml" if ws_dissector does not support it.
+        :type output_format: string
         """
 
         if cls._init_proc_called:
             return
+        if in_process:
+            try:
+                from . import ws_dissector_c
+                if ws_dissector_c.init():
+                    cls._module = ws_dissector_c
+                    cls._output_format = output_format
+                    cls._init_proc_called = True
+                    return
+            except ImportError:
+                pass
+            print("MI(Info) ws_dissector_c is not available, using the ws_dissector program")
         if executable_path:
             real_executable_path = executable_path
         else:
@@ -121,52 +198,473 @@ class WSDissector:
             if ws_library_path:
                 env["LD_LIBRARY_PATH"] = ws_library_path + \
                     ":" + env.get("LD_LIBRARY_PATH", "")
-        cls._proc = subprocess.Popen([real_executable_path],
-                                     bufsize=-1,
-                                     stdin=subprocess.PIPE,
-                                     stdout=subprocess.PIPE,
-                                     env=env
-                                     )
+        cls._procs = []
+        for _ in range(max(1, workers)):
+            proc = subprocess.Popen([real_executable_path],
+                                    bufsize=-1,
+                                    stdin=subprocess.PIPE,
+                                    stdout=subprocess.PIPE,
+                                    env=env
+                                    )
+            cls._procs.append(proc)
+        cls._proc = cls._procs[0]
         cls._init_proc_called = True
+        cls._protocol = cls._negotiate()
+        if output_format != "pdml":
+            cls._output_format = cls._select_format(output_format)
 
     @classmethod
-    def decode_msg(cls, msg_type, b):
+    def _read_reply_v1(cls, proc):
+        result = []
+        while True:
+            line = proc.stdout.readline().decode("utf-8")
+            if not line or line.startswith("===___==="):
+                break
+            result.append(line)
+        return "".join(result)
+
+    @classmethod
+    def _negotiate(cls):
         """
-        Decode a binary message of type msg_type.
+        Ask ws_dissector for the newest protocol both sides support.
 
-        :param msg_type: the type of the message to be decoded
-        :type msg_type: string
+        :returns: the protocol version to be used by all workers
+        """
+        for proc in cls._procs:
+            proc.stdin.write(struct.pack("!III", cls.HELLO_TYPE, 4,
+                                         cls.PROTOCOL_VERSION))
+            proc.stdin.flush()
+        protocol = cls.PROTOCOL_VERSION
+        for proc in cls._procs:
+            # Older ws_dissector dissects the hello as an unknown message
+            reply = cls._read_reply_v1(proc)
+            version = 1
+            if reply.startswith("PROTOCOL "):
+                try:
+                    version = int(reply.split()[1])
+                except ValueError:
+                    pass
+            protocol = min(protocol, version)
+        return protocol
 
-        :param b: binary data to be decoded
-        :type b: string
+    @classmethod
+    def _control(cls, proc, msg_type, value):
+        """
+        Send a control message holding a 32-bit value or bytes, in the current
+        protocol.
+
+        :returns: the reply, as a string
+        """
+        if isinstance(value, bytes):
+            msg = struct.pack("!II", msg_type, len(value)) + value
+        else:
+            msg = struct.pack("!III", msg_type, 4, value)
+        if cls._protocol < 2:
+            proc.stdin.write(msg)
+            proc.stdin.flush()
+            return cls._read_reply_v1(proc)
+        proc.stdin.write(struct.pack("!I", 1) + msg)
+        proc.stdin.flush()
+        length = struct.unpack("!I", cls._read_exact(proc, 4))[0]
+        return cls._read_exact(proc, length).decode("utf-8", "replace")
+
+    @classmethod
+    def _select_format(cls, output_format):
+        """
+        Ask all workers for an output format.
+
+        :returns: the output format to be used by all workers
+        """
+        wanted = cls.OUTPUT_FORMATS.get(output_format)
+        if wanted is None:
+            print("MI(Warning) Unknown ws_dissector output format:", output_format)
+            return "pdml"
+        expected = "FORMAT %d" % wanted
+        # Older ws_dissector dissects the request as an unknown message
+        replies = [cls._control(proc, cls.FORMAT_TYPE, wanted) for proc in cls._procs]
+        if all(reply.strip() == expected for reply in replies):
+            return output_format
+        for proc, reply in zip(cls._procs, replies):
+            if reply.startswith("FORMAT "):
+                cls._control(proc, cls.FORMAT_TYPE, cls.OUTPUT_FORMATS["pdml"])
+        return "pdml"
+
+    @classmethod
+    def _select_fields(cls, fields):
+        """
+        Restrict dissection by the workers to some fields, or to none for
+        whole trees.
+
+        :returns: whether the workers support it
+        """
+        if fields == cls._fields:
+            return True
+        payload = "\n".join(fields).encode("utf-8")
+        replies = [cls._control(proc, cls.FIELDS_TYPE, payload) for proc in cls._procs]
+        if not all(reply.startswith("FIELDS ") for reply in replies):
+            # Older ws_dissector dissects the request as an unknown message
+            cls._fields_supported = False
+            return False
+        cls._fields = fields
+        return True
+
+    @classmethod
+    def _extract_fields(cls, result, fields):
+        """
+        Pick some fields out of a whole dissection.
+
+        :returns: a dict that maps each field name to the list of its shown values
+        """
+        if result is None:
+            return None
+        ret = dict((name, []) for name in fields)
+        if isinstance(result, str):
+            import xml.etree.ElementTree as ET
+            try:
+                nodes = ET.XML("<msg>" + result + "</msg>").iter("field")
+            except ET.ParseError:
+                return None
+            for node in nodes:
+                name = node.get("name")
+                if name in ret:
+                    ret[name].append(node.get("show", ""))
+        else:
+            for name in fields:
+                ret[name] = [node[2] or "" for node in cls.find_fields(result, name)]
+        return ret
+
+    @classmethod
+    def get_output_format(cls):
+        """
+        :returns: the format of decoded messages, "pdml", "compact" or "compact_hidden"
+        """
+        return cls._output_format
+
+    @classmethod
+    def _parse_reply(cls, reply, fields=()):
+        if cls._output_format == "pdml" and not fields:
+            return reply
+        try:
+            return json.loads(reply)
+        except ValueError:
+            return None
+
+    @classmethod
+    def find_fields(cls, tree, name):
+        """
+        Find the fields of a compact tree with a given name, in document order.
+
+        :param tree: a list of nodes returned in the compact output format
+        :type tree: list
+
+        :param name: a field name, e.g. "rrc.sib_Type"
+        :type name: string
+
+        :returns: a generator of (name, showname, show, value, children) nodes
+        """
+        stack = list(reversed(tree))
+        while stack:
+            node = stack.pop()
+            if node[0] == name:
+                yield node
+            stack.extend(reversed(node[4]))
+
+    @classmethod
+    def field_bytes(cls, node):
+        """
+        :returns: the bytes of a node of a compact tree, or None
+        """
+        value = node[3]
+        if isinstance(value, str):
+            return binascii.a2b_hex(value)
+        return value
+
+    @classmethod
+    def to_pdml(cls, tree):
+        """
+        Convert a compact tree into PDML, as returned with the "pdml" format.
+        Fields are not given their pos and size.
+
+        :param tree: a list of nodes returned in the compact output format
+        :type tree: list
 
         :returns: an XML string
         """
-        assert cls._init_proc_called
+        out = ['<packet>\n<proto name="geninfo"></proto>\n']
+        cls._nodes_to_pdml(tree, out)
+        out.append("</packet>\n")
+        return "".join(out)
+
+    @classmethod
+    def _nodes_to_pdml(cls, nodes, out):
+        escape = cls._xml_escape
+        for name, showname, show, value, children in nodes:
+            if show is None:
+                out.append('<proto name="%s" showname="%s">\n' % (escape(name), escape(showname)))
+            else:
+                if value is not None and not isinstance(value, str):
+                    value = binascii.b2a_hex(value).decode("ascii")
+                out.append('<field name="%s" showname="%s" show="%s"%s>\n'
+                           % (escape(name), escape(showname), escape(show),
+                              ' value="%s"' % value if value is not None else ""))
+            cls._nodes_to_pdml(children, out)
+            out.append("</proto>\n" if show is None else "</field>\n")
+
+    @staticmethod
+    def _xml_escape(s):
+        return s.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;") \
+                .replace('"', "&quot;")
+
+    @classmethod
+    def _read_exact(cls, proc, n):
+        data = proc.stdout.read(n)
+        if len(data) != n:
+            raise RuntimeError("ws_dissector exited unexpectedly")
+        return data
+
+    @classmethod
+    def _check_msg(cls, msg_type, b):
         if msg_type not in cls.SUPPORTED_TYPES:
             print(("MI(Unknown) Unsupported message for ws_dissector:", msg_type))
-            return None
-        if len(b) > 3000:
+            return False
+        if cls._module is None and cls._protocol < 3:
+            max_length = cls.LEGACY_MAX_MSG_LENGTH
+        else:
+            max_length = cls.MAX_MSG_LENGTH
+        if len(b) > max_length:
             print(("MI(Ignore) Length of message is too large for ws_dissector:", len(b), "bytes"))
-            return None
+            return False
+        return True
 
-        input_data = struct.pack(
-            "!II",  # in network order
-            cls.SUPPORTED_TYPES[msg_type],
-            len(b),
-        )
-        input_data += b
+    @classmethod
+    def set_cache(cls, size, path=None):
+        """
+        Configure the cache of dissection results. Must be called after
+        init_proc(), since results depend on the output format.
 
-        cls._proc.stdin.write(input_data)
-        cls._proc.stdin.flush()
-        result = []
-        while True:
-            line = cls._proc.stdout.readline().decode("utf-8")
-            if line.startswith("===___==="):
-                break
-            result.append(line)
+        :param size: maximum number of cached messages. 0 disables the cache
+        :type size: int
+
+        :param path: a file where the cache is loaded from, and saved to at exit. None to keep it in memory only
+        :type path: string or None
+        """
+        cls._cache_size = max(0, size)
+        cls._cache_path = path
+        cls._cache = OrderedDict()
+        if path and size > 0:
+            cls._load_cache(path)
+            if not cls._cache_saved_at_exit:
+                atexit.register(cls.save_cache)
+                cls._cache_saved_at_exit = True
+
+    @classmethod
+    def _load_cache(cls, path):
+        try:
+            with open(path, "rb") as f:
+                saved = pickle.load(f)
+        except (OSError, EOFError, pickle.UnpicklingError):
+            return
+        if saved.get("version") != cls.CACHE_FILE_VERSION \
+                or saved.get("output_format") != cls._output_format:
+            return
+        for key, result in saved["entries"][-cls._cache_size:]:
+            cls._cache[key] = result
+
+    @classmethod
+    def save_cache(cls):
+        """
+        Save the cache to the path given to set_cache(), if any.
+        """
+        if not cls._cache_path or not cls._cache:
+            return
+        tmp_path = cls._cache_path + ".tmp"
+        try:
+            with open(tmp_path, "wb") as f:
+                pickle.dump({"version": cls.CACHE_FILE_VERSION,
+                             "output_format": cls._output_format,
+                             "entries": list(cls._cache.items())},
+                            f, pickle.HIGHEST_PROTOCOL)
+            os.replace(tmp_path, cls._cache_path)
+        except OSError as e:
+            print("MI(Warning) Cannot save the ws_dissector cache:", e)
+
+    @classmethod
+    def get_cache_stats(cls):
+        """
+        :returns: a dict with the hits, misses and number of entries of the cache
+        """
+        return {"hits": cls._cache_hits,
+                "misses": cls._cache_misses,
+                "entries": len(cls._cache)}
+
+    @classmethod
+    def decode_fields(cls, msgs, fields):
+        """
+        Decode some fields of many binary messages, like tshark -e. Only
+        these fields are built by libwireshark, and only their values are
+        returned.
+
+        :param msgs: (msg_type, b) pairs, see decode_msg()
+        :type msgs: list
+
+        :param fields: field names, e.g. ("lte-rrc.measId", "nas_eps.nas_msg_emm_type")
+        :type fields: list
+
+        :returns: a list of dicts that map each field name to the list of its shown values, with None for messages that cannot be decoded
+        """
+        return cls._decode(msgs, tuple(fields))
+
+    @classmethod
+    def decode_msgs(cls, msgs):
+        """
+        Decode many binary messages with one round trip to ws_dissector.
+
+        Messages are split among the workers, which dissect them in
+        parallel. Results are in the same order as msgs.
+
+        :param msgs: (msg_type, b) pairs, see decode_msg()
+        :type msgs: list
+
+        :returns: a list of XML strings (or compact trees, see get_output_format()), with None for messages that cannot be decoded
+        """
+        return cls._decode(msgs, ())
+
+    @classmethod
+    def _decode(cls, msgs, fields):
+        assert cls._init_proc_called
+        results = [None] * len(msgs)
+        todo = [i for i, (msg_type, b) in enumerate(msgs) if cls._check_msg(msg_type, b)]
+        if not todo or cls._cache_size == 0:
+            if todo:
+                cls._dissect(msgs, todo, results, fields)
+            return results
+
+        # Dissect each missing message once, even if it repeats in msgs
+        cache = cls._cache
+        keys = {}
+        missing = {}
+        for i in todo:
+            msg_type, b = msgs[i]
+            key = (msg_type, hashlib.blake2b(b, digest_size=16).digest(), fields)
+            keys[i] = key
+            if key in cache:
+                cache.move_to_end(key)
+                results[i] = cls._copy_result(cache[key])
+                cls._cache_hits += 1
+            elif key in missing:
+                cls._cache_hits += 1
+            else:
+                missing[key] = i
+                cls._cache_misses += 1
+        if missing:
+            cls._dissect(msgs, list(missing.values()), results, fields)
+            for key, i in missing.items():
+                if results[i] is not None:
+                    cache[key] = cls._copy_result(results[i])
+            while len(cache) > cls._cache_size:
+                cache.popitem(last=False)
+            for i in todo:
+                if results[i] is None:
+                    results[i] = cls._copy_result(results[missing.get(keys[i], i)])
+        return results
+
+    @classmethod
+    def _copy_result(cls, result):
+        """
+        :returns: a copy of a result of _decode() that does not share any
+            mutable part with it. PDML strings are returned as they are.
+        """
+        if result is None or isinstance(result, str):
+            return result
+        if isinstance(result, dict):
+            return dict((name, list(values)) for name, values in result.items())
+        return cls._copy_nodes(result)
+
+    @classmethod
+    def _copy_nodes(cls, nodes):
+        return [type(node)((node[0], node[1], node[2], node[3], cls._copy_nodes(node[4])))
+                for node in nodes]
+
+    @classmethod
+    def _dissect(cls, msgs, todo, results, fields=()):
+        """
+        Dissect msgs[i] into results[i] for every i in todo, or only the
+        given fields of them.
+        """
+        if fields and cls._module is None \
+                and not (cls._fields_supported and cls._select_fields(fields)):
+            cls._dissect(msgs, todo, results)
+            for i in todo:
+                results[i] = cls._extract_fields(results[i], fields)
+            return results
+
+        if cls._module is not None:
+            for i in todo:
+                msg_type, b = msgs[i]
+                if fields:
+                    results[i] = cls._module.dissect_fields(cls.SUPPORTED_TYPES[msg_type], b, fields)
+                elif cls._output_format == "pdml":
+                    results[i] = cls._module.dissect_pdml(cls.SUPPORTED_TYPES[msg_type], b)
+                else:
+                    results[i] = cls._module.dissect(cls.SUPPORTED_TYPES[msg_type], b,
+                                                     cls._output_format == "compact_hidden")
+            return results
+
+        if not fields and cls._fields:
+            cls._select_fields(())
+        n_procs = len(cls._procs)
+        if cls._protocol < 2:
+            # One message in flight per worker
+            for start in range(0, len(todo), n_procs):
+                group = list(zip(cls._procs, todo[start:start + n_procs]))
+                for proc, i in group:
+                    msg_type, b = msgs[i]
+                    proc.stdin.write(struct.pack("!II", cls.SUPPORTED_TYPES[msg_type], len(b)))
+                    proc.stdin.write(b)
+                    proc.stdin.flush()
+                for proc, i in group:
+                    results[i] = cls._parse_reply(cls._read_reply_v1(proc), fields)
+            return results
+
+        # Each worker reads its whole batch before replying, so all batches of
+        # a round can be written before any reply is read.
+        round_size = n_procs * cls.MAX_BATCH_SIZE
+        for start in range(0, len(todo), round_size):
+            group = todo[start:start + round_size]
+            size = (len(group) + n_procs - 1) // n_procs
+            batches = [(proc, group[k * size:(k + 1) * size])
+                       for k, proc in enumerate(cls._procs) if group[k * size:(k + 1) * size]]
+            for proc, batch in batches:
+                input_data = [struct.pack("!I", len(batch))]
+                for i in batch:
+                    msg_type, b = msgs[i]
+                    input_data.append(struct.pack("!II", cls.SUPPORTED_TYPES[msg_type], len(b)))
+                    input_data.append(b)
+                # Large messages are written without being copied
+                proc.stdin.writelines(input_data)
+                proc.stdin.flush()
+            for proc, batch in batches:
+                for i in batch:
+                    length = struct.unpack("!I", cls._read_exact(proc, 4))[0]
+                    results[i] = cls._parse_reply(cls._read_exact(proc, length).decode("utf-8", "replace"),
+                                                  fields)
+        return results
+
+    @classmethod
+    def decode_msg(cls, msg_type, b):
+        """
+        Decode a binary message of type msg_type.
+
+        :param msg_type: the type of the message to be decoded
+        :type msg_type: string
+
+        :param b: binary data to be decoded
+        :type b: string
+
+        :returns: an XML string, or a compact tree (see get_output_format())
+        """
+        return cls.decode_msgs([(msg_type, b)])[0]
 
-        return "".join(result)
 
 
 # Test decoding
@@ -95,6 +95,16 @@ class Monitor(Element):
         """
         pass
 
+    def set_msg_types(self, enabled):
+        """
+        Add the type of every signaling message to its decoded packet, as a
+        "Msg Type" field (see DMLogPacket.get_msg_type()). Off by default.
+
+        :param enabled: add the message types or not
+        :type enabled: bool
+        """
+        pass
+
     def run(self):
         """
         Start monitoring the mobile network. This is usually the entrance of monitoring and analysis.
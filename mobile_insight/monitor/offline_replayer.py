@@ -10,12 +10,15 @@ Update: Yunqi Guo, 2020/06, for MI5
 
 __all__ = ["OfflineReplayer"]
 
+import gzip
 import os
 import sys
 import time
 import timeit
 
+from .block_log import BlockLogReader
 from .dm_collector import dm_collector_c, DMLogPacket, FormatError
+from .dm_collector.dm_endec import WSDissector
 from .monitor import Monitor, Event
 
 
@@ -47,7 +50,13 @@ class OfflineReplayer(Monitor):
             # not used, but bugs may exist on laptop
             self.is_android = False
 
-    def __init__(self):
+    def __init__(self, prefs={}):
+        """
+        Initialize the replayer.
+
+        :param prefs: configurations for message decoder, e.g. {"ws_dissector_workers": 4} to dissect with 4 ws_dissector processes, or {"ws_dissector_in_process": True} to dissect with ws_dissector_c if it is built. With "ws_dissector_batch_size", the raw messages of that many packets are dissected at once, and their events are sent afterwards. Empty by default.
+        :type prefs: dictionary
+        """
         Monitor.__init__(self)
 
         self.is_android = False
@@ -55,20 +64,23 @@ class OfflineReplayer(Monitor):
 
         self.__test_android()
 
+        prefs = dict(prefs)
         if self.is_android:
             libs_path = self.__get_libs_path()
 
-            prefs = {
+            prefs.update({
                 "ws_dissect_executable_path": os.path.join(
                     libs_path,
                     "android_pie_ws_dissector"),
-                "libwireshark_path": libs_path}
-        else:
-            prefs = {}
+                "libwireshark_path": libs_path})
 
         DMLogPacket.init(prefs)
+        # 1 sends the event of each packet as soon as it is decoded
+        self._dissect_batch_size = max(1, prefs.get("ws_dissector_batch_size", 1))
 
         self._type_names = []
+        self._start_time = None
+        self._end_time = None
 
     def __del__(self):
         if self.is_android and self.service_context:
@@ -100,6 +112,9 @@ class OfflineReplayer(Monitor):
     def set_sampling_rate(self, sampling_rate):
         dm_collector_c.set_sampling_rate(sampling_rate)
 
+    def set_msg_types(self, enabled):
+        dm_collector_c.set_msg_types(enabled)
+
     def enable_log(self, type_name):
         """
         Enable the messages to be monitored. Refer to cls.SUPPORTED_TYPES for supported types.
@@ -140,16 +155,140 @@ class OfflineReplayer(Monitor):
         self._input_path = path
         # self._input_file = open(path, "rb")
 
-    def save_log_as(self, path):
+    def set_time_range(self, start_time=None, end_time=None):
+        """
+        Only replay the blocks of .mi2blk logs that overlap with a time range.
+        Other logs are replayed as a whole.
+
+        :param start_time: skip blocks that end before this time. None for no limit
+        :type start_time: datetime.datetime
+        :param end_time: skip blocks that start after this time. None for no limit
+        :type end_time: datetime.datetime
+        """
+        self._start_time = start_time
+        self._end_time = end_time
+
+    def save_log_as(self, path, sync_interval=0, max_segment_bytes=0,
+                    max_segment_seconds=0, compression=None):
         """
         Save the log as a mi2log file (for offline analysis)
 
-        :param path: the file name to be saved
+        :param path: the file name to be saved. If the log is split, a naming pattern where "{seq}" is the file number and strftime() conversions give the current time
         :type path: string
-        :param log_types: a filter of message types to be saved
-        :type log_types: list of string
+        :param sync_interval: seconds between flushes of the file to the storage device. 0 (default) leaves it to the OS
+        :type sync_interval: float
+        :param max_segment_bytes: start a new file after this many bytes. 0 (default) for no limit
+        :type max_segment_bytes: int
+        :param max_segment_seconds: start a new file after this many seconds. 0 (default) for no limit
+        :type max_segment_seconds: float
+        :param compression: None (default), "gzip" or "block". Gzip files end with ".gz". "block" writes an indexed .mi2blk file, which can be replayed selectively
+        :type compression: string
         """
-        dm_collector_c.set_filtered_export(path, self._type_names)
+        dm_collector_c.set_filtered_export(path, self._type_names, sync_interval,
+                                           max_segment_bytes, max_segment_seconds,
+                                           compression)
+
+    def save_pcap_as(self, path, max_segment_bytes=0, max_segment_seconds=0,
+                     compression=None):
+        """
+        Save the raw signaling messages (e.g. RRC and NAS) of the replayed
+        logs as a pcapng file, for bulk dissection with tshark. Messages are
+        framed as for ws_dissector, with link type USER1 (DLT 148).
+
+        :param path: the file name to be saved, or a naming pattern as in save_log_as() if the file is split
+        :type path: string
+        :param max_segment_bytes: start a new file after this many bytes. 0 (default) for no limit
+        :type max_segment_bytes: int
+        :param max_segment_seconds: start a new file after this many seconds. 0 (default) for no limit
+        :type max_segment_seconds: float
+        :param compression: None (default) or "gzip"
+        :type compression: string
+        """
+        dm_collector_c.set_pcap_export(path, max_segment_bytes, max_segment_seconds,
+                                       compression)
+
+    def get_export_stats(self):
+        """
+        Return statistics of the log saving, e.g. bytes written and frames
+        dropped because the storage could not keep up.
+
+        :returns: a dict of counters
+        """
+        return dm_collector_c.get_export_stats()
+
+    def enable_engine(self, name, options=None):
+        """
+        Enable a native analysis engine of dm_collector_c, which computes
+        results while the enabled logs are decoded.
+
+        :param name: the engine, one of dm_collector_c.analysis_engines
+        :type name: string
+        :param options: options of the engine, or None for the defaults
+        :type options: dict
+
+        :except ValueError: unknown engine or bad option
+        """
+        dm_collector_c.enable_engine(name, options)
+
+    def collect_engine(self, name):
+        """
+        Return the results of a native analysis engine since the last call.
+
+        :param name: the engine, one of dm_collector_c.analysis_engines
+        :type name: string
+        """
+        return dm_collector_c.collect_engine(name)
+
+    def query_engine(self, name, query, params=None):
+        """
+        Ask a native analysis engine of dm_collector_c about the state it
+        keeps. Only some engines have queries.
+
+        :param name: the engine, one of dm_collector_c.analysis_engines
+        :type name: string
+        :param query: one of the queries of the engine
+        :type query: string
+        :param params: parameters of the query, or None for the defaults
+        :type params: dict
+
+        :except ValueError: unknown engine or query, or bad parameter
+        """
+        return dm_collector_c.query_engine(name, query, params)
+
+    def __dispatch(self, pending):
+        """
+        Decode packets received by dm_collector_c and send them as events.
+
+        :returns: the time spent on decoding and on sending
+        """
+        decoding_inter = 0
+        sending_inter = 0
+        if self._dissect_batch_size > 1:
+            before_decode_time = time.time()
+            DMLogPacket.prefetch([decoded[0] for decoded in pending])
+            decoding_inter += time.time() - before_decode_time
+        for decoded in pending:
+            try:
+                before_decode_time = time.time()
+                # self.log_info('Before decoding: ' + str(time.time()))
+                packet = DMLogPacket(decoded[0])
+                type_id = packet.get_type_id()
+                after_decode_time = time.time()
+                decoding_inter += after_decode_time - before_decode_time
+
+                if type_id in self._type_names or type_id == "Custom_Packet":
+                    event = Event(timeit.default_timer(),
+                                  type_id,
+                                  packet)
+                    self.send(event)
+                after_sending_time = time.time()
+                sending_inter += after_sending_time - after_decode_time
+                # self.log_info('After sending event: ' + str(time.time()))
+
+            except FormatError as e:
+                # skip this packet
+                print(("FormatError: ", e))
+        return decoding_inter, sending_inter
 
     def run(self):
         """
@@ -169,7 +308,8 @@ class OfflineReplayer(Monitor):
                 log_list = [self._input_path]
             elif os.path.isdir(self._input_path):
                 for file in os.listdir(self._input_path):
-                    if file.endswith(".mi2log") or file.endswith(".qmdl"):
+                    if file.endswith(".mi2log") or file.endswith(".qmdl") \
+                            or file.endswith(".mi2log.gz") or file.endswith(".mi2blk"):
                         # log_list.append(self._input_path+"/"+file)
                         log_list.append(os.path.join(self._input_path, file))
             else:
@@ -182,8 +322,21 @@ class OfflineReplayer(Monitor):
             for file in log_list:
                 self.log_info("Loading " + file)
                 self.log_info('Loading: ' + str(time.time()))
-                self._input_file = open(file, "rb")
+                if file.endswith(".gz"):
+                    # Compressed segments saved by save_log_as()
+                    self._input_file = gzip.open(file, "rb")
+                elif file.endswith(".mi2blk"):
+                    # Skip blocks without enabled logs
+                    type_ids = None
+                    if self._type_names:
+                        type_ids = dm_collector_c.get_type_ids(
+                            [n for n in self._type_names if n in self.SUPPORTED_TYPES])
+                    self._input_file = BlockLogReader(file, type_ids,
+                                                      self._start_time, self._end_time)
+                else:
+                    self._input_file = open(file, "rb")
                 dm_collector_c.reset()
+                pending = []
                 while True:
                     s = self._input_file.read(64)
 
@@ -193,34 +346,19 @@ class OfflineReplayer(Monitor):
                     decoded = dm_collector_c.receive_log_packet(self._skip_decoding,
                                                                 True,   # include_timestamp
                                                                 )
-                    if not s and not decoded:
+                    if decoded and decoded[0]:
+                        pending.append(decoded)
+
+                    eof = not s and not decoded
+                    if len(pending) >= self._dissect_batch_size or (eof and pending):
+                        decoding, sending = self.__dispatch(pending)
+                        decoding_inter += decoding
+                        sending_inter += sending
+                        pending = []
+                    if eof:
                         # EOF encountered and no message can be received any more
                         break
 
-                    if decoded:
-                        try:
-                            before_decode_time = time.time()
-                            # self.log_info('Before decoding: ' + str(time.time()))
-                            if not decoded[0]:
-                                continue
-
-                            packet = DMLogPacket(decoded[0])
-                            type_id = packet.get_type_id()
-                            after_decode_time = time.time()
-                            decoding_inter += after_decode_time - before_decode_time
-
-                            if type_id in self._type_names or type_id == "Custom_Packet":
-                                event = Event(timeit.default_timer(),
-                                              type_id,
-                                              packet)
-                                self.send(event)
-                            after_sending_time = time.time()
-                            sending_inter += after_sending_time - after_decode_time
-                            # self.log_info('After sending event: ' + str(time.time()))
-
-                        except FormatError as e:
-                            # skip this packet
-                            print(("FormatError: ", e))
                 self.log_info('Decoding_inter: ' + str(decoding_inter))
                 self.log_info('sending_inter: ' + str(sending_inter))
                 self._input_file.close()
@@ -231,4 +369,5 @@ class OfflineReplayer(Monitor):
             # sys.exit(e)
         event = Event(timeit.default_timer(), 'Monitor.STOP', None)
         self.send(event)
+        self.log_info("Dissection cache: " + str(WSDissector.get_cache_stats()))
         self.log_info("Offline replay is completed.")
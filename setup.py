@@ -39,14 +39,55 @@ for key, value in list(cfg_vars.items()):
 
 dm_collector_c_module = Extension('mobile_insight.monitor.dm_collector.dm_collector_c',
                                   sources=["dm_collector_c/dm_collector_c.cpp",
+                                           "dm_collector_c/analysis_engine.cpp",
+                                           "dm_collector_c/block_log.cpp",
                                            "dm_collector_c/export_manager.cpp",
                                            "dm_collector_c/hdlc.cpp",
                                            "dm_collector_c/log_config.cpp",
                                            "dm_collector_c/log_packet.cpp",
+                                           "dm_collector_c/log_writer.cpp",
+                                           "dm_collector_c/lte_csf_stats.cpp",
+                                           "dm_collector_c/lte_mac_tput.cpp",
+                                           "dm_collector_c/lte_pdcch_dci_stats.cpp",
+                                           "dm_collector_c/lte_pdcp_timeline.cpp",
+                                           "dm_collector_c/lte_pdsch_bler.cpp",
+                                           "dm_collector_c/lte_pusch_tx_columns.cpp",
+                                           "dm_collector_c/lte_rlc_tracker.cpp",
+                                           "dm_collector_c/msg_classifier.cpp",
+                                           "dm_collector_c/nr_beam_store.cpp",
+                                           "dm_collector_c/nr_mac_tput.cpp",
+                                           "dm_collector_c/nr_mac_ul_pcsr_columns.cpp",
+                                           "dm_collector_c/pcap_export.cpp",
                                            "dm_collector_c/utils.cpp", ],
-                                  define_macros=[('EXPOSE_INTERNAL_LOGS', 1), ]
+                                  define_macros=[('EXPOSE_INTERNAL_LOGS', 1), ],
+                                  libraries=['z'],
                                   )
 
+ext_modules = [dm_collector_c_module]
+
+# Optional: dissect in-process with libwireshark. Needs the configured Wireshark
+# sources, as for ws_dissector. The install scripts set WIRESHARK_SRC_PATH only
+# when asked to, e.g. WS_DISSECTOR_IN_PROCESS=1 ./install-ubuntu.sh
+WIRESHARK_SRC_PATH = os.environ.get("WIRESHARK_SRC_PATH")
+if WIRESHARK_SRC_PATH:
+    import shlex
+    import subprocess
+
+    def pkg_config(option):
+        return shlex.split(subprocess.check_output(
+            ["pkg-config", option, "glib-2.0"]).decode())
+
+    ws_dissector_c_module = Extension('mobile_insight.monitor.dm_collector.dm_endec.ws_dissector_c',
+                                      sources=["ws_dissector/ws_dissector_module.cpp",
+                                               "ws_dissector/packet-aww.cpp", ],
+                                      include_dirs=[WIRESHARK_SRC_PATH],
+                                      library_dirs=[os.environ.get("WIRESHARK_LIB_PATH", "/usr/local/lib")],
+                                      libraries=['wireshark', 'wsutil', 'wiretap'],
+                                      extra_compile_args=pkg_config("--cflags"),
+                                      extra_link_args=pkg_config("--libs"),
+                                      )
+    ext_modules.append(ws_dissector_c_module)
+
 
 def parse_libs(url, suffix):
     pattern = '<a href=".*%s.*">.*</a>' % suffix
@@ -134,5 +175,5 @@ setup(
     package_data=PACKAGE_DATA,
     data_files=DATA_FILES,
     options={'py2exe': PY2EXE_OPTIONS},
-    ext_modules=[dm_collector_c_module],
+    ext_modules=ext_modules,
 )
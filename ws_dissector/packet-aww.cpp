@@ -1,14 +1,17 @@
 #include "config.h"
 #include <epan/epan.h>
 #include <epan/packet.h>
+#include <epan/prefs.h>
+#include <epan/ftypes/ftypes.h>
 #include <epan/proto_data.h>
 #include <epan/dissectors/packet-pdcp-lte.h>
+#include <wiretap/wtap.h>
+#include <wsutil/privileges.h>
 
 #include <stdio.h>
+#include <map>
 #include "packet-aww.h"
 
-#define WS_DISSECTOR_VERSION "3.2.7"
-
 static const int PROTO_MAX = 1000;
 
 static int proto_aww = -1;
@@ -314,3 +317,364 @@ void print_proto_list () {
         }
     }
 }
+
+
+epan_t *
+aww_session_new ()
+{
+    // to prevent "started_with_special_privs: assertion failed" error.
+    init_process_policies();
+
+    wtap_init(TRUE);
+    epan_init(NULL, NULL, TRUE);
+
+    proto_register_aww();
+    proto_reg_handoff_aww();
+
+    static const struct packet_provider_funcs funcs = {
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    };
+    epan_t *session = epan_new(NULL, &funcs);
+    char s[] = "uat:user_dlts:\"User 1 (DLT=148)\",\"aww\",\"0\",\"\",\"0\",\"\"";
+    char *errmsg = NULL;
+    switch (prefs_set_pref(s, &errmsg)) {
+    case PREFS_SET_OK:
+        break;
+
+    case PREFS_SET_SYNTAX_ERR:
+    case PREFS_SET_NO_SUCH_PREF:
+    case PREFS_SET_OBSOLETE:
+    default:
+        fprintf(stderr, "Failed to set user_dlts.\n");
+        epan_free(session);
+        return NULL;
+    }
+    prefs_apply_all();
+    return session;
+}
+
+
+void
+aww_session_free (epan_t *session)
+{
+    epan_free(session);
+    epan_cleanup();
+}
+
+
+size_t
+aww_header_length (unsigned int type)
+{
+    if (type == 300 || type == 301)
+        return 8 + strlen(PDCP_LTE_START_STRING) + 10;
+    return 8;
+}
+
+
+void
+aww_frame_header (unsigned int type, size_t data_len, guchar *header)
+{
+    size_t offset = 0;
+    guint32 n = g_htonl(type);
+    memcpy(header + offset, &n, 4);
+    offset += 4;
+    n = g_htonl(data_len);
+    memcpy(header + offset, &n, 4);
+    offset += 4;
+    if (type == 300 || type == 301) {
+        /* If type is pdcp-lte signaling message, we need to add framing
+         * header before read pdcp PDU. */
+        /* Fixed start to each frame (allowing heuristic dissector to work
+         * ) */
+        memcpy(header + offset, PDCP_LTE_START_STRING,
+                strlen(PDCP_LTE_START_STRING));
+        offset += strlen(PDCP_LTE_START_STRING);
+
+        /* Now write out fixed fields (the mandatory elements of struct
+         * pdcp_lte_info */
+
+        /* gboolean no_header_pdu */
+        header[offset++] = FALSE;
+
+        /* enum pdcp_plane */
+        header[offset++] = SIGNALING_PLANE;
+
+        /* gboolean rohc_compression */
+        header[offset++] = FALSE;
+
+        /* Optional fields */
+        /* Direction */
+        header[offset++] = PDCP_LTE_DIRECTION_TAG;
+        switch (type) {
+            case 300:   // downlink
+                header[offset++] = DIRECTION_DOWNLINK;
+                break;
+            case 301:   // uplink
+                header[offset++] = DIRECTION_UPLINK;
+                break;
+        }
+
+        /* Logical Channel Type */
+        header[offset++] = PDCP_LTE_LOG_CHAN_TYPE_TAG;
+        header[offset++] = Channel_DCCH;
+
+        /* BCCH Transport Type */
+        header[offset++] = PDCP_LTE_BCCH_TRANSPORT_TYPE_TAG;
+        header[offset++] = 0;
+
+        header[offset++] = PDCP_LTE_PAYLOAD_TAG;
+    }
+}
+
+
+size_t
+aww_frame_message (unsigned int type, const guchar *payload, size_t data_len,
+                   guchar *out, size_t capacity)
+{
+    size_t header_len = aww_header_length(type);
+    if (header_len + data_len > capacity)
+        return 0;
+    aww_frame_header(type, data_len, out);
+    memcpy(out + header_len, payload, data_len);
+    return header_len + data_len;
+}
+
+
+void
+aww_dissection_init (epan_t *session, struct AwwDissection *d)
+{
+    d->session = session;
+    memset(&d->rec, 0, sizeof(wtap_rec));
+    d->rec.rec_header.packet_header.pkt_encap = WTAP_ENCAP_USER1;
+    frame_data_init(&d->fdata, 0, &d->rec, 0, 0);
+    d->fdata.encoding = PACKET_CHAR_ENC_CHAR_ASCII;
+    epan_dissect_init(&d->visible, session, TRUE, TRUE);
+    epan_dissect_init(&d->fields, session, TRUE, FALSE);
+    d->edt = NULL;
+}
+
+
+// Reset the tree of the last message and the frame, and return edt ready for
+// a new message.
+static epan_dissect_t *
+reset_dissection (struct AwwDissection *d, epan_dissect_t *edt, size_t msg_len)
+{
+    if (d->edt != NULL)
+        epan_dissect_reset(d->edt);
+    d->edt = edt;
+    // Drop the per-frame data (e.g. PDCP info) of the last message
+    frame_data_reset(&d->fdata);
+    d->fdata.pkt_len = msg_len;
+    d->fdata.cap_len = msg_len;
+    return edt;
+}
+
+
+void
+aww_dissect (struct AwwDissection *d, const guchar *msg, size_t msg_len)
+{
+    epan_dissect_t *edt = reset_dissection(d, &d->visible, msg_len);
+    epan_dissect_run(edt, 0, &d->rec, tvb_new_real_data(msg, msg_len, msg_len),
+                     &d->fdata, NULL);
+}
+
+
+size_t
+aww_select_fields (const std::vector<std::string> &names, AwwFieldSelection *sel)
+{
+    size_t known = 0;
+    sel->names = names;
+    sel->hfids.assign(names.size(), std::vector<int>());
+    for (size_t i = 0; i < names.size(); i++) {
+        // Fields of the same name are chained from the last registered one
+        header_field_info *hfi = proto_registrar_get_byname(names[i].c_str());
+        if (hfi != NULL)
+            known++;
+        while (hfi != NULL) {
+            sel->hfids[i].push_back(hfi->id);
+            hfi = hfi->same_name_prev_id != -1 ? proto_registrar_get_nth(hfi->same_name_prev_id) : NULL;
+        }
+    }
+    return known;
+}
+
+
+void
+aww_dissect_fields (struct AwwDissection *d, const guchar *msg, size_t msg_len,
+                    const AwwFieldSelection &sel)
+{
+    epan_dissect_t *edt = reset_dissection(d, &d->fields, msg_len);
+    // Only primed fields and their ancestors are added to an invisible tree.
+    // Resetting the tree forgets them.
+    for (size_t i = 0; i < sel.hfids.size(); i++)
+        for (size_t j = 0; j < sel.hfids[i].size(); j++)
+            epan_dissect_prime_with_hfid(edt, sel.hfids[i][j]);
+    epan_dissect_run(edt, 0, &d->rec, tvb_new_real_data(msg, msg_len, msg_len),
+                     &d->fdata, NULL);
+}
+
+
+void
+aww_dissection_free (struct AwwDissection *d)
+{
+    epan_dissect_cleanup(&d->visible);
+    epan_dissect_cleanup(&d->fields);
+    d->edt = NULL;
+    frame_data_destroy(&d->fdata);
+}
+
+
+static void
+write_json_string (const char *s, FILE *out)
+{
+    putc('"', out);
+    for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; p++) {
+        switch (*p) {
+            case '"':
+                fputs("\\\"", out);
+                break;
+            case '\\':
+                fputs("\\\\", out);
+                break;
+            case '\n':
+                fputs("\\n", out);
+                break;
+            case '\t':
+                fputs("\\t", out);
+                break;
+            default:
+                if (*p < 0x20)
+                    fprintf(out, "\\u%04x", *p);
+                else
+                    putc(*p, out);
+        }
+    }
+    putc('"', out);
+}
+
+static void write_compact_children (proto_node *node, gboolean include_hidden, FILE *out);
+
+static void
+write_compact_node (proto_node *node, gboolean include_hidden, FILE *out)
+{
+    static const char hex[] = "0123456789abcdef";
+    field_info *fi = PNODE_FINFO(node);
+    header_field_info *hfi = fi->hfinfo;
+
+    putc('[', out);
+    write_json_string(hfi->abbrev, out);
+    putc(',', out);
+
+    gchar label[ITEM_LABEL_LENGTH] = {0};
+    if (fi->rep != NULL) {
+        write_json_string(fi->rep->representation, out);
+    } else {
+        proto_item_fill_label(fi, label);
+        write_json_string(label, out);
+    }
+    putc(',', out);
+
+    if (hfi->type == FT_PROTOCOL) {
+        fputs("null", out);
+    } else {
+        char *show = fvalue_to_string_repr(NULL, &fi->value, FTREPR_DISPLAY, hfi->display);
+        write_json_string(show != NULL ? show : "", out);
+        wmem_free(NULL, show);
+    }
+    putc(',', out);
+
+    if (fi->ds_tvb != NULL && fi->length > 0
+            && tvb_bytes_exist(fi->ds_tvb, fi->start, fi->length)) {
+        const guint8 *bytes = tvb_get_ptr(fi->ds_tvb, fi->start, fi->length);
+        putc('"', out);
+        for (gint i = 0; i < fi->length; i++) {
+            putc(hex[bytes[i] >> 4], out);
+            putc(hex[bytes[i] & 0x0f], out);
+        }
+        putc('"', out);
+    } else {
+        fputs("null", out);
+    }
+    putc(',', out);
+
+    write_compact_children(node, include_hidden, out);
+    putc(']', out);
+}
+
+static void
+write_compact_children (proto_node *node, gboolean include_hidden, FILE *out)
+{
+    bool first = true;
+    putc('[', out);
+    for (proto_node *child = node->first_child; child != NULL; child = child->next) {
+        if (PNODE_FINFO(child) == NULL)
+            continue;
+        if (!include_hidden && proto_item_is_hidden(child))
+            continue;
+        if (!first)
+            putc(',', out);
+        first = false;
+        write_compact_node(child, include_hidden, out);
+    }
+    putc(']', out);
+}
+
+
+void
+aww_write_compact_tree (epan_dissect_t *edt, gboolean include_hidden, FILE *out)
+{
+    write_compact_children(edt->tree, include_hidden, out);
+    putc('\n', out);
+}
+
+
+// Append the shown values of the selected fields under node, in tree order.
+static void
+collect_fields (proto_node *node, const std::map<int, size_t> &index,
+                std::vector<std::vector<std::string> > &values)
+{
+    for (proto_node *child = node->first_child; child != NULL; child = child->next) {
+        field_info *fi = PNODE_FINFO(child);
+        if (fi == NULL)
+            continue;
+        std::map<int, size_t>::const_iterator it = index.find(fi->hfinfo->id);
+        if (it != index.end()) {
+            char *show = fvalue_to_string_repr(NULL, &fi->value, FTREPR_DISPLAY,
+                                               fi->hfinfo->display);
+            values[it->second].push_back(show != NULL ? show : "");
+            wmem_free(NULL, show);
+        }
+        collect_fields(child, index, values);
+    }
+}
+
+
+void
+aww_write_fields (epan_dissect_t *edt, const AwwFieldSelection &sel, FILE *out)
+{
+    std::map<int, size_t> index;
+    for (size_t i = 0; i < sel.hfids.size(); i++) {
+        for (size_t j = 0; j < sel.hfids[i].size(); j++)
+            index[sel.hfids[i][j]] = i;
+    }
+    std::vector<std::vector<std::string> > values(sel.names.size());
+    collect_fields(edt->tree, index, values);
+
+    putc('{', out);
+    for (size_t i = 0; i < sel.names.size(); i++) {
+        if (i > 0)
+            putc(',', out);
+        write_json_string(sel.names[i].c_str(), out);
+        fputs(":[", out);
+        for (size_t k = 0; k < values[i].size(); k++) {
+            if (k > 0)
+                putc(',', out);
+            write_json_string(values[i][k].c_str(), out);
+        }
+        putc(']', out);
+    }
+    fputs("}\n", out);
+}
@@ -1,8 +1,87 @@
 #ifndef __PACKET_AWW_H__
 #define __PACKET_AWW_H__
 
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/frame_data.h>
+#include <wiretap/wtap.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
 void proto_register_aww ();
 void proto_reg_handoff_aww ();
 void print_proto_list ();
 
+// Shared by ws_dissector and the in-process Python module.
+
+// Initialize libwireshark, register aww as DLT 148 and create a session.
+// Return: the session, or NULL on failure
+epan_t *aww_session_new ();
+void aww_session_free (epan_t *session);
+
+// Return: length of the aww header (type, length and PDCP framing if needed)
+// of a message
+size_t aww_header_length (unsigned int type);
+
+// Write the aww header of a message into out, which must hold
+// aww_header_length(type) bytes. The payload is expected right after it.
+void aww_frame_header (unsigned int type, size_t data_len, guchar *out);
+
+// Write the aww header followed by the payload into out.
+// Return: length of the aww message, or 0 if it does not fit in capacity
+size_t aww_frame_message (unsigned int type, const guchar *payload, size_t data_len,
+                          guchar *out, size_t capacity);
+
+// A dissection context shared by all messages: the trees and the frame are
+// reset between messages instead of being created again.
+struct AwwDissection {
+    epan_t *session;
+    wtap_rec rec;
+    frame_data fdata;
+    epan_dissect_t visible;     // Whole trees
+    epan_dissect_t fields;      // Invisible trees for field selection
+    epan_dissect_t *edt;        // Holds the tree of the last message, or NULL
+};
+
+void aww_dissection_init (epan_t *session, struct AwwDissection *d);
+
+// Dissect an aww message into d->edt. msg and the tree must stay valid until
+// the next dissection.
+void aww_dissect (struct AwwDissection *d, const guchar *msg, size_t msg_len);
+void aww_dissection_free (struct AwwDissection *d);
+
+// Fields to be dissected, like tshark -e
+struct AwwFieldSelection {
+    std::vector<std::string> names;
+    std::vector<std::vector<int> > hfids;   // Every field registered under each name
+};
+
+// Look up field names, e.g. "lte-rrc.measId".
+// Return: the number of names known to libwireshark
+size_t aww_select_fields (const std::vector<std::string> &names, AwwFieldSelection *sel);
+
+// Dissect an aww message into an invisible tree that only holds the selected
+// fields. msg and the tree must stay valid until the next dissection.
+void aww_dissect_fields (struct AwwDissection *d, const guchar *msg, size_t msg_len,
+                         const AwwFieldSelection &sel);
+
+// Output formats of a dissection
+enum AwwOutputFormat {
+    AWW_OUTPUT_PDML = 0,
+    AWW_OUTPUT_COMPACT = 1,         // JSON tree without hidden fields
+    AWW_OUTPUT_COMPACT_HIDDEN = 2,  // JSON tree with hidden fields
+};
+
+// Write the tree of a dissection as JSON: a list of nodes, each of them
+// [abbrev, showname, show, value, children]. show is null for protocols, and
+// value holds the bytes of the field in hex, or null.
+void aww_write_compact_tree (epan_dissect_t *edt, gboolean include_hidden, FILE *out);
+
+// Write the selected fields of a dissection as a JSON object, which maps each
+// name to the list of shown values of the field. Values are in tree order,
+// also when several fields are registered under the name.
+void aww_write_fields (epan_dissect_t *edt, const AwwFieldSelection &sel, FILE *out);
+
 #endif  //  __PACKET_AWW_H__
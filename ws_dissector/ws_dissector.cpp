@@ -17,6 +17,10 @@
 
 #include "packet-aww.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
 #ifdef _WIN32
     #include <winsock2.h>   // for ntohl()
     #include <io.h>
@@ -30,10 +34,96 @@
     #error Your compiler is not either MS Visual C compiler or GNU gcc.
 #endif
 
-#define WS_DISSECTOR_VERSION "3.2.7"
+#define WS_DISSECTOR_VERSION "3.2.10"
 
-const int BUFFER_SIZE = 2000;
-guchar buffer[BUFFER_SIZE] = {};
+// Protocol 1: each request is a (type, length) header followed by the message,
+// and each reply is PDML followed by a "===___===" line.
+// Protocol 2: each request is a message count, at most MAX_BATCH_SIZE,
+// followed by that many (type, length, message) records. Each reply is the PDML of every message,
+// prefixed with its length. All integers are 32-bit, in network order.
+// Protocol 3: same as protocol 2, and messages may be up to MAX_MESSAGE_SIZE
+// bytes long. ws_dissector of protocol 2 or older copies each message with its
+// aww header into a 2000-byte buffer, so clients must not send it more.
+// A client asks for protocol 2 or 3 with a WS_HELLO_TYPE message holding the
+// version it wants, which is answered in protocol 1 with "PROTOCOL <version>".
+// Older ws_dissector does not answer so, and the client stays on protocol 1.
+// In either protocol, a WS_FORMAT_TYPE message holding an AwwOutputFormat
+// selects the output of the following messages, and is answered with
+// "FORMAT <format>". Older ws_dissector dissects it as an unknown message, so
+// the client keeps reading PDML.
+// Likewise, a WS_FIELDS_TYPE message holding newline-separated field names
+// (e.g. "lte-rrc.measId") restricts dissection to these fields, like tshark -e,
+// and is answered with "FIELDS <number of known fields>". Until a message
+// with no names is sent, each reply is then a JSON object of field values
+// (see aww_write_fields()), whatever the output format.
+#define WS_PROTOCOL_VERSION 3
+#define WS_HELLO_TYPE 0xFFFFFFFFu
+#define WS_FORMAT_TYPE 0xFFFFFFFEu
+#define WS_FIELDS_TYPE 0xFFFFFFFDu
+
+// Messages longer than this are taken as a corrupted request
+const size_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+// Likewise for protocol 2 requests of more messages than this
+const uint32_t MAX_BATCH_SIZE = 64 * 1024;
+
+// Messages of the current request, each after its aww header. Cleared for
+// every request but never shrunk, so that it is allocated only a few times.
+std::vector<guchar> buffer;
+AwwOutputFormat output_format = AWW_OUTPUT_PDML;
+AwwFieldSelection selected_fields;
+
+// Replies of a protocol 2 request. In memory except on Windows, which has no
+// open_memstream().
+struct ReplyStream {
+    FILE *f;
+    char *data;
+    size_t size;
+};
+
+// Return: successful or not
+bool open_reply_stream(ReplyStream *r)
+{
+    r->data = NULL;
+    r->size = 0;
+#ifdef _WIN32
+    r->f = tmpfile();
+#else
+    r->f = open_memstream(&r->data, &r->size);
+#endif
+    return r->f != NULL;
+}
+
+// Write the first len bytes of the stream to stdout.
+void copy_reply_stream(ReplyStream *r, long len)
+{
+#ifdef _WIN32
+    char chunk[65536];
+    rewind(r->f);
+    while (len > 0) {
+        size_t n = fread(chunk, 1, len < (long) sizeof(chunk) ? (size_t) len : sizeof(chunk), r->f);
+        if (n == 0)
+            break;
+        fwrite(chunk, 1, n, stdout);
+        len -= n;
+    }
+#else
+    fflush(r->f);
+    fwrite(r->data, 1, len, stdout);
+#endif
+}
+
+void close_reply_stream(ReplyStream *r)
+{
+    fclose(r->f);
+    free(r->data);
+}
+
+struct Message {
+    unsigned int type;
+    size_t offset;      // In buffer
+    size_t header_len;  // 0 for control messages
+    size_t data_len;
+};
 
 // void print_tree(const proto_tree* tree, int level)
 // {
@@ -56,47 +146,163 @@ guchar buffer[BUFFER_SIZE] = {};
 //     print_tree(tree->next, level);
 // }
 
-void try_dissect(epan_t *session, size_t data_len, const guchar* raw_data)
+void try_dissect(struct AwwDissection *d, const guchar *msg, size_t msg_len, FILE *out)
 {
-    wtap_rec phdr;
-    frame_data fdata;
-
-    memset(&phdr, 0, sizeof(wtap_rec));
-    phdr.rec_header.packet_header.pkt_encap = WTAP_ENCAP_USER1;
-    frame_data_init(&fdata, 0, &phdr, 0, 0);
-
-    // fdata = (frame_data*)g_new(frame_data, 1);
-
-    // memset(fdata, 0, sizeof(frame_data));
-    // fdata->pfd  = NULL;
-    // fdata->num = 1;    // fdata->cum_bytes = 0;
-    // fdata->file_off = 0;
-    // fdata->subnum = 0;
-    // fdata->interface_id = 0;
-    fdata.pkt_len  = data_len;
-    fdata.cap_len  = data_len;
-    // fdata->cum_bytes = 0;
-    // fdata->file_off = 0;
-    // fdata->subnum = 0;
-    // fdata.lnk_t = WTAP_ENCAP_ETHERNET;
-    // fdata.lnk_t = WTAP_ENCAP_USER1;
-    fdata.encoding = PACKET_CHAR_ENC_CHAR_ASCII;
-    // fdata->flags.visited = 0;
-    // fdata->flags.marked = 0;
-    // fdata->flags.ref_time = 0;
-    // fdata->color_filter = NULL;
-    // fdata->abs_ts.secs = 0;
-    // fdata->abs_ts.nsecs = 0;
-    // fdata->opt_comment = NULL;
-
-    epan_dissect_t *edt = epan_dissect_new(session, TRUE, TRUE);
-    epan_dissect_run(edt, 0, &phdr, tvb_new_real_data(raw_data, data_len, data_len), &fdata, NULL);
-    // const proto_tree *payload_tree = edt->tree->first_child->next;
+    if (!selected_fields.names.empty()) {
+        aww_dissect_fields(d, msg, msg_len, selected_fields);
+        aww_write_fields(d->edt, selected_fields, out);
+        return;
+    }
+    aww_dissect(d, msg, msg_len);
+    // const proto_tree *payload_tree = d->edt->tree->first_child->next;
     // print_tree(payload_tree, 0);
-    write_pdml_proto_tree(NULL, NULL, PF_NONE, edt, NULL, stdout, FALSE); 
+    if (output_format == AWW_OUTPUT_PDML)
+        write_pdml_proto_tree(NULL, NULL, PF_NONE, d->edt, NULL, out, FALSE);
+    else
+        aww_write_compact_tree(d->edt, output_format == AWW_OUTPUT_COMPACT_HIDDEN, out);
+}
+
+bool is_control(unsigned int type)
+{
+    return type == WS_FORMAT_TYPE || type == WS_FIELDS_TYPE;
+}
+
+// Read a message of data_len bytes from stdin, and append it to buffer after
+// the header expected by packet-aww.
+// Return: successful or not
+bool read_message(unsigned int type, size_t data_len, Message *m)
+{
+    if (data_len > MAX_MESSAGE_SIZE) {
+        fprintf(stderr, "Error: message of %u bytes is too large.\n", (unsigned int) data_len);
+        return false;
+    }
+    m->type = type;
+    m->offset = buffer.size();
+    m->header_len = is_control(type) ? 0 : aww_header_length(type);
+    m->data_len = data_len;
+    buffer.resize(m->offset + m->header_len + data_len);
+    if (m->header_len > 0)
+        aww_frame_header(type, data_len, &buffer[m->offset]);
+    return data_len == 0
+        || fread(&buffer[m->offset + m->header_len], 1, data_len, stdin) == data_len;
+}
+
+// Answer a WS_HELLO_TYPE message.
+// Return: the protocol to be used from now on
+int negotiate_protocol(size_t data_len)
+{
+    uint32_t wanted = 1;
+    if (data_len == sizeof(uint32_t) && fread(&wanted, sizeof(uint32_t), 1, stdin) == 1) {
+        wanted = ntohl(wanted);
+    } else {
+        for (size_t i = 0; i < data_len && getchar() != EOF; i++)
+            ;
+    }
+    int protocol = wanted < WS_PROTOCOL_VERSION ? (int) wanted : WS_PROTOCOL_VERSION;
+    if (protocol < 1)
+        protocol = 1;
+    printf("PROTOCOL %d\n", protocol);
+    printf("===___===\n");
+    fflush(stdout);
+    return protocol;
+}
 
-    epan_dissect_free(edt);
-    frame_data_destroy(&fdata);
+// Handle a WS_FORMAT_TYPE message.
+// Return: the answer to be sent in the current protocol
+std::string select_format(const guchar *payload, size_t len)
+{
+    uint32_t wanted = AWW_OUTPUT_PDML;
+    if (len == sizeof(uint32_t)) {
+        memcpy(&wanted, payload, sizeof(uint32_t));
+        wanted = ntohl(wanted);
+    }
+    if (wanted > AWW_OUTPUT_COMPACT_HIDDEN)
+        wanted = AWW_OUTPUT_PDML;
+    output_format = (AwwOutputFormat) wanted;
+    return "FORMAT " + std::to_string(wanted) + "\n";
+}
+
+// Handle a WS_FIELDS_TYPE message.
+// Return: the answer to be sent in the current protocol
+std::string select_fields(const guchar *data, size_t len)
+{
+    std::string payload((const char *) data, len);
+    std::vector<std::string> names;
+    size_t start = 0;
+    while (start < payload.size()) {
+        size_t end = payload.find('\n', start);
+        if (end == std::string::npos)
+            end = payload.size();
+        if (end > start)
+            names.push_back(payload.substr(start, end - start));
+        start = end + 1;
+    }
+    size_t known = aww_select_fields(names, &selected_fields);
+    return "FIELDS " + std::to_string(known) + "\n";
+}
+
+// Answer a WS_FORMAT_TYPE or WS_FIELDS_TYPE message.
+// Return: whether m is one of them
+bool handle_control(const Message &m, std::string *answer)
+{
+    const guchar *payload = &buffer[m.offset];
+    if (m.type == WS_FORMAT_TYPE)
+        *answer = select_format(payload, m.data_len);
+    else if (m.type == WS_FIELDS_TYPE)
+        *answer = select_fields(payload, m.data_len);
+    else
+        return false;
+    return true;
+}
+
+// Serve one request of protocol 2. The whole request is read before any
+// reply is written, so that a client writing a large batch in one go cannot
+// deadlock with us writing to a full pipe.
+// Return: false if the pipe is closed
+bool serve_batch(struct AwwDissection *d, ReplyStream *stream)
+{
+    uint32_t count;
+    if (fread(&count, sizeof(uint32_t), 1, stdin) < 1)
+        return false;
+    count = ntohl(count);
+    if (count > MAX_BATCH_SIZE) {
+        fprintf(stderr, "Error: request of %u messages is too large.\n", (unsigned int) count);
+        return false;
+    }
+    buffer.clear();
+    std::vector<Message> msgs(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t header[2];
+        if (fread(header, sizeof(uint32_t), 2, stdin) < 2)
+            return false;
+        if (!read_message(ntohl(header[0]), ntohl(header[1]), &msgs[i]))
+            return false;
+    }
+
+    // Replies are written to a reused stream, so that the length of each can
+    // be filled in once it is known.
+    FILE *replies = stream->f;
+    rewind(replies);
+    for (uint32_t i = 0; i < count; i++) {
+        const Message &m = msgs[i];
+        long start = ftell(replies);
+        uint32_t len = 0;
+        fwrite(&len, sizeof(uint32_t), 1, replies);
+        std::string answer;
+        if (handle_control(m, &answer))
+            fputs(answer.c_str(), replies);
+        else
+            try_dissect(d, &buffer[m.offset], m.header_len + m.data_len, replies);
+        long end = ftell(replies);
+        len = htonl((uint32_t) (end - start - sizeof(uint32_t)));
+        fseek(replies, start, SEEK_SET);
+        fwrite(&len, sizeof(uint32_t), 1, replies);
+        fseek(replies, end, SEEK_SET);
+    }
+    copy_reply_stream(stream, ftell(replies));
+    // One flush per batch
+    fflush(stdout);
+    return true;
 }
 
 int main(int argc, char** argv)
@@ -118,100 +324,50 @@ int main(int argc, char** argv)
         return 0;
     }
 
-    // to prevent "started_with_special_privs: assertion failed" error.
-    init_process_policies();
-
-    wtap_init(TRUE);
-    epan_init(NULL, NULL, TRUE);
-
-    proto_register_aww();
-    proto_reg_handoff_aww();
-
-	static const struct packet_provider_funcs funcs = {
-		NULL,
-		NULL,
-		NULL,
-		NULL
-	};
-    epan_t *session = epan_new(NULL, &funcs);
-    char s[] = "uat:user_dlts:\"User 1 (DLT=148)\",\"aww\",\"0\",\"\",\"0\",\"\"";
-    char *errmsg = NULL;
-    switch (prefs_set_pref(s, &errmsg)) {
-    case PREFS_SET_OK:
-        break;
-
-    case PREFS_SET_SYNTAX_ERR:
-    case PREFS_SET_NO_SUCH_PREF:
-    case PREFS_SET_OBSOLETE:
-    default:
-        fprintf(stderr, "Failed to set user_dlts.\n");
+    epan_t *session = aww_session_new();
+    if (session == NULL)
+        return 1;
+    struct AwwDissection d;
+    aww_dissection_init(session, &d);
+    ReplyStream replies;
+    if (!open_reply_stream(&replies)) {
+        perror("Error: cannot create the reply stream");
         return 1;
-        break;
     }
-    prefs_apply_all();
 
+    int protocol = 1;
     while (!feof(stdin)) {  // stop dissect when the pipe is closed
-        fflush(stdin);
+        if (protocol >= 2) {
+            if (!serve_batch(&d, &replies))
+                break;
+            continue;
+        }
+
         fflush(stdout);
-        size_t ign = fread(buffer, sizeof(uint32_t), 2, stdin);
-        if (ign < 2)
+        uint32_t header[2];
+        if (fread(header, sizeof(uint32_t), 2, stdin) < 2)
             break;
-        unsigned int type = ntohl(*(uint32_t *)buffer);
-        size_t data_len = ntohl(*((uint32_t *)(buffer + 4)));
-        size_t offset = 8;
-        size_t framingHeader_len = 0;
-        if (type == 300 || type == 301) {
-            /* If type is pdcp-lte signaling message, we need to add framing
-             * header before read pdcp PDU. */
-            /* Fixed start to each frame (allowing heuristic dissector to work
-             * ) */
-            memcpy(buffer + offset, PDCP_LTE_START_STRING,
-                    strlen(PDCP_LTE_START_STRING));
-            offset += strlen(PDCP_LTE_START_STRING);
-
-            /* Now write out fixed fields (the mandatory elements of struct
-             * pdcp_lte_info */
-
-            /* gboolean no_header_pdu */
-            buffer[offset++] = FALSE;
-
-            /* enum pdcp_plane */
-            buffer[offset++] = SIGNALING_PLANE;
-
-            /* gboolean rohc_compression */
-            buffer[offset++] = FALSE;
-
-            /* Optional fields */
-            /* Direction */
-            buffer[offset++] = PDCP_LTE_DIRECTION_TAG;
-            switch (type) {
-                case 300:   // downlink
-                    buffer[offset++] = DIRECTION_DOWNLINK;
-                    break;
-                case 301:   // uplink
-                    buffer[offset++] = DIRECTION_UPLINK;
-                    break;
-            }
-
-            /* Logical Channel Type */
-            buffer[offset++] = PDCP_LTE_LOG_CHAN_TYPE_TAG;
-            buffer[offset++] = Channel_DCCH;
-
-            /* BCCH Transport Type */
-            buffer[offset++] = PDCP_LTE_BCCH_TRANSPORT_TYPE_TAG;
-            buffer[offset++] = 0;
-
-            buffer[offset++] = PDCP_LTE_PAYLOAD_TAG;
-            framingHeader_len = offset - 8;
+        unsigned int type = ntohl(header[0]);
+        size_t data_len = ntohl(header[1]);
+        if (type == WS_HELLO_TYPE) {
+            protocol = negotiate_protocol(data_len);
+            continue;
         }
-        fread(buffer + offset, 1, data_len, stdin);
-        // fprintf(stderr, "type = %u, size = %u\n", type, (unsigned int) data_len);
 
-        try_dissect(session, data_len + 2 * 4 + framingHeader_len, buffer);
+        buffer.clear();
+        Message m;
+        if (!read_message(type, data_len, &m))
+            break;
+        std::string answer;
+        if (handle_control(m, &answer))
+            fputs(answer.c_str(), stdout);
+        else
+            try_dissect(&d, &buffer[m.offset], m.header_len + m.data_len, stdout);
         printf("===___===\n");  // this line CANNOT be deleted. used to seperate msgs
     }
 
-    epan_free(session);
-    epan_cleanup();
+    close_reply_stream(&replies);
+    aww_dissection_free(&d);
+    aww_session_free(session);
     return 0;
 }
@@ -0,0 +1,150 @@
+/* ws_dissector_bench.cpp
+ * Measures the throughput of the dissection loop of ws_dissector, without
+ * any pipe: each message is framed, dissected and written to /dev/null, with
+ * the dissection context reused across messages (as ws_dissector does) and
+ * with a new one for every message (as it used to).
+ *
+ * Usage: ws_dissector_bench [iterations] [pdml|compact|fields] [type:hex ...]
+ * Without messages, a few WCDMA and LTE RRC messages are used. In "fields"
+ * mode, lte-rrc.pagingRecordList and rrc.sfn_Prime are dissected.
+ */
+
+#include "config.h"
+
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/print.h>
+
+#include "packet-aww.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct BenchMessage {
+    unsigned int type;
+    std::vector<guchar> framed;
+};
+
+static const char *DEFAULT_MESSAGES[] = {
+    "200:4001BF281AEBA00000",                                       // LTE-RRC_PCCH
+    "150:60c428205aa2fe0090c8506e422419822a3653940c40c0",           // RRC_MIB
+    "150:10c424c05aa2fe00a0c850448c466608a8e54a80100a0100",         // RRC_MIB
+    "151:c764b108500b1ba01483078a2be62ad0",                         // RRC_SIB1
+};
+
+// Parse "type:hex" into an aww message.
+// Return: successful or not
+static bool
+parse_message(const char *arg, BenchMessage *m)
+{
+    const char *colon = strchr(arg, ':');
+    if (colon == NULL || strlen(colon + 1) % 2 != 0)
+        return false;
+    m->type = (unsigned int) strtoul(arg, NULL, 10);
+    std::vector<guchar> payload;
+    for (const char *p = colon + 1; *p != '\0'; p += 2) {
+        char byte[3] = {p[0], p[1], '\0'};
+        payload.push_back((guchar) strtoul(byte, NULL, 16));
+    }
+    m->framed.resize(aww_header_length(m->type) + payload.size());
+    aww_frame_message(m->type, payload.data(), payload.size(), m->framed.data(),
+                      m->framed.size());
+    return true;
+}
+
+static void
+dissect_one(struct AwwDissection *d, const BenchMessage &m, const std::string &mode,
+            const AwwFieldSelection &sel, FILE *out)
+{
+    if (mode == "fields") {
+        aww_dissect_fields(d, m.framed.data(), m.framed.size(), sel);
+        aww_write_fields(d->edt, sel, out);
+    } else {
+        aww_dissect(d, m.framed.data(), m.framed.size());
+        if (mode == "compact")
+            aww_write_compact_tree(d->edt, FALSE, out);
+        else
+            write_pdml_proto_tree(NULL, NULL, PF_NONE, d->edt, NULL, out, FALSE);
+    }
+}
+
+// Return: messages per second
+static double
+run(epan_t *session, const std::vector<BenchMessage> &msgs, long iterations,
+    const std::string &mode, const AwwFieldSelection &sel, bool reuse, FILE *out)
+{
+    struct AwwDissection d;
+    if (reuse)
+        aww_dissection_init(session, &d);
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < msgs.size(); j++) {
+            if (!reuse)
+                aww_dissection_init(session, &d);
+            dissect_one(&d, msgs[j], mode, sel, out);
+            if (!reuse)
+                aww_dissection_free(&d);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (reuse)
+        aww_dissection_free(&d);
+    return iterations * msgs.size() / elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 10000;
+    std::string mode = argc > 2 ? argv[2] : "pdml";
+    if (iterations <= 0 || (mode != "pdml" && mode != "compact" && mode != "fields")) {
+        fprintf(stderr, "Usage: %s [iterations] [pdml|compact|fields] [type:hex ...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<BenchMessage> msgs;
+    std::vector<const char *> args(argv + (argc > 3 ? 3 : argc), argv + argc);
+    if (args.empty())
+        args.assign(DEFAULT_MESSAGES, DEFAULT_MESSAGES + sizeof(DEFAULT_MESSAGES) / sizeof(DEFAULT_MESSAGES[0]));
+    for (size_t i = 0; i < args.size(); i++) {
+        BenchMessage m;
+        if (!parse_message(args[i], &m)) {
+            fprintf(stderr, "Error: bad message %s, expected type:hex\n", args[i]);
+            return 1;
+        }
+        msgs.push_back(m);
+    }
+
+    epan_t *session = aww_session_new();
+    if (session == NULL)
+        return 1;
+    AwwFieldSelection sel;
+    std::vector<std::string> names;
+    names.push_back("lte-rrc.pagingRecordList");
+    names.push_back("rrc.sfn_Prime");
+    aww_select_fields(names, &sel);
+#ifdef _WIN32
+    FILE *out = fopen("NUL", "w");
+#else
+    FILE *out = fopen("/dev/null", "w");
+#endif
+    if (out == NULL) {
+        perror("Error: cannot open the null device");
+        return 1;
+    }
+
+    // Warm up libwireshark before measuring
+    run(session, msgs, 1, mode, sel, true, out);
+    double reused = run(session, msgs, iterations, mode, sel, true, out);
+    double fresh = run(session, msgs, iterations, mode, sel, false, out);
+    printf("%s, %u messages x %ld\n", mode.c_str(), (unsigned int) msgs.size(), iterations);
+    printf("reused context: %.0f msg/s\n", reused);
+    printf("new context per message: %.0f msg/s\n", fresh);
+
+    fclose(out);
+    aww_session_free(session);
+    return 0;
+}
@@ -0,0 +1,313 @@
+/* ws_dissector_module.cpp
+ * Defines ws_dissector_c, a Python extension module that dissects messages
+ * with libwireshark in-process, using the same aww registration as the
+ * ws_dissector program. Messages do not go through a pipe, and dissect()
+ * returns the protocol tree as Python objects without any text format in
+ * between.
+ *
+ * libwireshark is not thread-safe: all calls hold the GIL.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "config.h"
+
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/ftypes/ftypes.h>
+#include <epan/print.h>
+#include <epan/proto.h>
+
+#include "packet-aww.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static epan_t *g_session = NULL;
+static struct AwwDissection g_dissection;  // Reused by every call
+static std::vector<guchar> g_buffer;
+static AwwFieldSelection g_fields;     // Of the last dissect_fields()
+
+static PyObject *ws_dissector_c_init(PyObject *self, PyObject *args);
+
+static PyObject *ws_dissector_c_dissect(PyObject *self, PyObject *args);
+
+static PyObject *ws_dissector_c_dissect_pdml(PyObject *self, PyObject *args);
+
+static PyObject *ws_dissector_c_dissect_fields(PyObject *self, PyObject *args);
+
+static PyMethodDef WsDissectorCMethods[] = {
+        {"init",            ws_dissector_c_init,            METH_VARARGS,
+                                                               "Initialize libwireshark. Calling it again has no effect.\n"
+                                                               "\n"
+                                                               "Returns:\n"
+                                                               "    Successful or not.\n"
+        },
+        {"dissect",         ws_dissector_c_dissect,         METH_VARARGS,
+                                                               "Dissect a message into a tree.\n"
+                                                               "\n"
+                                                               "Args:\n"
+                                                               "    type: the AWW protocol number (see WSDissector.SUPPORTED_TYPES).\n"
+                                                               "    payload: the message, as bytes.\n"
+                                                               "    include_hidden: keep hidden fields. Default to False.\n"
+                                                               "\n"
+                                                               "Returns:\n"
+                                                               "    A list of top-level nodes. Each node is a tuple\n"
+                                                               "    (name, showname, show, value, children), where show is None\n"
+                                                               "    for protocols, value holds the bytes of the field (or None)\n"
+                                                               "    and children is a list of nodes.\n"
+                                                               "\n"
+                                                               "Raises\n"
+                                                               "    RuntimeError: when init() has not succeeded.\n"
+        },
+        {"dissect_pdml",    ws_dissector_c_dissect_pdml,    METH_VARARGS,
+                                                               "Dissect a message into PDML, like the ws_dissector program.\n"
+                                                               "\n"
+                                                               "Args:\n"
+                                                               "    type: the AWW protocol number.\n"
+                                                               "    payload: the message, as bytes.\n"
+                                                               "\n"
+                                                               "Returns:\n"
+                                                               "    An XML string.\n"
+                                                               "\n"
+                                                               "Raises\n"
+                                                               "    RuntimeError: when init() has not succeeded.\n"
+        },
+        {"dissect_fields",  ws_dissector_c_dissect_fields,  METH_VARARGS,
+                                                               "Dissect only some fields of a message, like tshark -e.\n"
+                                                               "\n"
+                                                               "Args:\n"
+                                                               "    type: the AWW protocol number.\n"
+                                                               "    payload: the message, as bytes.\n"
+                                                               "    fields: a sequence of field names, e.g. (\"lte-rrc.measId\",).\n"
+                                                               "\n"
+                                                               "Returns:\n"
+                                                               "    A dict that maps each field name to the list of its shown\n"
+                                                               "    values.\n"
+                                                               "\n"
+                                                               "Raises\n"
+                                                               "    RuntimeError: when init() has not succeeded.\n"
+        },
+        {NULL,              NULL,                           0, NULL}        /* Sentinel */
+};
+
+// Return: successful or not
+static PyObject *
+ws_dissector_c_init(PyObject *self, PyObject *args) {
+    (void) self;
+    (void) args;
+    if (g_session == NULL) {
+        g_session = aww_session_new();
+        if (g_session != NULL)
+            aww_dissection_init(g_session, &g_dissection);
+    }
+    if (g_session != NULL)
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+// Put a message and its aww header into g_buffer.
+// Return: length of the aww message
+static size_t
+frame_payload(unsigned int type, const char *payload, Py_ssize_t length) {
+    size_t capacity = aww_header_length(type) + length;
+    if (g_buffer.size() < capacity)
+        g_buffer.resize(capacity);
+    return aww_frame_message(type, (const guchar *) payload, length, g_buffer.data(),
+                             g_buffer.size());
+}
+
+static PyObject *build_children(proto_node *node, bool include_hidden);
+
+static PyObject *
+build_node(proto_node *node, bool include_hidden) {
+    field_info *fi = PNODE_FINFO(node);
+    header_field_info *hfi = fi->hfinfo;
+
+    gchar label[ITEM_LABEL_LENGTH] = {0};
+    const gchar *showname = label;
+    if (fi->rep != NULL)
+        showname = fi->rep->representation;
+    else
+        proto_item_fill_label(fi, label);
+
+    // Protocols have no show, as in PDML
+    char *show = NULL;
+    if (hfi->type != FT_PROTOCOL)
+        show = fvalue_to_string_repr(NULL, &fi->value, FTREPR_DISPLAY, hfi->display);
+
+    PyObject *value = NULL;
+    if (fi->ds_tvb != NULL && fi->length > 0
+            && tvb_bytes_exist(fi->ds_tvb, fi->start, fi->length)) {
+        value = PyBytes_FromStringAndSize(
+                    (const char *) tvb_get_ptr(fi->ds_tvb, fi->start, fi->length),
+                    fi->length);
+    } else {
+        Py_INCREF(Py_None);
+        value = Py_None;
+    }
+
+    PyObject *ret = Py_BuildValue("(sszNN)",
+                                  hfi->abbrev,
+                                  showname,
+                                  hfi->type == FT_PROTOCOL ? NULL : (show != NULL ? show : ""),
+                                  value,
+                                  build_children(node, include_hidden));
+    wmem_free(NULL, show);
+    return ret;
+}
+
+static PyObject *
+build_children(proto_node *node, bool include_hidden) {
+    PyObject *children = PyList_New(0);
+    for (proto_node *child = node->first_child; child != NULL; child = child->next) {
+        if (PNODE_FINFO(child) == NULL)
+            continue;
+        if (!include_hidden && proto_item_is_hidden(child))
+            continue;
+        PyObject *item = build_node(child, include_hidden);
+        PyList_Append(children, item);
+        Py_DECREF(item);
+    }
+    return children;
+}
+
+// Return: a list of top-level nodes
+static PyObject *
+ws_dissector_c_dissect(PyObject *self, PyObject *args) {
+    (void) self;
+    unsigned int type;
+    const char *payload;
+    Py_ssize_t length;
+    int include_hidden = 0;
+
+    if (!PyArg_ParseTuple(args, "Iy#|p", &type, &payload, &length, &include_hidden)) {
+        return NULL;
+    }
+    if (g_session == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "ws_dissector_c is not initialized.");
+        return NULL;
+    }
+
+    size_t msg_len = frame_payload(type, payload, length);
+    aww_dissect(&g_dissection, g_buffer.data(), msg_len);
+    return build_children(g_dissection.edt->tree, include_hidden != 0);
+}
+
+// Return: PDML as a string
+static PyObject *
+ws_dissector_c_dissect_pdml(PyObject *self, PyObject *args) {
+    (void) self;
+    unsigned int type;
+    const char *payload;
+    Py_ssize_t length;
+
+    if (!PyArg_ParseTuple(args, "Iy#", &type, &payload, &length)) {
+        return NULL;
+    }
+    if (g_session == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "ws_dissector_c is not initialized.");
+        return NULL;
+    }
+
+    size_t msg_len = frame_payload(type, payload, length);
+    aww_dissect(&g_dissection, g_buffer.data(), msg_len);
+
+    char *pdml = NULL;
+    size_t pdml_len = 0;
+#ifdef _WIN32
+    FILE *out = tmpfile();
+    if (out != NULL) {
+        write_pdml_proto_tree(NULL, NULL, PF_NONE, g_dissection.edt, NULL, out, FALSE);
+        long n = ftell(out);
+        if (n > 0 && (pdml = (char *) malloc(n)) != NULL) {
+            rewind(out);
+            pdml_len = fread(pdml, 1, n, out);
+        }
+        fclose(out);
+    }
+#else
+    FILE *out = open_memstream(&pdml, &pdml_len);
+    if (out != NULL) {
+        write_pdml_proto_tree(NULL, NULL, PF_NONE, g_dissection.edt, NULL, out, FALSE);
+        fclose(out);
+    }
+#endif
+
+    PyObject *ret = PyUnicode_DecodeUTF8(pdml != NULL ? pdml : "", pdml_len, "replace");
+    free(pdml);
+    return ret;
+}
+
+
+// Return: a dict of field values
+static PyObject *
+ws_dissector_c_dissect_fields(PyObject *self, PyObject *args) {
+    (void) self;
+    unsigned int type;
+    const char *payload;
+    Py_ssize_t length;
+    PyObject *fields;
+
+    if (!PyArg_ParseTuple(args, "Iy#O", &type, &payload, &length, &fields)) {
+        return NULL;
+    }
+    if (g_session == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "ws_dissector_c is not initialized.");
+        return NULL;
+    }
+    PyObject *seq = PySequence_Fast(fields, "fields must be a sequence of strings.");
+    if (seq == NULL)
+        return NULL;
+    std::vector<std::string> names;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+        const char *name = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+        if (name == NULL) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+        names.push_back(name);
+    }
+    Py_DECREF(seq);
+    if (names != g_fields.names)
+        aww_select_fields(names, &g_fields);
+
+    size_t msg_len = frame_payload(type, payload, length);
+    aww_dissect_fields(&g_dissection, g_buffer.data(), msg_len, g_fields);
+    PyObject *ret = PyDict_New();
+    for (size_t i = 0; i < g_fields.names.size(); i++) {
+        PyObject *values = PyList_New(0);
+        for (size_t j = 0; j < g_fields.hfids[i].size(); j++) {
+            GPtrArray *finfos = proto_find_finfo(g_dissection.edt->tree, g_fields.hfids[i][j]);
+            for (guint k = 0; k < finfos->len; k++) {
+                field_info *fi = (field_info *) g_ptr_array_index(finfos, k);
+                char *show = fvalue_to_string_repr(NULL, &fi->value, FTREPR_DISPLAY,
+                                                   fi->hfinfo->display);
+                PyObject *item = PyUnicode_DecodeUTF8(show != NULL ? show : "",
+                                                      show != NULL ? strlen(show) : 0,
+                                                      "replace");
+                PyList_Append(values, item);
+                Py_DECREF(item);
+                wmem_free(NULL, show);
+            }
+            g_ptr_array_free(finfos, TRUE);
+        }
+        PyDict_SetItemString(ret, g_fields.names[i].c_str(), values);
+        Py_DECREF(values);
+    }
+    return ret;
+}
+
+// Init the module
+PyMODINIT_FUNC
+PyInit_ws_dissector_c(void) {
+    static struct PyModuleDef moduledef = {
+            PyModuleDef_HEAD_INIT, "ws_dissector_c",
+            "dissects messages with libwireshark in-process.", -1,
+            WsDissectorCMethods,
+    };
+    return PyModule_Create(&moduledef);
+}